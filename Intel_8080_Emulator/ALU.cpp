@@ -7,39 +7,38 @@
 
 #include "ALU.hpp"
 
-ALU::ALU()
-{
-    checkCarryCheck();
-}
+//Checks that the carry and flag tables work, in place of checking on init
+static_assert(ALU::additionCarries(uint8_t(0xFF), uint8_t(0xFF), false));
+static_assert(ALU::additionCarries(uint8_t(0x01), uint8_t(0xFF), false));
+static_assert(ALU::additionCarries(uint8_t(0x00), uint8_t(0xFF), true));
+static_assert(!ALU::additionCarries(uint8_t(0x7F), uint8_t(0x80), false));
+static_assert(ALU::additionCarries(uint16_t(0x8000), uint16_t(0x8000), false));
+static_assert(ALU::subtractionBorrows(uint8_t(0x00), uint8_t(0x01), false));
+static_assert(ALU::subtractionBorrows(uint8_t(0x05), uint8_t(0x05), true));
+static_assert(!ALU::subtractionBorrows(uint8_t(0x05), uint8_t(0x00), true));
 
-void ALU::setFlag(Flag f, bool val)
-{
-    for(int index = 0; index < flags.size(); ++index)
-    {
-        if(f & Flag(1 << index))
-        {
-            flags[index] = val;
-        }
-    }
-}
+static_assert(ALU::zspTable[0x00] == static_cast<uint8_t>(ALU::Flag::Zero | ALU::Flag::Parity));
+static_assert(ALU::zspTable[0x01] == 0);
+static_assert(ALU::zspTable[0x03] == static_cast<uint8_t>(ALU::Flag::Parity));
+static_assert(ALU::zspTable[0x80] == static_cast<uint8_t>(ALU::Flag::Sign));
+static_assert(ALU::zspTable[0xFF] == static_cast<uint8_t>(ALU::Flag::Sign | ALU::Flag::Parity));
+
+//0x9B adjusts to 0x01 with a carry out of both nibbles
+static_assert(ALU::daaTable[0x9B] == (0x01 | static_cast<uint8_t>(ALU::Flag::Carry | ALU::Flag::AuxillaryCarry) << 8));
+//0x15 is already valid BCD
+static_assert(ALU::daaTable[0x15] == 0x15);
+//0x12 with carry set becomes 0x72, which has even parity
+static_assert(ALU::daaTable[0x112] == (0x72 | static_cast<uint8_t>(ALU::Flag::Carry | ALU::Flag::Parity) << 8));
 
-bool ALU::getFlag(Flag f) const
+ALU::ALU()
 {
-    for(int index = 0; index < flags.size(); ++index)
-    {
-        if(f & Flag(1 << index))
-        {
-            return flags[index];
-        }
-    }
     
-    return false;
 }
 
 uint8_t ALU::createStatusByte() const
 {
-    //Set to 01000000
-    uint8_t statusByte = 0x40;
+    //Set to 00000010, bit 1 always reads as 1 and bits 3 and 5 as 0. Bit 6 is the zero flag
+    uint8_t statusByte = 0x02;
     
     statusByte |= uint8_t(getFlag(Flag::Carry));
     statusByte |= uint8_t(getFlag(Flag::Parity)) << 2;
@@ -61,25 +60,26 @@ void ALU::setFromStatusByte(uint8_t statusByte)
     return;
 }
 
-void ALU::checkCarryCheck()
+uint8_t ALU::decimalAdjust(uint8_t accumulator)
 {
-    //Check that carry check works
-    uint8_t first = 0xFF;
-    uint8_t second = 0xFF;
+    const int index = accumulator | (getFlag(Flag::Carry) << 8) | (getFlag(Flag::AuxillaryCarry) << 9);
+    const uint16_t entry = daaTable[index];
     
-    operateAndSetFlags(first, second);
+    flags = entry >> 8;
+    pendingFlags = 0;
     
-    assert(getFlag(Flag::Carry));
-    
-    setFlag(Flag::All, false);
-}
-
-ALU::Flag operator|(ALU::Flag first, ALU::Flag second)
-{
-    return static_cast<ALU::Flag>(static_cast<int>(first) | static_cast<int>(second));
+    return entry;
 }
 
-bool operator&(ALU::Flag first, ALU::Flag second)
+void ALU::materialiseFlags(Flag f) const
 {
-    return static_cast<int>(first) & static_cast<int>(second);
+    const uint8_t toWorkOut = pendingFlags & static_cast<uint8_t>(f);
+    
+    //Same as the eager path, a carry out of bit 3 shows up in bit 4, which is also where the AuxillaryCarry flag sits
+    static_assert(static_cast<uint8_t>(Flag::AuxillaryCarry) == 0x10);
+    
+    const uint8_t values = zspTable[lastResult] | ((lastResult ^ lastFirst ^ lastSecond) & 0x10);
+    
+    flags = (flags & ~toWorkOut) | (values & toWorkOut);
+    pendingFlags &= ~toWorkOut;
 }
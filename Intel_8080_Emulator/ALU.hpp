@@ -7,8 +7,17 @@
 
 #pragma once
 
+#include <array>
+#include <bit>
 #include <bitset>
 #include <concepts>
+#include <cstdint>
+#include <limits>
+
+//Lazy flags are the default, CMake's INTEL8080_LAZY_FLAGS option turns them off to check them against eager ones
+#ifndef INTEL8080_LAZY_FLAGS
+#define INTEL8080_LAZY_FLAGS 1
+#endif
 
 //Reimplementation of the c++20 template since xcode doesn't have it
 template<typename T>
@@ -19,7 +28,7 @@ class ALU
 public:
     ALU();
     
-    enum class Flag
+    enum class Flag : uint8_t
     {
         None = 0,
         Zero = 1 << 0,
@@ -51,25 +60,185 @@ public:
     uint8_t createStatusByte() const;
     void setFromStatusByte(uint8_t statusByte);
     
-private:
+    //When set, Zero, Sign, Parity and AuxillaryCarry are worked out from the last operation only when something reads them
+    static constexpr bool lazyFlags = INTEL8080_LAZY_FLAGS;
+    
+    //Applies the decimal adjust to the accumulator, setting all flags
+    uint8_t decimalAdjust(uint8_t accumulator);
+    
+    template<unsigned_integral IntType>
+    static constexpr bool additionCarries(IntType first, IntType second, bool carryIn)
+    {
+        return uint32_t(first) + uint32_t(second) + carryIn > std::numeric_limits<IntType>::max();
+    }
+    
+    template<unsigned_integral IntType>
+    static constexpr bool subtractionBorrows(IntType first, IntType second, bool borrowIn)
+    {
+        return uint32_t(first) < uint32_t(second) + borrowIn;
+    }
+    
     //Returns true if even parity
     template<unsigned_integral IntType>
-    bool checkParity(IntType val) const
+    static constexpr bool checkParity(IntType val)
     {
-        //This might be too slow to construct the bitset
-        const int numBits = std::numeric_limits<IntType>::digits;
-        std::bitset<numBits> bits(val);
-        return bits.count() % 2 == 0;
+        return std::popcount(val) % 2 == 0;
     }
-
-    //Called on init. Just checks that the method used to check for carrys works
-    void checkCarryCheck();
     
-    std::bitset<5> flags;
+    //Zero, Sign and Parity flags for every 8 bit result
+    static constexpr std::array<uint8_t, 256> createZSPTable();
+    static const std::array<uint8_t, 256> zspTable;
+    
+    //Result in the low byte and all flags in the high byte, indexed by accumulator | carry << 8 | aux carry << 9
+    static constexpr std::array<uint16_t, 1024> createDAATable();
+    static const std::array<uint16_t, 1024> daaTable;
+    
+private:
+    //Records an 8 bit operation so its result flags can be worked out later
+    void deferFlags(uint8_t first, uint8_t second, uint8_t result, Flag flagsToExclude);
+    
+    //Works out any of the requested flags which are still waiting on the last operation
+    void materialiseFlags(Flag f) const;
+    
+    static constexpr uint8_t deferrableFlags = 0x17;
+    
+    mutable uint8_t flags = 0;
+    
+    //Flags which haven't been worked out from the last operation yet
+    mutable uint8_t pendingFlags = 0;
+    
+    uint8_t lastFirst = 0;
+    uint8_t lastSecond = 0;
+    uint8_t lastResult = 0;
 };
 
-ALU::Flag operator|(ALU::Flag first, ALU::Flag second);
-bool operator&(ALU::Flag first, ALU::Flag second);
+constexpr ALU::Flag operator|(ALU::Flag first, ALU::Flag second)
+{
+    return static_cast<ALU::Flag>(static_cast<int>(first) | static_cast<int>(second));
+}
+
+constexpr bool operator&(ALU::Flag first, ALU::Flag second)
+{
+    return static_cast<int>(first) & static_cast<int>(second);
+}
+
+constexpr std::array<uint8_t, 256> ALU::createZSPTable()
+{
+    std::array<uint8_t, 256> table{};
+    
+    for(int val = 0; val < 256; ++val)
+    {
+        uint8_t entry = 0;
+        
+        if(val == 0)
+        {
+            entry |= static_cast<uint8_t>(Flag::Zero);
+        }
+        
+        if(val & 0x80)
+        {
+            entry |= static_cast<uint8_t>(Flag::Sign);
+        }
+        
+        if(checkParity(uint8_t(val)))
+        {
+            entry |= static_cast<uint8_t>(Flag::Parity);
+        }
+        
+        table[val] = entry;
+    }
+    
+    return table;
+}
+
+inline constexpr std::array<uint8_t, 256> ALU::zspTable = ALU::createZSPTable();
+
+constexpr std::array<uint16_t, 1024> ALU::createDAATable()
+{
+    std::array<uint16_t, 1024> table{};
+    
+    for(int index = 0; index < 1024; ++index)
+    {
+        const uint8_t accumulator = index & 0xFF;
+        const bool carry = index & 0x100;
+        const bool auxCarry = index & 0x200;
+        
+        uint8_t correction = 0;
+        bool carryOut = carry;
+        
+        //If the least significant 4 bits are greater than 9 or the AC flag is set, 6 is added to them
+        if((accumulator & 0xF) > 0x9 || auxCarry)
+        {
+            correction |= 0x06;
+        }
+        
+        //If the most significant 4 bits are then greater than 9 or the CY flag is set, 6 is added to them
+        if(accumulator > 0x99 || carry)
+        {
+            correction |= 0x60;
+            carryOut = true;
+        }
+        
+        const uint8_t result = accumulator + correction;
+        
+        uint8_t entryFlags = createZSPTable()[result];
+        
+        if(carryOut)
+        {
+            entryFlags |= static_cast<uint8_t>(Flag::Carry);
+        }
+        
+        if((accumulator ^ correction ^ result) & 0x10)
+        {
+            entryFlags |= static_cast<uint8_t>(Flag::AuxillaryCarry);
+        }
+        
+        table[index] = result | (entryFlags << 8);
+    }
+    
+    return table;
+}
+
+inline constexpr std::array<uint16_t, 1024> ALU::daaTable = ALU::createDAATable();
+
+inline void ALU::setFlag(Flag f, bool val)
+{
+    const uint8_t mask = static_cast<uint8_t>(f);
+    
+    flags = val ? (flags | mask) : (flags & ~mask);
+    pendingFlags &= ~mask;
+}
+
+inline bool ALU::getFlag(Flag f) const
+{
+    if(pendingFlags & static_cast<uint8_t>(f))
+    {
+        materialiseFlags(f);
+    }
+    
+    return flags & static_cast<uint8_t>(f);
+}
+
+inline void ALU::deferFlags(uint8_t first, uint8_t second, uint8_t result, Flag flagsToExclude)
+{
+    const uint8_t deferred = deferrableFlags & ~static_cast<uint8_t>(flagsToExclude);
+    
+    if(deferred == 0)
+    {
+        return;
+    }
+    
+    //Anything still pending which this operation doesn't overwrite needs the old operands, so resolve it now
+    if(const uint8_t stillNeeded = pendingFlags & ~deferred; stillNeeded != 0)
+    {
+        materialiseFlags(static_cast<Flag>(stillNeeded));
+    }
+    
+    lastFirst = first;
+    lastSecond = second;
+    lastResult = result;
+    pendingFlags = deferred;
+}
 
 template<unsigned_integral IntType>
 IntType ALU::operateAndSetFlags(IntType first, IntType second, Operation op, Flag flagsToExclude, bool useCarry)
@@ -79,39 +248,33 @@ IntType ALU::operateAndSetFlags(IntType first, IntType second, Operation op, Fla
     switch(op)
     {
         case Operation::Addition:
+        {
+            const bool carryIn = useCarry && getFlag(Flag::Carry);
             
-            result = first + second + (useCarry ? getFlag(Flag::Carry) : 0);
+            result = first + second + carryIn;
             
             if(!(flagsToExclude & Flag::Carry))
             {
-                setFlag(Flag::Carry, result < first);
+                setFlag(Flag::Carry, additionCarries(first, second, carryIn));
             }
             
             break;
+        }
         
         case Operation::Subtraction:
-            
+        {
             //Carry turns into borrow flag
-            if(useCarry)
-            {
-                result = first - second - getFlag(Flag::Carry);
-                
-                if(!(flagsToExclude & Flag::Carry))
-                {
-                    setFlag(Flag::Carry, getFlag(Flag::Carry) > second || (second - getFlag(Flag::Carry)) > first);
-                }
-            }
-            else
+            const bool borrowIn = useCarry && getFlag(Flag::Carry);
+            
+            result = first - second - borrowIn;
+            
+            if(!(flagsToExclude & Flag::Carry))
             {
-                if(!(flagsToExclude & Flag::Carry))
-                {
-                    setFlag(Flag::Carry, second > first);
-                }
-                
-                result = first - second;
+                setFlag(Flag::Carry, subtractionBorrows(first, second, borrowIn));
             }
             
             break;
+        }
             
         case Operation::And:
             result = first & second;
@@ -172,6 +335,12 @@ IntType ALU::operateAndSetFlags(IntType first, IntType second, Operation op, Fla
         }
     }
     
+    if constexpr(lazyFlags && std::is_same_v<IntType, uint8_t>)
+    {
+        deferFlags(first, second, result, flagsToExclude);
+        return result;
+    }
+    
     if(!(flagsToExclude & Flag::AuxillaryCarry))
     {
         //Get the bits which weren't set in first or second but were set in result?
@@ -183,6 +352,17 @@ IntType ALU::operateAndSetFlags(IntType first, IntType second, Operation op, Fla
         setFlag(Flag::AuxillaryCarry, carryInFourthBit > 0);
     }
     
+    if constexpr(std::is_same_v<IntType, uint8_t>)
+    {
+        //Zero, sign and parity all come from a single lookup
+        const uint8_t zspToSet = static_cast<uint8_t>(Flag::Zero | Flag::Sign | Flag::Parity) & ~static_cast<uint8_t>(flagsToExclude);
+        
+        flags = (flags & ~zspToSet) | (zspTable[result] & zspToSet);
+        pendingFlags &= ~zspToSet;
+        
+        return result;
+    }
+    
     //Zero flag
     if(!(flagsToExclude & Flag::Zero))
     {
@@ -0,0 +1,186 @@
+//
+//  BatchMain.cpp
+//  Intel_8080_Emulator
+//
+
+#include "BatchRunner.hpp"
+#include "InputMovie.hpp"
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+    //Spreads the bits of a seed out, so neighbouring seeds give unrelated inputs
+    uint64_t mix(uint64_t value)
+    {
+        value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9;
+        value = (value ^ (value >> 27)) * 0x94D049BB133111EB;
+        return value ^ (value >> 31);
+    }
+}
+
+//Runs many copies of the game at once across every core, for checking movies, fuzzing and anything else that wants a lot of runs
+//Usage: space_invaders_batch <rom directory> [instances] [frames] [--threads <count>] [--no-pin] [--jit] [--lockstep] [--replay <movie>] [--fuzz <seed>]
+int main(int argc, char const** argv)
+{
+    if(argc < 2)
+    {
+        std::cout << "Usage: " << argv[0] << " <rom directory> [instances] [frames] [--threads <count>] [--no-pin] [--jit] [--lockstep] [--replay <movie>] [--fuzz <seed>]" << std::endl;
+        return EXIT_FAILURE;
+    }
+    
+    std::vector<std::string_view> positional;
+    size_t threadCount = std::thread::hardware_concurrency();
+    bool pinThreads = true;
+    bool recompile = false;
+    bool lockstep = false;
+    std::string replayFile;
+    bool fuzz = false;
+    uint64_t fuzzSeed = 0;
+    
+    for(int argIndex = 2; argIndex < argc; ++argIndex)
+    {
+        const std::string_view arg = argv[argIndex];
+        
+        if(arg == "--threads" && argIndex + 1 < argc)
+        {
+            threadCount = std::stoul(argv[++argIndex]);
+        }
+        else if(arg == "--no-pin")
+        {
+            pinThreads = false;
+        }
+        else if(arg == "--jit")
+        {
+            recompile = true;
+        }
+        else if(arg == "--lockstep")
+        {
+            lockstep = true;
+        }
+        else if(arg == "--replay" && argIndex + 1 < argc)
+        {
+            replayFile = argv[++argIndex];
+        }
+        else if(arg == "--fuzz" && argIndex + 1 < argc)
+        {
+            fuzz = true;
+            fuzzSeed = std::stoull(argv[++argIndex]);
+        }
+        else
+        {
+            positional.push_back(arg);
+        }
+    }
+    
+    const size_t instanceCount = positional.size() > 0 ? std::stoul(std::string(positional[0])) : 1000;
+    uint64_t frameCount = positional.size() > 1 ? std::stoull(std::string(positional[1])) : 600;
+    
+    BatchRunner runner(threadCount, pinThreads);
+    runner.setLockstepEnabled(lockstep);
+    
+    for(size_t instance = 0; instance < instanceCount; ++instance)
+    {
+        auto machine = std::make_unique<SpaceInvaders>();
+        
+        if(!machine->loadGame(argv[1]))
+        {
+            std::cout << "Warning game failed to load from " << argv[1] << std::endl;
+            return EXIT_FAILURE;
+        }
+        
+        //Thousands of machines all printing sounds would spend their time waiting on the console
+        machine->setSoundOutput(nullptr);
+        
+        if(recompile && !machine->setRecompilerEnabled(true))
+        {
+            std::cout << "Recompiler isn't available on this host, interpreting instead" << std::endl;
+            recompile = false;
+        }
+        
+        runner.addInstance(std::move(machine));
+    }
+    
+    //Every machine plays the whole movie, so they should all finish on its RAM hash
+    InputMovie movie;
+    BatchRunner::InputSource inputSource;
+    
+    if(!replayFile.empty())
+    {
+        std::ifstream movieStream(replayFile, std::ios::binary);
+        
+        if(!movieStream.is_open() || !movie.read(movieStream))
+        {
+            std::cout << "Couldn't read a movie from " << replayFile << std::endl;
+            return EXIT_FAILURE;
+        }
+        
+        if(instanceCount > 0 && movie.getROMHash() != runner.getInstance(0).getROMHash())
+        {
+            std::cout << "Movie was recorded on a different ROM" << std::endl;
+            return EXIT_FAILURE;
+        }
+        
+        frameCount = movie.getFrameCount();
+        
+        inputSource = [&movie](size_t, uint64_t frame)
+        {
+            return movie.getFrame(frame);
+        };
+    }
+    else if(fuzz)
+    {
+        //Each machine holds its own random keys for half a second at a time
+        inputSource = [fuzzSeed](size_t instance, uint64_t frame)
+        {
+            SpaceInvaders::Inputs inputs;
+            inputs.port1 |= mix(mix(fuzzSeed ^ instance) + frame / 30) & 0x75;
+            return inputs;
+        };
+    }
+    
+    runner.runFrames(frameCount, inputSource);
+    
+    uint64_t instructionCount = 0;
+    std::set<uint64_t> ramHashes;
+    size_t matchingCount = 0;
+    
+    for(size_t instance = 0; instance < runner.getInstanceCount(); ++instance)
+    {
+        const SpaceInvaders& machine = runner.getInstance(instance);
+        
+        instructionCount += machine.getInstructionCount();
+        ramHashes.insert(machine.getRAMHash());
+        matchingCount += machine.getRAMHash() == movie.getRAMHash();
+    }
+    
+    const double seconds = runner.getFramesPerSecond() > 0.0 ? runner.getFramesRun() / runner.getFramesPerSecond() : 0.0;
+    
+    std::cout << "Instances: " << runner.getInstanceCount() << std::endl
+              << "Threads: " << runner.getThreadCount() << std::endl
+              << "Frames: " << runner.getFramesRun() << std::endl
+              << "Time: " << seconds << "s" << std::endl
+              << "Frames per second: " << runner.getFramesPerSecond() << std::endl
+              << "Speed: " << runner.getFramesPerSecond() * SpaceInvaders::frameTimeMS / 1000.0 << "x real time" << std::endl
+              << "MIPS: " << (seconds > 0.0 ? instructionCount / seconds / 1000000.0 : 0.0) << std::endl
+              << "Distinct RAM hashes: " << ramHashes.size() << std::endl;
+    
+    if(lockstep)
+    {
+        std::cout << "Machines per instruction: " << runner.getLanesPerStep() << std::endl;
+    }
+    
+    if(!replayFile.empty())
+    {
+        std::cout << "Matching the recording: " << matchingCount << " of " << runner.getInstanceCount() << std::endl;
+        return matchingCount == runner.getInstanceCount() ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,173 @@
+//
+//  BatchRunner.cpp
+//  Intel_8080_Emulator
+//
+
+#include "BatchRunner.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+BatchRunner::BatchRunner(size_t threadCount, bool pinThreads)  : pool(threadCount, pinThreads)
+{
+    
+}
+
+size_t BatchRunner::addInstance(std::unique_ptr<SpaceInvaders> instance)
+{
+    instances.push_back(std::move(instance));
+    instanceFrames.push_back(0);
+    
+    return instances.size() - 1;
+}
+
+SpaceInvaders& BatchRunner::getInstance(size_t index)
+{
+    return *instances[index];
+}
+
+size_t BatchRunner::getInstanceCount() const
+{
+    return instances.size();
+}
+
+void BatchRunner::setLockstepEnabled(bool enabled)
+{
+    lockstepEnabled = enabled;
+}
+
+void BatchRunner::runFrames(uint64_t frameCount, const InputSource& inputSource)
+{
+    const auto startTime = std::chrono::steady_clock::now();
+    
+    lockstepGroups.clear();
+    
+    if(frameCount > 0 && lockstepEnabled)
+    {
+        for(size_t first = 0; first < instances.size(); first += LockstepInterpreter::laneCount)
+        {
+            std::vector<Intel_8080_Emulator*> groupMachines;
+            
+            for(size_t instance = first; instance < std::min(instances.size(), first + LockstepInterpreter::laneCount); ++instance)
+            {
+                groupMachines.push_back(instances[instance].get());
+            }
+            
+            lockstepGroups.push_back(std::make_unique<LockstepInterpreter>(groupMachines));
+        }
+        
+        for(size_t group = 0; group < lockstepGroups.size(); ++group)
+        {
+            pool.submit([this, group, frameCount, &inputSource]()
+            {
+                runGroupFrame(group, frameCount, inputSource);
+            });
+        }
+        
+        pool.wait();
+    }
+    else if(frameCount > 0)
+    {
+        for(size_t instance = 0; instance < instances.size(); ++instance)
+        {
+            pool.submit([this, instance, frameCount, &inputSource]()
+            {
+                runFrame(instance, frameCount, inputSource);
+            });
+        }
+        
+        pool.wait();
+    }
+    
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+    
+    framesRun = frameCount * instances.size();
+    framesPerSecond = elapsed.count() > 0.0 ? framesRun / elapsed.count() : 0.0;
+    
+    uint64_t instructionCount = 0;
+    uint64_t stepCount = 0;
+    
+    for(const std::unique_ptr<LockstepInterpreter>& interpreter : lockstepGroups)
+    {
+        instructionCount += interpreter->getInstructionCount();
+        stepCount += interpreter->getStepCount();
+    }
+    
+    lanesPerStep = stepCount > 0 ? double(instructionCount) / stepCount : 1.0;
+}
+
+uint64_t BatchRunner::getFramesRun() const
+{
+    return framesRun;
+}
+
+double BatchRunner::getFramesPerSecond() const
+{
+    return framesPerSecond;
+}
+
+double BatchRunner::getLanesPerStep() const
+{
+    return lanesPerStep;
+}
+
+size_t BatchRunner::getThreadCount() const
+{
+    return pool.getThreadCount();
+}
+
+void BatchRunner::runFrame(size_t instance, uint64_t framesLeft, const InputSource& inputSource)
+{
+    SpaceInvaders& machine = *instances[instance];
+    
+    if(inputSource)
+    {
+        machine.runFrame(inputSource(instance, instanceFrames[instance]));
+    }
+    else
+    {
+        machine.runFrame();
+    }
+    
+    ++instanceFrames[instance];
+    
+    //Goes on this worker's own queue, so the machine stays where its memory is warm unless another worker runs dry
+    if(framesLeft > 1)
+    {
+        pool.submit([this, instance, framesLeft, &inputSource]()
+        {
+            runFrame(instance, framesLeft - 1, inputSource);
+        });
+    }
+}
+
+void BatchRunner::runGroupFrame(size_t group, uint64_t framesLeft, const InputSource& inputSource)
+{
+    LockstepInterpreter& interpreter = *lockstepGroups[group];
+    const size_t first = group * LockstepInterpreter::laneCount;
+    
+    std::array<uint64_t, LockstepInterpreter::laneCount> cycles{};
+    
+    for(size_t lane = 0; lane < interpreter.getMachineCount(); ++lane)
+    {
+        cycles[lane] = startGroupFrame(first + lane, inputSource);
+    }
+    
+    interpreter.runFor(std::span(cycles).first(interpreter.getMachineCount()));
+    
+    if(framesLeft > 1)
+    {
+        pool.submit([this, group, framesLeft, &inputSource]()
+        {
+            runGroupFrame(group, framesLeft - 1, inputSource);
+        });
+    }
+}
+
+uint64_t BatchRunner::startGroupFrame(size_t instance, const InputSource& inputSource)
+{
+    SpaceInvaders& machine = *instances[instance];
+    const uint64_t frame = instanceFrames[instance]++;
+    
+    return inputSource ? machine.startFrame(inputSource(instance, frame)) : machine.startFrame();
+}
@@ -0,0 +1,74 @@
+//
+//  BatchRunner.hpp
+//  Intel_8080_Emulator
+//
+
+#pragma once
+
+#include "LockstepInterpreter.hpp"
+#include "SpaceInvaders.hpp"
+#include "ThreadPool.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+//Runs many independent headless machines at once over a thread pool, a frame at a time
+//Each frame of each machine is one task, which queues the machine's next frame when it finishes,
+//so a machine only ever runs on one thread at once but can move to an idle one between any two frames
+class BatchRunner
+{
+public:
+    //Inputs for a machine's next frame, given its index and how many frames it has run. Called from the worker threads
+    using InputSource = std::function<SpaceInvaders::Inputs(size_t instance, uint64_t frame)>;
+    
+    explicit BatchRunner(size_t threadCount = std::thread::hardware_concurrency(), bool pinThreads = true);
+    
+    //Returns the index of the machine, which can't be added while frames are running
+    size_t addInstance(std::unique_ptr<SpaceInvaders> instance);
+    
+    SpaceInvaders& getInstance(size_t index);
+    size_t getInstanceCount() const;
+    
+    //Runs the machines in groups through a LockstepInterpreter, a task for each group's frame instead of each machine's
+    //Machines in step with each other, like ones replaying the same movie, then share the work of each instruction
+    void setLockstepEnabled(bool enabled);
+    
+    //Runs every machine for the given number of frames and waits for them all to finish
+    //Without an input source the machines read their own keys, which nothing presses
+    void runFrames(uint64_t frameCount, const InputSource& inputSource = {});
+    
+    //Frames run by every machine together, and how fast they went, over the last call to runFrames
+    uint64_t getFramesRun() const;
+    double getFramesPerSecond() const;
+    
+    //Average number of machines each instruction was run for at once over the last call, 1 when lockstep isn't enabled
+    double getLanesPerStep() const;
+    
+    size_t getThreadCount() const;
+
+private:
+    void runFrame(size_t instance, uint64_t framesLeft, const InputSource& inputSource);
+    void runGroupFrame(size_t group, uint64_t framesLeft, const InputSource& inputSource);
+    
+    //Latches the machine's inputs for its next frame and returns how many cycles the group has to run it for
+    uint64_t startGroupFrame(size_t instance, const InputSource& inputSource);
+    
+    std::vector<std::unique_ptr<SpaceInvaders>> instances;
+    
+    //Frames each machine has run since it was added, only touched by the task running its next frame
+    std::vector<uint64_t> instanceFrames;
+    
+    bool lockstepEnabled = false;
+    
+    //Built for each call to runFrames, every laneCount machines in the order they were added
+    std::vector<std::unique_ptr<LockstepInterpreter>> lockstepGroups;
+    
+    uint64_t framesRun = 0;
+    double framesPerSecond = 0.0;
+    double lanesPerStep = 1.0;
+    
+    //Last, so it is stopped before anything its tasks use goes
+    ThreadPool pool;
+};
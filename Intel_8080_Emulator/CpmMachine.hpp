@@ -0,0 +1,162 @@
+//
+//  CpmMachine.hpp
+//  Intel_8080_Emulator
+//
+
+#pragma once
+
+#include "Intel_8080_Machine.hpp"
+
+#include <algorithm>
+#include <ostream>
+#include <span>
+#include <vector>
+
+//Runs CP/M programs like the cpudiag CPU test, with just enough of the system to print their output
+//Memory is RAM all the way through. Calls to the BDOS at 0x0005 end up at a stub that passes them on through an OUT
+//and jumping to 0x0000 to go back to CP/M finishes the program
+template<typename Instrumentation = NoInstrumentation>
+class CpmMachine : public Intel_8080_Machine<CpmMachine<Instrumentation>, Instrumentation>
+{
+    friend class Intel_8080_Machine<CpmMachine<Instrumentation>, Instrumentation>;
+    
+public:
+    //Output printed by the program goes to the console stream
+    explicit CpmMachine(std::ostream& console);
+    
+    //Loads a .COM file at 0x100, where CP/M starts them
+    bool loadProgram(std::span<const uint8_t> program);
+    
+    //Runs until the program finishes or the cycles run out, returns whether it finished
+    bool run(uint64_t maxCycles);
+    
+    using Intel_8080_Emulator::getCycleCount;
+    using Intel_8080_Emulator::getInstructionCount;
+    
+private:
+    uint8_t inputOperation(uint8_t port);
+    void outputOperation(uint8_t port, uint8_t value);
+    
+    void saveMachineState(std::vector<uint8_t>& state) const override;
+    void restoreMachineState(std::span<const uint8_t> state) override;
+    
+    void print(char character);
+    
+    static constexpr uint16_t programStart = 0x100;
+    static constexpr uint16_t bdosAddress = 0xFE00;
+    
+    static constexpr uint8_t bdosPort = 0x0;
+    static constexpr uint8_t exitPort = 0x1;
+    
+    //Checked for finishing in between batches of this many cycles
+    static constexpr uint64_t runBatchCycles = 10000;
+    
+    std::ostream& console;
+    bool finished = false;
+    
+    //Characters the program has printed, which go back with a snapshot, and characters the console has actually been given, which don't
+    //Running again from an earlier snapshot prints the same characters, and the console only needs them once
+    uint64_t printedCount = 0;
+    uint64_t consoleCount = 0;
+};
+
+template<typename Instrumentation>
+CpmMachine<Instrumentation>::CpmMachine(std::ostream& consoleStream)  : console(consoleStream)
+{
+    //Warm boot at 0x0000 reports the exit then halts, 0x0005 jumps to the BDOS, which also gives programs the top of their memory in 0x0006
+    const uint8_t zeroPage[] = {0xD3, exitPort, 0x76, 0x0, 0x0, 0xC3, bdosAddress & 0xFF, bdosAddress >> 8};
+    this->loadMemory(0x0, zeroPage);
+    
+    //OUT then RET, the call number is in C
+    const uint8_t bdos[] = {0xD3, bdosPort, 0xC9};
+    this->loadMemory(bdosAddress, bdos);
+}
+
+template<typename Instrumentation>
+bool CpmMachine<Instrumentation>::loadProgram(std::span<const uint8_t> program)
+{
+    if(programStart + program.size() > bdosAddress)
+    {
+        return false;
+    }
+    
+    this->programCounter = programStart;
+    return this->loadMemory(programStart, program);
+}
+
+template<typename Instrumentation>
+bool CpmMachine<Instrumentation>::run(uint64_t maxCycles)
+{
+    while(!finished && getCycleCount() < maxCycles)
+    {
+        this->runFor(std::min(runBatchCycles, maxCycles - getCycleCount()));
+    }
+    
+    return finished;
+}
+
+template<typename Instrumentation>
+uint8_t CpmMachine<Instrumentation>::inputOperation(uint8_t)
+{
+    return 0x0;
+}
+
+template<typename Instrumentation>
+void CpmMachine<Instrumentation>::outputOperation(uint8_t port, uint8_t)
+{
+    if(port == exitPort)
+    {
+        finished = true;
+        return;
+    }
+    
+    if(port != bdosPort)
+    {
+        return;
+    }
+    
+    const RegisterManager& registers = this->getRegisters();
+    
+    switch(registers.getRegisterValue(RegisterManager::Register::C))
+    {
+        //Print the character in E
+        case 2:
+            print(registers.getRegisterValue(RegisterManager::Register::E));
+            break;
+            
+        //Print the string at DE, up to a $
+        case 9:
+            for(uint16_t address = registers.getValueFromRegisterPair(RegisterManager::RegisterPair::DE); this->readMemory(address) != '$'; ++address)
+            {
+                print(this->readMemory(address));
+            }
+            break;
+            
+        default:
+            break;
+    }
+}
+
+template<typename Instrumentation>
+void CpmMachine<Instrumentation>::saveMachineState(std::vector<uint8_t>& state) const
+{
+    Snapshot::appendValue(state, finished, 1);
+    Snapshot::appendValue(state, printedCount, 8);
+}
+
+template<typename Instrumentation>
+void CpmMachine<Instrumentation>::restoreMachineState(std::span<const uint8_t> state)
+{
+    finished = Snapshot::takeValue(state, 1);
+    printedCount = Snapshot::takeValue(state, 8);
+}
+
+template<typename Instrumentation>
+void CpmMachine<Instrumentation>::print(char character)
+{
+    if(printedCount++ == consoleCount)
+    {
+        console << character;
+        ++consoleCount;
+    }
+}
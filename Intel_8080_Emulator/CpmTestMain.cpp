@@ -0,0 +1,280 @@
+//
+//  CpmTestMain.cpp
+//  Intel_8080_Emulator
+//
+
+#include "CpmMachine.hpp"
+#include "TimeTravelDebugger.hpp"
+
+#include <algorithm>
+#include <csignal>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+    //Long enough for any of the usual test programs
+    constexpr uint64_t maxCycles = 1000 * Intel_8080_Emulator::clockSpeed;
+    
+    //How often a run checks whether it has been interrupted
+    constexpr uint64_t interruptCheckCycles = Intel_8080_Emulator::clockSpeed / 100;
+    
+    //Set from the SIGINT handler while running with --ring, so the run stops and the ring is written out as usual
+    volatile std::sig_atomic_t interrupted = 0;
+    
+    void stopOnInterrupt(int)
+    {
+        interrupted = 1;
+    }
+    
+    template<typename Instrumentation>
+    bool runProgram(CpmMachine<Instrumentation>& machine, const std::vector<uint8_t>& program)
+    {
+        if(!machine.loadProgram(program))
+        {
+            std::cout << "Program is too big" << std::endl;
+            return false;
+        }
+        
+        bool finished = false;
+        
+        while(!finished && !interrupted && machine.getCycleCount() < maxCycles)
+        {
+            finished = machine.run(std::min(machine.getCycleCount() + interruptCheckCycles, maxCycles));
+        }
+        
+        std::cout << std::endl << "Cycles: " << machine.getCycleCount() << std::endl
+                  << "Instructions: " << machine.getInstructionCount() << std::endl;
+        
+        if(interrupted)
+        {
+            std::cout << "Interrupted" << std::endl;
+        }
+        else if(!finished)
+        {
+            std::cout << "Didn't finish" << std::endl;
+        }
+        
+        return finished;
+    }
+    
+    void printDebuggerState(const TimeTravelDebugger& debugger)
+    {
+        const RegisterManager& registers = debugger.getRegisters();
+        const uint8_t opcode = debugger.readMemory(debugger.getProgramCounter());
+        
+        std::cout << std::hex << std::setfill('0')
+                  << "PC " << std::setw(4) << debugger.getProgramCounter() << " " << Intel_8080_Emulator::getOpName(opcode)
+                  << "  A " << std::setw(2) << int(registers.getRegisterValue(RegisterManager::Register::A))
+                  << " F " << std::setw(2) << int(debugger.getFlags())
+                  << " BC " << std::setw(4) << registers.getValueFromRegisterPair(RegisterManager::RegisterPair::BC)
+                  << " DE " << std::setw(4) << registers.getValueFromRegisterPair(RegisterManager::RegisterPair::DE)
+                  << " HL " << std::setw(4) << registers.getValueFromRegisterPair(RegisterManager::RegisterPair::HL)
+                  << " SP " << std::setw(4) << registers.getValueFromRegisterPair(RegisterManager::RegisterPair::SP)
+                  << std::dec << std::setfill(' ') << "  (step " << debugger.getPosition() << ")" << std::endl;
+    }
+    
+    //Reads commands from stdin to step the program backwards and forwards, anything the program prints is only printed the first time
+    bool debugProgram(CpmMachine<>& machine, const std::vector<uint8_t>& program, uint64_t checkpointInterval)
+    {
+        if(!machine.loadProgram(program))
+        {
+            std::cout << "Program is too big" << std::endl;
+            return false;
+        }
+        
+        TimeTravelDebugger debugger(machine, checkpointInterval);
+        
+        std::cout << "Commands: s [count], rs [count], c, rc, b <address>, w <address>, q" << std::endl;
+        printDebuggerState(debugger);
+        
+        for(std::string line; std::getline(std::cin, line);)
+        {
+            std::istringstream lineStream(line);
+            std::string command;
+            lineStream >> command;
+            
+            //Counts and addresses can be given in decimal or hex with a 0x prefix
+            uint64_t argument = 0;
+            const bool hasArgument = bool(lineStream >> std::setbase(0) >> argument);
+            
+            if(command == "s" || command == "rs")
+            {
+                for(uint64_t stepCount = 0; stepCount < (hasArgument ? argument : 1); ++stepCount)
+                {
+                    if(!(command == "s" ? debugger.step() : debugger.reverseStep()))
+                    {
+                        std::cout << (command == "s" ? "Halted" : "At the start") << std::endl;
+                        break;
+                    }
+                }
+            }
+            else if(command == "c")
+            {
+                if(!debugger.continueToBreakpoint())
+                {
+                    std::cout << "Halted" << std::endl;
+                }
+            }
+            else if(command == "rc")
+            {
+                if(!debugger.reverseContinue())
+                {
+                    std::cout << "No breakpoint before here, back at the start" << std::endl;
+                }
+            }
+            else if(command == "b" && hasArgument)
+            {
+                debugger.setBreakpoint(argument, !debugger.hasBreakpoint(argument));
+                std::cout << "Breakpoint at 0x" << std::hex << argument << std::dec << (debugger.hasBreakpoint(argument) ? " set" : " cleared") << std::endl;
+                continue;
+            }
+            else if(command == "w" && hasArgument)
+            {
+                if(const std::optional<TimeTravelDebugger::Write> write = debugger.findLastWrite(argument))
+                {
+                    std::cout << "Last written at step " << write->position << " by the instruction at 0x" << std::hex << write->programCounter << std::dec << ", cycle " << write->cycle << std::endl;
+                }
+                else
+                {
+                    std::cout << "Not written to since the start" << std::endl;
+                }
+                
+                continue;
+            }
+            else if(command == "q")
+            {
+                break;
+            }
+            else
+            {
+                std::cout << "Commands: s [count], rs [count], c, rc, b <address>, w <address>, q" << std::endl;
+                continue;
+            }
+            
+            printDebuggerState(debugger);
+        }
+        
+        return true;
+    }
+}
+
+//Runs a CP/M test program like cpudiag, printing what it prints
+//Usage: cpm_test <program> [--trace <file>] [--ring <file>] [--count] [--debug] [--checkpoint-interval <steps>]
+int main(int argc, char const** argv)
+{
+    if(argc < 2)
+    {
+        std::cout << "Usage: " << argv[0] << " <program> [--trace <file>] [--ring <file>] [--count] [--debug] [--checkpoint-interval <steps>]" << std::endl;
+        return EXIT_FAILURE;
+    }
+    
+    const char* traceFile = nullptr;
+    const char* ringFile = nullptr;
+    bool count = false;
+    bool debug = false;
+    uint64_t checkpointInterval = 100000;
+    
+    for(int argIndex = 2; argIndex < argc; ++argIndex)
+    {
+        const std::string_view arg = argv[argIndex];
+        
+        if(arg == "--trace" && argIndex + 1 < argc)
+        {
+            traceFile = argv[++argIndex];
+        }
+        else if(arg == "--ring" && argIndex + 1 < argc)
+        {
+            ringFile = argv[++argIndex];
+        }
+        else if(arg == "--count")
+        {
+            count = true;
+        }
+        else if(arg == "--debug")
+        {
+            debug = true;
+        }
+        else if(arg == "--checkpoint-interval" && argIndex + 1 < argc)
+        {
+            checkpointInterval = std::stoull(argv[++argIndex]);
+        }
+    }
+    
+    std::ifstream fileStream(argv[1], std::ios::binary);
+    
+    if(!fileStream.is_open())
+    {
+        std::cout << "Couldn't open " << argv[1] << std::endl;
+        return EXIT_FAILURE;
+    }
+    
+    const std::vector<uint8_t> program(std::istreambuf_iterator<char>(fileStream), {});
+    
+    bool finished;
+    
+    if(debug)
+    {
+        CpmMachine<> machine(std::cout);
+        
+        finished = debugProgram(machine, program, checkpointInterval);
+    }
+    else if(traceFile != nullptr)
+    {
+        std::ofstream traceStream(traceFile, std::ios::binary);
+        
+        if(!traceStream.is_open())
+        {
+            std::cout << "Couldn't open " << traceFile << std::endl;
+            return EXIT_FAILURE;
+        }
+        
+        CpmMachine<FullTraceInstrumentation> machine(std::cout);
+        machine.getInstrumentation().setOutput(&traceStream);
+        
+        finished = runProgram(machine, program);
+    }
+    else if(ringFile != nullptr)
+    {
+        CpmMachine<TraceRingInstrumentation<>> machine(std::cout);
+        
+        //Writing the ring out allocates, which can't be done in a signal handler, so Ctrl-C just stops the run
+        std::signal(SIGINT, stopOnInterrupt);
+        
+        finished = runProgram(machine, program);
+        
+        std::signal(SIGINT, SIG_DFL);
+        
+        std::ofstream ringStream(ringFile, std::ios::binary);
+        machine.getInstrumentation().dump(ringStream);
+    }
+    else if(count)
+    {
+        CpmMachine<CountingInstrumentation> machine(std::cout);
+        
+        finished = runProgram(machine, program);
+        
+        for(int opcode = 0; opcode < 256; ++opcode)
+        {
+            if(const uint64_t opcodeCount = machine.getInstrumentation().getCount(opcode); opcodeCount != 0)
+            {
+                std::cout << "0x" << std::hex << opcode << std::dec << " " << Intel_8080_Emulator::getOpName(opcode) << ": " << opcodeCount << std::endl;
+            }
+        }
+    }
+    else
+    {
+        CpmMachine<> machine(std::cout);
+        
+        finished = runProgram(machine, program);
+    }
+    
+    return finished ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,90 @@
+//
+//  CpuBenchmarkMain.cpp
+//  Intel_8080_Emulator
+//
+
+#include "NullMachine.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <vector>
+
+//Runs a program on the CPU with nothing connected to it, to measure the core without any machine
+//Usage: cpu_benchmark <binary> [load address] [cycles] [--jit] [--switch] [--switch]
+int main(int argc, char const** argv)
+{
+    if(argc < 2)
+    {
+        std::cout << "Usage: " << argv[0] << " <binary> [load address] [cycles] [--jit]" << std::endl;
+        return EXIT_FAILURE;
+    }
+    
+    std::vector<std::string_view> positional;
+    bool recompile = false;
+    bool switchDispatch = false;
+    
+    for(int argIndex = 2; argIndex < argc; ++argIndex)
+    {
+        if(std::string_view(argv[argIndex]) == "--jit")
+        {
+            recompile = true;
+        }
+        else if(std::string_view(argv[argIndex]) == "--switch")
+        {
+            switchDispatch = true;
+        }
+        else
+        {
+            positional.push_back(argv[argIndex]);
+        }
+    }
+    
+    //Addresses can be given in decimal or hex with a 0x prefix
+    const uint16_t loadAddress = positional.size() > 0 ? std::stoul(std::string(positional[0]), nullptr, 0) : 0x100;
+    const uint64_t cycleCount = positional.size() > 1 ? std::stoull(std::string(positional[1])) : 100 * Intel_8080_Emulator::clockSpeed;
+    
+    std::ifstream fileStream(argv[1], std::ios::binary);
+    
+    if(!fileStream.is_open())
+    {
+        std::cout << "Couldn't open " << argv[1] << std::endl;
+        return EXIT_FAILURE;
+    }
+    
+    const std::vector<uint8_t> program(std::istreambuf_iterator<char>(fileStream), {});
+    
+    NullMachine machine;
+    
+    if(!machine.loadProgram(program, loadAddress))
+    {
+        std::cout << "Program doesn't fit in memory at that address" << std::endl;
+        return EXIT_FAILURE;
+    }
+    
+    if(recompile && !machine.setRecompilerEnabled(true))
+    {
+        std::cout << "Recompiler isn't available on this host, interpreting instead" << std::endl;
+    }
+    
+    //For comparing against the table, the handlers are found the way the interpreter used to before it had one
+    machine.setSwitchDispatch(switchDispatch);
+    
+    const auto startTime = std::chrono::steady_clock::now();
+    
+    machine.runFor(cycleCount);
+    
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+    const double seconds = elapsed.count();
+    
+    std::cout << "Cycles: " << machine.getCycleCount() << std::endl
+              << "Instructions: " << machine.getInstructionCount() << std::endl
+              << "Time: " << seconds << "s" << std::endl
+              << "MIPS: " << machine.getInstructionCount() / seconds / 1000000.0 << std::endl;
+    
+    return EXIT_SUCCESS;
+}
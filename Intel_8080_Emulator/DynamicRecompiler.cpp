@@ -0,0 +1,501 @@
+//
+//  DynamicRecompiler.cpp
+//  Intel_8080_Emulator
+//
+
+#include "DynamicRecompiler.hpp"
+#include "Intel_8080_Emulator.hpp"
+#include "OpcodeInfo.hpp"
+
+#include <cstring>
+#include <initializer_list>
+
+#if defined(__x86_64__) && !defined(_WIN32)
+#include <sys/mman.h>
+#define RECOMPILER_SUPPORTED 1
+#else
+#define RECOMPILER_SUPPORTED 0
+#endif
+
+namespace
+{
+    //Appends raw x86-64 machine code
+    class CodeEmitter
+    {
+    public:
+        explicit CodeEmitter(uint8_t* destination)  : start(destination), current(destination)
+        {
+            
+        }
+        
+        void emit(std::initializer_list<uint8_t> bytes)
+        {
+            for(const uint8_t byte : bytes)
+            {
+                *current++ = byte;
+            }
+        }
+        
+        void emitByte(uint8_t value)
+        {
+            *current++ = value;
+        }
+        
+        void emitWord(uint16_t value)
+        {
+            std::memcpy(current, &value, sizeof(value));
+            current += sizeof(value);
+        }
+        
+        void emitDword(int32_t value)
+        {
+            std::memcpy(current, &value, sizeof(value));
+            current += sizeof(value);
+        }
+        
+        void emitQword(uint64_t value)
+        {
+            std::memcpy(current, &value, sizeof(value));
+            current += sizeof(value);
+        }
+        
+        //Relative offset to a target from the end of an instruction with this many bytes left to write
+        int32_t relativeTo(const uint8_t* target, int remainingBytes) const
+        {
+            return int32_t(target - (current + remainingBytes));
+        }
+        
+        uint8_t* getCurrent() const
+        {
+            return current;
+        }
+        
+        size_t getSize() const
+        {
+            return current - start;
+        }
+        
+    private:
+        uint8_t* start;
+        uint8_t* current;
+    };
+}
+
+DynamicRecompiler::DynamicRecompiler(Intel_8080_Emulator& emulatorToRun)  : emulator(emulatorToRun)
+{
+    //Translated code finds everything relative to the emulator passed in
+    const auto getOffset = [this](const void* member)
+    {
+        return int32_t(reinterpret_cast<const uint8_t*>(member) - reinterpret_cast<const uint8_t*>(&emulator));
+    };
+    
+    registersOffset = getOffset(emulator.registers.registers.data());
+    readPagesOffset = getOffset(emulator.memoryBus.getReadPages().data());
+    programCounterOffset = getOffset(&emulator.programCounter);
+    cycleCountOffset = getOffset(&emulator.cycleCount);
+    instructionCountOffset = getOffset(&emulator.opCounter);
+    codeModifiedOffset = getOffset(&emulator.codeModified);
+
+#if RECOMPILER_SUPPORTED
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+
+#if defined(MAP_JIT)
+    flags |= MAP_JIT;
+#endif
+    
+    if(void* cache = mmap(nullptr, codeCacheSize, PROT_READ | PROT_WRITE | PROT_EXEC, flags, -1, 0); cache != MAP_FAILED)
+    {
+        codeCache = static_cast<uint8_t*>(cache);
+    }
+#endif
+}
+
+DynamicRecompiler::~DynamicRecompiler()
+{
+#if RECOMPILER_SUPPORTED
+    if(codeCache != nullptr)
+    {
+        munmap(codeCache, codeCacheSize);
+    }
+#endif
+}
+
+bool DynamicRecompiler::isSupported()
+{
+    return RECOMPILER_SUPPORTED;
+}
+
+void DynamicRecompiler::execute(uint64_t stopCycle)
+{
+    const uint16_t address = emulator.programCounter;
+    
+    if(codeCache == nullptr || OpcodeInfo::needsInterpreter(emulator.readMemory(address)))
+    {
+        emulator.runCycle();
+        return;
+    }
+    
+    BlockFunction& block = blocks[address];
+    
+    if(block == nullptr)
+    {
+        block = compileBlock(address);
+        
+        //Nothing at this address could be translated
+        if(block == nullptr)
+        {
+            emulator.runCycle();
+            return;
+        }
+    }
+    
+    emulator.codeModified = false;
+    block(&emulator, stopCycle);
+}
+
+bool DynamicRecompiler::invalidatePage(uint8_t page)
+{
+    if(pageBlocks[page].empty())
+    {
+        return false;
+    }
+    
+    //Other pages a block spans may still list it, at worst that throws away a newer block at the same address later on
+    for(const uint16_t startAddress : pageBlocks[page])
+    {
+        blocks[startAddress] = nullptr;
+    }
+    
+    pageBlocks[page].clear();
+    
+    return true;
+}
+
+void DynamicRecompiler::flush()
+{
+    blocks.fill(nullptr);
+    
+    for(std::vector<uint16_t>& startAddresses : pageBlocks)
+    {
+        startAddresses.clear();
+    }
+    
+    codeCacheUsed = 0;
+}
+
+void DynamicRecompiler::executeOpcode(Intel_8080_Emulator* emulator, uint8_t opcode)
+{
+    //Some handlers still look at the current opcode rather than the one passed in
+    emulator->currentOpcode = opcode;
+    emulator->decodeAndExecute(opcode);
+}
+
+uint8_t DynamicRecompiler::readMemory(Intel_8080_Emulator* emulator, uint16_t address)
+{
+    return emulator->readMemory(address);
+}
+
+DynamicRecompiler::BlockFunction DynamicRecompiler::compileBlock(uint16_t startAddress)
+{
+#if RECOMPILER_SUPPORTED
+    using Register = RegisterManager::Register;
+    using RegisterPair = RegisterManager::RegisterPair;
+    
+    if(codeCacheSize - codeCacheUsed < maxBlockInstructions * maxInstructionBytes + 64)
+    {
+        flush();
+    }
+    
+    CodeEmitter code(codeCache + codeCacheUsed);
+    
+    const auto registerOffset = [this](Register reg)
+    {
+        return registersOffset + static_cast<uint8_t>(reg);
+    };
+    
+    const auto pairOffset = [this](RegisterPair pair)
+    {
+        return registersOffset + static_cast<uint8_t>(pair) * 2;
+    };
+    
+    //Every exit jumps back here, rbx holds the emulator and r12 the cycle to stop at
+    const uint8_t* exitAddress = code.getCurrent();
+    
+    code.emit({0x41, 0x5D});                                //pop r13
+    code.emit({0x41, 0x5C});                                //pop r12
+    code.emit({0x5B});                                      //pop rbx
+    code.emit({0xC3});                                      //ret
+    
+    const BlockFunction entry = reinterpret_cast<BlockFunction>(code.getCurrent());
+    
+    //r13 is only pushed to keep the stack aligned for calls
+    code.emit({0x53});                                      //push rbx
+    code.emit({0x41, 0x54});                                //push r12
+    code.emit({0x41, 0x55});                                //push r13
+    code.emit({0x48, 0x89, 0xFB});                          //mov rbx, rdi
+    code.emit({0x49, 0x89, 0xF4});                          //mov r12, rsi
+    
+    const auto jumpToExit = [&code, exitAddress]()
+    {
+        code.emitByte(0xE9);                                //jmp exit
+        code.emitDword(code.relativeTo(exitAddress, 4));
+    };
+    
+    const auto setProgramCounter = [&code, this](uint16_t value)
+    {
+        code.emit({0x66, 0xC7, 0x83});                      //mov word [rbx + pc], value
+        code.emitDword(programCounterOffset);
+        code.emitWord(value);
+    };
+    
+    const auto loadByte = [&code](int32_t offset)
+    {
+        code.emit({0x0F, 0xB6, 0x83});                      //movzx eax, byte [rbx + offset]
+        code.emitDword(offset);
+    };
+    
+    const auto storeByte = [&code](int32_t offset)
+    {
+        code.emit({0x88, 0x83});                            //mov byte [rbx + offset], al
+        code.emitDword(offset);
+    };
+    
+    const auto loadWord = [&code](int32_t offset)
+    {
+        code.emit({0x0F, 0xB7, 0x83});                      //movzx eax, word [rbx + offset]
+        code.emitDword(offset);
+    };
+    
+    const auto storeWord = [&code](int32_t offset)
+    {
+        code.emit({0x66, 0x89, 0x83});                      //mov word [rbx + offset], ax
+        code.emitDword(offset);
+    };
+    
+    //Looks the page up on the memory bus, pages without a pointer have a handler so are read through the emulator
+    const auto loadMemoryAtAX = [&code, this]()
+    {
+        code.emit({0x0F, 0xB6, 0xCC});                      //movzx ecx, ah
+        code.emit({0x48, 0x8B, 0x94, 0xCB});                //mov rdx, [rbx + rcx * 8 + readPages]
+        code.emitDword(readPagesOffset);
+        code.emit({0x48, 0x85, 0xD2});                      //test rdx, rdx
+        code.emit({0x74, 9});                               //jz handler
+        code.emit({0x0F, 0xB6, 0xC0});                      //movzx eax, al
+        code.emit({0x0F, 0xB6, 0x04, 0x02});                //movzx eax, byte [rdx + rax]
+        code.emit({0xEB, 17});                              //jmp done
+        code.emit({0x48, 0x89, 0xDF});                      //handler: mov rdi, rbx
+        code.emit({0x89, 0xC6});                            //mov esi, eax
+        code.emit({0x48, 0xB8});                            //mov rax, readMemory
+        code.emitQword(reinterpret_cast<uint64_t>(&DynamicRecompiler::readMemory));
+        code.emit({0xFF, 0xD0});                            //call rax
+    };
+    
+    const auto loadAddress = [&code](uint16_t address)
+    {
+        code.emitByte(0xB8);                                //mov eax, address
+        code.emitDword(address);
+    };
+    
+    const auto addCycles = [&code, this](uint8_t opcode)
+    {
+        code.emit({0x48, 0x83, 0x83});                      //add qword [rbx + cycleCount], cycles
+        code.emitDword(cycleCountOffset);
+        code.emitByte(Intel_8080_Emulator::opCycles[opcode]);
+        
+        code.emit({0x48, 0xFF, 0x83});                      //inc qword [rbx + opCounter]
+        code.emitDword(instructionCountOffset);
+    };
+    
+    uint16_t address = startAddress;
+    uint16_t blockEnd = startAddress;
+    int instructionCount = 0;
+    
+    while(true)
+    {
+        const uint8_t opcode = emulator.readMemory(address);
+        const uint8_t length = OpcodeInfo::getLength(opcode);
+        
+        //Interrupts and I/O have to be seen by the machine, and a block can't wrap round the top of memory
+        if(instructionCount == maxBlockInstructions || OpcodeInfo::needsInterpreter(opcode) || address + length > 0x10000)
+        {
+            if(instructionCount == 0)
+            {
+                return nullptr;
+            }
+            
+            setProgramCounter(address);
+            jumpToExit();
+            break;
+        }
+        
+        const uint16_t nextAddress = address + length;
+        const uint16_t operand = length == 1 ? 0 : emulator.readMemory(address + 1) | (length == 3 ? emulator.readMemory(address + 2) << 8 : 0);
+        
+        const uint8_t destination = (opcode >> 3) & 0x7;
+        const uint8_t source = opcode & 0x7;
+        const RegisterPair pair = RegisterManager::getPairFromEncodedValue((opcode >> 4) & 0x3);
+        
+        ++instructionCount;
+        blockEnd = nextAddress;
+        
+        //Unconditional jumps are the only branch translated directly
+        if(opcode == 0xC3)
+        {
+            setProgramCounter(operand);
+            addCycles(opcode);
+            jumpToExit();
+            break;
+        }
+        
+        bool translated = true;
+        
+        //00000000 - No Operation
+        if(opcode == 0x00)
+        {
+            
+        }
+        //01DDDSSS - Move register to register
+        else if((opcode & 0xC0) == 0x40 && destination != 6 && source != 6)
+        {
+            loadByte(registerOffset(RegisterManager::getRegFromEncodedValue(source)));
+            storeByte(registerOffset(RegisterManager::getRegFromEncodedValue(destination)));
+        }
+        //01DDD110 - Move from memory
+        else if((opcode & 0xC7) == 0x46 && destination != 6)
+        {
+            loadWord(pairOffset(RegisterPair::HL));
+            loadMemoryAtAX();
+            storeByte(registerOffset(RegisterManager::getRegFromEncodedValue(destination)));
+        }
+        //00DDD110 - Move immediate
+        else if((opcode & 0xC7) == 0x06 && destination != 6)
+        {
+            code.emit({0xC6, 0x83});                        //mov byte [rbx + reg], value
+            code.emitDword(registerOffset(RegisterManager::getRegFromEncodedValue(destination)));
+            code.emitByte(operand);
+        }
+        //00RP0001 - Load register pair immediate
+        else if((opcode & 0xCF) == 0x01)
+        {
+            code.emit({0x66, 0xC7, 0x83});                  //mov word [rbx + pair], value
+            code.emitDword(pairOffset(pair));
+            code.emitWord(operand);
+        }
+        //00RP0011 - Increment register pair
+        else if((opcode & 0xCF) == 0x03)
+        {
+            code.emit({0x66, 0xFF, 0x83});                  //inc word [rbx + pair]
+            code.emitDword(pairOffset(pair));
+        }
+        //00RP1011 - Decrement register pair
+        else if((opcode & 0xCF) == 0x0B)
+        {
+            code.emit({0x66, 0xFF, 0x8B});                  //dec word [rbx + pair]
+            code.emitDword(pairOffset(pair));
+        }
+        //000X1010 - Load accumulator indirect
+        else if(opcode == 0x0A || opcode == 0x1A)
+        {
+            loadWord(pairOffset(pair));
+            loadMemoryAtAX();
+            storeByte(registerOffset(Register::A));
+        }
+        //00111010 - Load accumulator direct
+        else if(opcode == 0x3A)
+        {
+            loadAddress(operand);
+            loadMemoryAtAX();
+            storeByte(registerOffset(Register::A));
+        }
+        //00101010 - Load H and L direct
+        else if(opcode == 0x2A)
+        {
+            loadAddress(operand);
+            loadMemoryAtAX();
+            storeByte(registerOffset(Register::L));
+            loadAddress(operand + 1);
+            loadMemoryAtAX();
+            storeByte(registerOffset(Register::H));
+        }
+        //11101011 - Exchange HL with DE
+        else if(opcode == 0xEB)
+        {
+            loadWord(pairOffset(RegisterPair::DE));
+            code.emit({0x0F, 0xB7, 0x8B});                  //movzx ecx, word [rbx + HL]
+            code.emitDword(pairOffset(RegisterPair::HL));
+            code.emit({0x66, 0x89, 0x8B});                  //mov word [rbx + DE], cx
+            code.emitDword(pairOffset(RegisterPair::DE));
+            storeWord(pairOffset(RegisterPair::HL));
+        }
+        //11111001 - Move HL to SP
+        else if(opcode == 0xF9)
+        {
+            loadWord(pairOffset(RegisterPair::HL));
+            storeWord(pairOffset(RegisterPair::SP));
+        }
+        else
+        {
+            translated = false;
+        }
+        
+        if(translated)
+        {
+            addCycles(opcode);
+            
+            //Stop here if that used up the cycles, exactly where the interpreter would have
+            code.emit({0x4C, 0x39, 0xA3});                  //cmp qword [rbx + cycleCount], r12
+            code.emitDword(cycleCountOffset);
+            code.emit({0x72, 14});                          //jb next instruction
+            setProgramCounter(nextAddress);
+            jumpToExit();
+        }
+        else
+        {
+            //Handlers read their operands from the program counter and move it on themselves
+            setProgramCounter(address);
+            
+            code.emit({0x48, 0x89, 0xDF});                  //mov rdi, rbx
+            code.emitByte(0xBE);                            //mov esi, opcode
+            code.emitDword(opcode);
+            code.emit({0x48, 0xB8});                        //mov rax, executeOpcode
+            code.emitQword(reinterpret_cast<uint64_t>(&DynamicRecompiler::executeOpcode));
+            code.emit({0xFF, 0xD0});                        //call rax
+            
+            addCycles(opcode);
+            
+            if(OpcodeInfo::isBranch(opcode))
+            {
+                jumpToExit();
+                break;
+            }
+            
+            //A write into translated code may have thrown this block away
+            code.emit({0x80, 0xBB});                        //cmp byte [rbx + codeModified], 0
+            code.emitDword(codeModifiedOffset);
+            code.emitByte(0x00);
+            code.emit({0x0F, 0x85});                        //jne exit
+            code.emitDword(code.relativeTo(exitAddress, 4));
+            
+            code.emit({0x4C, 0x39, 0xA3});                  //cmp qword [rbx + cycleCount], r12
+            code.emitDword(cycleCountOffset);
+            code.emit({0x0F, 0x83});                        //jae exit
+            code.emitDword(code.relativeTo(exitAddress, 4));
+        }
+        
+        address = nextAddress;
+    }
+    
+    codeCacheUsed += code.getSize();
+    
+    //Register the block with every page it reads code from
+    for(unsigned int page = startAddress >> 8; page <= static_cast<unsigned int>(blockEnd - 1) >> 8; ++page)
+    {
+        pageBlocks[page].push_back(startAddress);
+        emulator.memoryBus.watchPage(page);
+    }
+    
+    return entry;
+#else
+    return nullptr;
+#endif
+}
@@ -0,0 +1,73 @@
+//
+//  DynamicRecompiler.hpp
+//  Intel_8080_Emulator
+//
+
+#pragma once
+
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <vector>
+
+class Intel_8080_Emulator;
+
+//Translates basic blocks of 8080 code into x86-64 and runs them in place of the interpreter
+//Register moves, loads and jumps are translated directly, everything else calls the interpreter's handler for that opcode
+//Only available on x86-64 hosts that aren't Windows, anywhere else isSupported() returns false
+class DynamicRecompiler
+{
+public:
+    explicit DynamicRecompiler(Intel_8080_Emulator& emulatorToRun);
+    ~DynamicRecompiler();
+    
+    DynamicRecompiler(const DynamicRecompiler&) = delete;
+    DynamicRecompiler& operator=(const DynamicRecompiler&) = delete;
+    
+    static bool isSupported();
+    
+    //Runs the block at the program counter, stopping early after any instruction that takes the cycle count to or past stopCycle
+    //Instructions that touch I/O or interrupt state are run one at a time through the interpreter
+    void execute(uint64_t stopCycle);
+    
+    //Throws away every block using code in the given 256 byte page, returns false if there weren't any
+    bool invalidatePage(uint8_t page);
+    
+    //Throws away every block
+    void flush();
+
+private:
+    using BlockFunction = void (*)(Intel_8080_Emulator* emulator, uint64_t stopCycle);
+    
+    BlockFunction compileBlock(uint16_t startAddress);
+    
+    //Called from translated code for any instruction that isn't translated directly
+    static void executeOpcode(Intel_8080_Emulator* emulator, uint8_t opcode);
+    
+    //Called from translated code for loads from pages with a handler
+    static uint8_t readMemory(Intel_8080_Emulator* emulator, uint16_t address);
+    
+    Intel_8080_Emulator& emulator;
+    
+    //Where each piece of state translated code touches sits relative to the emulator
+    int32_t registersOffset;
+    int32_t readPagesOffset;
+    int32_t programCounterOffset;
+    int32_t cycleCountOffset;
+    int32_t instructionCountOffset;
+    int32_t codeModifiedOffset;
+    
+    //Executable memory blocks are written into, emptied completely when it fills up
+    uint8_t* codeCache = nullptr;
+    size_t codeCacheUsed = 0;
+    static constexpr size_t codeCacheSize = 16 * 1024 * 1024;
+    
+    //Stops a block before it could outgrow the space left in the cache
+    static constexpr int maxBlockInstructions = 64;
+    static constexpr size_t maxInstructionBytes = 160;
+    
+    std::array<BlockFunction, 65536> blocks{};
+    
+    //Start addresses of the blocks using each page, so writes know which blocks to throw away
+    std::array<std::vector<uint16_t>, 256> pageBlocks;
+};
@@ -0,0 +1,254 @@
+//
+//  HeadlessMain.cpp
+//  Intel_8080_Emulator
+//
+
+#include "SpaceInvaders.hpp"
+#include "InputMovie.hpp"
+#include "RecompiledProgram.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <string_view>
+
+#ifdef SPACE_INVADERS_AOT
+//Generated by static_recompiler when the build is given a ROM directory
+const RecompiledProgram& getRecompiledProgram();
+#endif
+
+//Runs the game as fast as possible with no window, for batch runs and benchmarking
+//Usage: space_invaders_headless <rom directory> [frames] [--benchmark] [--jit] [--aot] [--profile <file>] [--fuse <file>] [--load-state <file>] [--save-state <file>] [--record <file>] [--replay <file>]
+int main(int argc, char const** argv)
+{
+    if(argc < 2)
+    {
+        std::cout << "Usage: " << argv[0] << " <rom directory> [frames] [--benchmark] [--jit] [--aot] [--profile <file>] [--fuse <file>] [--load-state <file>] [--save-state <file>] [--record <file>] [--replay <file>]" << std::endl;
+        return EXIT_FAILURE;
+    }
+    
+    uint64_t frameCount = 600;
+    bool benchmark = false;
+    bool recompile = false;
+    bool precompiled = false;
+    std::string profileFile;
+    std::string fusionFile;
+    std::string loadStateFile;
+    std::string saveStateFile;
+    std::string recordFile;
+    std::string replayFile;
+    
+    for(int argIndex = 2; argIndex < argc; ++argIndex)
+    {
+        if(std::string_view(argv[argIndex]) == "--benchmark")
+        {
+            benchmark = true;
+        }
+        else if(std::string_view(argv[argIndex]) == "--jit")
+        {
+            recompile = true;
+        }
+        else if(std::string_view(argv[argIndex]) == "--aot")
+        {
+            precompiled = true;
+        }
+        else if(std::string_view(argv[argIndex]) == "--profile" && argIndex + 1 < argc)
+        {
+            profileFile = argv[++argIndex];
+        }
+        else if(std::string_view(argv[argIndex]) == "--fuse" && argIndex + 1 < argc)
+        {
+            fusionFile = argv[++argIndex];
+        }
+        else if(std::string_view(argv[argIndex]) == "--load-state" && argIndex + 1 < argc)
+        {
+            loadStateFile = argv[++argIndex];
+        }
+        else if(std::string_view(argv[argIndex]) == "--save-state" && argIndex + 1 < argc)
+        {
+            saveStateFile = argv[++argIndex];
+        }
+        else if(std::string_view(argv[argIndex]) == "--record" && argIndex + 1 < argc)
+        {
+            recordFile = argv[++argIndex];
+        }
+        else if(std::string_view(argv[argIndex]) == "--replay" && argIndex + 1 < argc)
+        {
+            replayFile = argv[++argIndex];
+        }
+        else
+        {
+            frameCount = std::stoull(argv[argIndex]);
+        }
+    }
+    
+    SpaceInvaders emulator;
+    
+    if(!emulator.loadGame(argv[1]))
+    {
+        std::cout << "Warning game failed to load from " << argv[1] << std::endl;
+        return EXIT_FAILURE;
+    }
+    
+    //Movies are played from power on, with as many frames as were recorded
+    if((!recordFile.empty() || !replayFile.empty()) && !loadStateFile.empty())
+    {
+        std::cout << "Movies start from power on, so can't be used with a saved state" << std::endl;
+        return EXIT_FAILURE;
+    }
+    
+    InputMovie movie;
+    
+    if(!replayFile.empty())
+    {
+        std::ifstream movieStream(replayFile, std::ios::binary);
+        
+        if(!movieStream.is_open() || !movie.read(movieStream))
+        {
+            std::cout << "Couldn't read a movie from " << replayFile << std::endl;
+            return EXIT_FAILURE;
+        }
+        
+        if(movie.getROMHash() != emulator.getROMHash())
+        {
+            std::cout << "Movie was recorded on a different ROM" << std::endl;
+            return EXIT_FAILURE;
+        }
+        
+        frameCount = movie.getFrameCount();
+    }
+    
+    //Carries on from where an earlier run with --save-state stopped
+    if(!loadStateFile.empty())
+    {
+        std::ifstream stateStream(loadStateFile, std::ios::binary);
+        Snapshot state;
+        
+        if(!stateStream.is_open() || !state.read(stateStream))
+        {
+            std::cout << "Couldn't read a snapshot from " << loadStateFile << std::endl;
+            return EXIT_FAILURE;
+        }
+        
+        emulator.restore(state);
+    }
+    
+    if(recompile && !emulator.setRecompilerEnabled(true))
+    {
+        std::cout << "Recompiler isn't available on this host, interpreting instead" << std::endl;
+    }
+    
+    if(precompiled)
+    {
+#ifdef SPACE_INVADERS_AOT
+        if(!emulator.setRecompiledProgram(&getRecompiledProgram()))
+        {
+            std::cout << "ROM doesn't match the one this was built with, interpreting instead" << std::endl;
+        }
+#else
+        std::cout << "Not built with a recompiled ROM, interpreting instead" << std::endl;
+#endif
+    }
+    
+    //Fusions are picked from a profile written by an earlier run with --profile
+    if(!fusionFile.empty())
+    {
+        std::ifstream fusionStream(fusionFile);
+        OpcodeProfile fusionProfile;
+        
+        if(!fusionStream.is_open() || !fusionProfile.load(fusionStream))
+        {
+            std::cout << "Couldn't read a profile from " << fusionFile << std::endl;
+            return EXIT_FAILURE;
+        }
+        
+        std::cout << "Fused sequences: " << emulator.setFusions(&fusionProfile) << std::endl;
+    }
+    
+    OpcodeProfile profile;
+    
+    if(!profileFile.empty())
+    {
+        emulator.setProfile(&profile);
+    }
+    
+    const auto startTime = std::chrono::steady_clock::now();
+    
+    for(uint64_t frame = 0; frame < frameCount; ++frame)
+    {
+        if(replayFile.empty())
+        {
+            emulator.runFrame();
+        }
+        else
+        {
+            emulator.runFrame(movie.getFrame(frame));
+        }
+    }
+    
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+    
+    if(!profileFile.empty())
+    {
+        std::ofstream profileStream(profileFile);
+        profile.save(profileStream);
+    }
+    
+    if(!saveStateFile.empty())
+    {
+        Snapshot state;
+        emulator.snapshot(state);
+        
+        std::ofstream stateStream(saveStateFile, std::ios::binary);
+        state.write(stateStream);
+    }
+    
+    //Nothing presses any keys here, so the movie is every frame's inputs left as they are at power on
+    if(!recordFile.empty())
+    {
+        InputMovie recording;
+        recording.setROMHash(emulator.getROMHash());
+        
+        for(uint64_t frame = 0; frame < frameCount; ++frame)
+        {
+            recording.addFrame(SpaceInvaders::Inputs());
+        }
+        
+        recording.setRAMHash(emulator.getRAMHash());
+        
+        std::ofstream movieStream(recordFile, std::ios::binary);
+        recording.write(movieStream);
+    }
+    
+    //Hash the screen so runs can be compared, they should always match for the same number of frames
+    uint64_t screenHash = 0xCBF29CE484222325;
+    
+    for(int byte = 0; byte < SpaceInvaders::videoMemoryEnd - SpaceInvaders::videoMemoryStart; ++byte)
+    {
+        screenHash = (screenHash ^ emulator.getVideoMemory()[byte]) * 0x100000001B3;
+    }
+    
+    std::cout << "Frames: " << frameCount << std::endl
+              << "Cycles: " << emulator.getCycleCount() << std::endl
+              << "Screen hash: " << std::hex << screenHash << std::dec << std::endl;
+    
+    const bool replayMatched = replayFile.empty() || emulator.getRAMHash() == movie.getRAMHash();
+    
+    if(!replayFile.empty())
+    {
+        std::cout << (replayMatched ? "Replay matches the recording" : "Replay doesn't match the recording") << std::endl;
+    }
+    
+    if(benchmark)
+    {
+        const double seconds = elapsed.count();
+        
+        std::cout << "Time: " << seconds << "s" << std::endl
+                  << "Frames per second: " << frameCount / seconds << std::endl
+                  << "Speed: " << (frameCount * SpaceInvaders::frameTimeMS / 1000.0) / seconds << "x real time" << std::endl
+                  << "MIPS: " << emulator.getInstructionCount() / seconds / 1000000.0 << std::endl;
+    }
+    
+    return replayMatched ? EXIT_SUCCESS : EXIT_FAILURE;
+}
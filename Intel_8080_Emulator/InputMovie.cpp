@@ -0,0 +1,148 @@
+//
+//  InputMovie.cpp
+//  Intel_8080_Emulator
+//
+
+#include "InputMovie.hpp"
+
+#include <algorithm>
+#include <array>
+#include <iterator>
+
+namespace
+{
+    constexpr std::array<char, 8> movieMagic{'8', '0', '8', '0', 'M', 'O', 'V', 'I'};
+    
+    //Over 300 hours of frames, so a damaged count can't ask for gigabytes
+    constexpr uint64_t maxFrames = uint64_t(1) << 26;
+}
+
+void InputMovie::addFrame(const SpaceInvaders::Inputs& inputs)
+{
+    frames.push_back(inputs);
+}
+
+const SpaceInvaders::Inputs& InputMovie::getFrame(uint64_t frame) const
+{
+    return frames[frame];
+}
+
+uint64_t InputMovie::getFrameCount() const
+{
+    return frames.size();
+}
+
+void InputMovie::truncate(uint64_t frameCount)
+{
+    frames.resize(std::min<uint64_t>(frameCount, frames.size()));
+}
+
+void InputMovie::setROMHash(uint64_t hash)
+{
+    romHash = hash;
+}
+
+uint64_t InputMovie::getROMHash() const
+{
+    return romHash;
+}
+
+void InputMovie::setRAMHash(uint64_t hash)
+{
+    ramHash = hash;
+}
+
+uint64_t InputMovie::getRAMHash() const
+{
+    return ramHash;
+}
+
+//Layout, each value little endian
+//    8 bytes   magic "8080MOVI"
+//    4 bytes   format version
+//    8 bytes   ROM hash
+//    8 bytes   RAM hash at the end
+//    8 bytes   number of frames
+//    then runs of frames with the same inputs until they are all covered, 4 bytes for the length then 1 byte each for ports 1 and 2
+void InputMovie::write(std::ostream& output) const
+{
+    std::vector<uint8_t> data(movieMagic.begin(), movieMagic.end());
+    
+    Snapshot::appendValue(data, formatVersion, 4);
+    Snapshot::appendValue(data, romHash, 8);
+    Snapshot::appendValue(data, ramHash, 8);
+    Snapshot::appendValue(data, frames.size(), 8);
+    
+    for(auto run = frames.begin(); run != frames.end();)
+    {
+        //Capped so the length always fits
+        const auto runEnd = std::find_if(run, run + std::min<ptrdiff_t>(frames.end() - run, UINT32_MAX), [&run](const SpaceInvaders::Inputs& inputs)
+        {
+            return inputs != *run;
+        });
+        
+        Snapshot::appendValue(data, runEnd - run, 4);
+        Snapshot::appendValue(data, run->port1, 1);
+        Snapshot::appendValue(data, run->port2, 1);
+        
+        run = runEnd;
+    }
+    
+    output.write(reinterpret_cast<const char*>(data.data()), data.size());
+}
+
+bool InputMovie::read(std::istream& input)
+{
+    const std::vector<uint8_t> fileData(std::istreambuf_iterator<char>(input), {});
+    std::span<const uint8_t> data(fileData);
+    
+    constexpr size_t headerBytes = movieMagic.size() + 4 + 8 + 8 + 8;
+    
+    if(data.size() < headerBytes || !std::equal(movieMagic.begin(), movieMagic.end(), data.begin()))
+    {
+        return false;
+    }
+    
+    data = data.subspan(movieMagic.size());
+    
+    const uint64_t version = Snapshot::takeValue(data, 4);
+    const uint64_t loadedROMHash = Snapshot::takeValue(data, 8);
+    const uint64_t loadedRAMHash = Snapshot::takeValue(data, 8);
+    const uint64_t frameCount = Snapshot::takeValue(data, 8);
+    
+    if(version != formatVersion || frameCount > maxFrames)
+    {
+        return false;
+    }
+    
+    //Filled in separately so a file cut short leaves this one alone
+    std::vector<SpaceInvaders::Inputs> loadedFrames;
+    loadedFrames.reserve(frameCount);
+    
+    while(loadedFrames.size() < frameCount)
+    {
+        if(data.size() < 6)
+        {
+            return false;
+        }
+        
+        const uint64_t runLength = Snapshot::takeValue(data, 4);
+        
+        SpaceInvaders::Inputs inputs;
+        inputs.port1 = Snapshot::takeValue(data, 1);
+        inputs.port2 = Snapshot::takeValue(data, 1);
+        
+        if(runLength == 0 || runLength > frameCount - loadedFrames.size())
+        {
+            return false;
+        }
+        
+        loadedFrames.insert(loadedFrames.end(), runLength, inputs);
+    }
+    
+    frames = std::move(loadedFrames);
+    romHash = loadedROMHash;
+    ramHash = loadedRAMHash;
+    
+    return true;
+}
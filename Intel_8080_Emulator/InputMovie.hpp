@@ -0,0 +1,48 @@
+//
+//  InputMovie.hpp
+//  Intel_8080_Emulator
+//
+
+#pragma once
+
+#include "SpaceInvaders.hpp"
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <vector>
+
+//The inputs a game was played with, a frame at a time from power on, so the run can be played back exactly without a window
+//Also keeps hashes of the ROM it was played on and of the RAM at the end, so a playback can tell whether it ended up the same
+class InputMovie
+{
+public:
+    //Bumped whenever the file layout changes, files from any other version are refused
+    static constexpr uint32_t formatVersion = 1;
+    
+    void addFrame(const SpaceInvaders::Inputs& inputs);
+    const SpaceInvaders::Inputs& getFrame(uint64_t frame) const;
+    uint64_t getFrameCount() const;
+    
+    //Drops every frame from the given one on, for carrying on from an earlier point
+    void truncate(uint64_t frameCount);
+    
+    void setROMHash(uint64_t hash);
+    uint64_t getROMHash() const;
+    
+    //What getRAMHash gave at the end of the last frame
+    void setRAMHash(uint64_t hash);
+    uint64_t getRAMHash() const;
+    
+    //Little endian, with frames run length encoded since inputs only change every so often
+    void write(std::ostream& output) const;
+    
+    //Returns false if it isn't a movie file of this version, leaving the movie as it was
+    bool read(std::istream& input);
+
+private:
+    std::vector<SpaceInvaders::Inputs> frames;
+    
+    uint64_t romHash = 0;
+    uint64_t ramHash = 0;
+};
@@ -0,0 +1,36 @@
+//
+//  Instrumentation.cpp
+//  Intel_8080_Emulator
+//
+
+#include "Instrumentation.hpp"
+
+#include <numeric>
+
+uint64_t CountingInstrumentation::getCount(uint8_t opcode) const
+{
+    return opcodeCounts[opcode];
+}
+
+uint64_t CountingInstrumentation::getTotal() const
+{
+    return std::accumulate(opcodeCounts.begin(), opcodeCounts.end(), uint64_t(0));
+}
+
+void FullTraceInstrumentation::setOutput(std::ostream* output)
+{
+    writer.reset();
+    
+    if(output != nullptr)
+    {
+        writer = std::make_unique<TraceWriter>(*output);
+    }
+}
+
+void FullTraceInstrumentation::flush()
+{
+    if(writer)
+    {
+        writer->flush();
+    }
+}
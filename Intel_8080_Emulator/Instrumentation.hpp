@@ -0,0 +1,145 @@
+//
+//  Instrumentation.hpp
+//  Intel_8080_Emulator
+//
+
+#pragma once
+
+#include "TraceFile.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <vector>
+
+//Policies for what Intel_8080_Machine records, picked as its second template parameter
+//Each one has a static constexpr bool enabled, and when it is, an onInstruction called before every instruction
+//Policies with recordsState set get a whole TraceRecord, the others just the opcode, so they don't pay for reading the registers and flags
+//Anything enabled runs in the interpreter only, translated code and fused handlers run instructions without being seen
+
+//Nothing recorded, and nothing added to the interpreter
+struct NoInstrumentation
+{
+    static constexpr bool enabled = false;
+    static constexpr bool recordsState = false;
+};
+
+//Number of times each opcode has run
+class CountingInstrumentation
+{
+public:
+    static constexpr bool enabled = true;
+    static constexpr bool recordsState = false;
+    
+    void onInstruction(uint8_t opcode);
+    
+    uint64_t getCount(uint8_t opcode) const;
+    uint64_t getTotal() const;
+
+private:
+    std::array<uint64_t, 256> opcodeCounts{};
+};
+
+inline void CountingInstrumentation::onInstruction(uint8_t opcode)
+{
+    ++opcodeCounts[opcode];
+}
+
+//Keeps the last capacity instructions, the oldest is overwritten first
+template<size_t capacity = 65536>
+class TraceRingInstrumentation
+{
+public:
+    static_assert(capacity > 0 && (capacity & (capacity - 1)) == 0, "Capacity has to be a power of two");
+    
+    static constexpr bool enabled = true;
+    static constexpr bool recordsState = true;
+    
+    TraceRingInstrumentation();
+    
+    void onInstruction(const TraceRecord& record);
+    
+    //The records still held, oldest first
+    std::vector<TraceRecord> getRecords() const;
+    
+    //Writes the records still held to a trace file, oldest first
+    void dump(std::ostream& output) const;
+    
+    //Every instruction seen, including the ones since overwritten
+    uint64_t getRecordCount() const;
+
+private:
+    std::vector<TraceRecord> records;
+    uint64_t recordCount = 0;
+};
+
+//Every instruction written out to a trace file as it runs
+//The stream has to outlive the instrumentation, which writes whatever it still has buffered when destroyed
+class FullTraceInstrumentation
+{
+public:
+    static constexpr bool enabled = true;
+    static constexpr bool recordsState = true;
+    
+    //Starts a new trace file in the stream, pass nullptr to stop
+    void setOutput(std::ostream* output);
+    
+    void onInstruction(const TraceRecord& record);
+    
+    void flush();
+    
+private:
+    std::unique_ptr<TraceWriter> writer;
+};
+
+inline void FullTraceInstrumentation::onInstruction(const TraceRecord& record)
+{
+    if(writer)
+    {
+        writer->write(record);
+    }
+}
+
+template<size_t capacity>
+TraceRingInstrumentation<capacity>::TraceRingInstrumentation()  : records(capacity)
+{
+    
+}
+
+template<size_t capacity>
+void TraceRingInstrumentation<capacity>::onInstruction(const TraceRecord& record)
+{
+    records[recordCount++ & (capacity - 1)] = record;
+}
+
+template<size_t capacity>
+std::vector<TraceRecord> TraceRingInstrumentation<capacity>::getRecords() const
+{
+    std::vector<TraceRecord> ordered;
+    
+    for(uint64_t index = recordCount > capacity ? recordCount - capacity : 0; index < recordCount; ++index)
+    {
+        ordered.push_back(records[index & (capacity - 1)]);
+    }
+    
+    return ordered;
+}
+
+template<size_t capacity>
+void TraceRingInstrumentation<capacity>::dump(std::ostream& output) const
+{
+    TraceWriter writer(output);
+    
+    for(uint64_t index = recordCount > capacity ? recordCount - capacity : 0; index < recordCount; ++index)
+    {
+        writer.write(records[index & (capacity - 1)]);
+    }
+}
+
+template<size_t capacity>
+uint64_t TraceRingInstrumentation<capacity>::getRecordCount() const
+{
+    return recordCount;
+}
@@ -6,12 +6,16 @@
 //
 
 #include "Intel_8080_Emulator.hpp"
+#include "OpcodeInfo.hpp"
+#include "RecompiledProgram.hpp"
 
-#include <iostream>
+#include <algorithm>
+#include <cassert>
 
-Intel_8080_Emulator::Intel_8080_Emulator()
+Intel_8080_Emulator::Intel_8080_Emulator(const std::array<OpHandler, 256>& machineTable, bool instrumentedTable)  : decodedInstructions(65536), machineOpTable(&machineTable), instrumented(instrumentedTable)
 {
     programCounter = 0x0;
+    activeOpTable = machineOpTable;
 }
 
 Intel_8080_Emulator::~Intel_8080_Emulator()
@@ -27,30 +31,9 @@ void Intel_8080_Emulator::runCycle()
         
         fetch();
         
-        if(debugMode)
-        {
-            std::cout << "------------------" << std::endl << "Opcode: " << std::bitset<8>(currentOpcode) << std::endl
-                      << "Op Name: " << getCurrentOpName() << std::endl
-                      << "Op Number: " << opCounter << std::endl
-                      << "Current Data Bytes: " << getAddressInDataBytes() << std::endl
-                      << "Current Condition: " << getCurrentConditionName() << std::endl
-                      << "Current Flag Values: " << getFlagValuesStr() << std::endl
-                      << "Current Reg Values: " << getCurrentRegValuesStr() << std::endl
-                      << "Current Stack Pointer Val: " << registers.getValueFromRegisterPair(RegisterManager::RegisterPair::SP) << std::endl;
-        }
-        
-        decodeAndExecute(currentOpcode);
-        
-        const auto startGraphicsIt = memory.cbegin() + 0x2400;
-        const auto endGraphicsIt = memory.cbegin() + 0x3FFF + 1;
+        cycleCount += opCycles[currentOpcode];
         
-        if(std::any_of(startGraphicsIt, endGraphicsIt, [](const uint8_t memVal)
-        {
-            return memVal != 0x0;
-        }))
-        {
-            std::cout << "Graphics" << std::endl;
-        }
+        (this->*currentInstruction->handler)(currentOpcode);
     }
 }
 
@@ -58,1093 +41,1901 @@ void Intel_8080_Emulator::performInterrupt(uint8_t opcode)
 {
     if(interrupts)
     {
-        decodeAndExecute(opcode);
+        //Accepting an interrupt disables any more until they are enabled again, and wakes a halted CPU
+        interrupts = false;
+        haltFlag = false;
+        
+        cycleCount += interruptCycles;
+        
+        //Only RST instructions are supported, the interrupted instruction hasn't run yet so it is what gets returned to
+        assert((opcode & 0xC7) == 0xC7);
+        pushToStack(programCounter);
+        programCounter = opcode & 0x38;
     }
 }
 
-void Intel_8080_Emulator::fetch()
-{
-    currentOpcode = memory[programCounter];
-}
-
-void Intel_8080_Emulator::decodeAndExecute(uint8_t opcode)
+uint64_t Intel_8080_Emulator::runFor(uint64_t cycles)
 {
-    //Check first two bits
-    switch(opcode & 0xc0)
+    const uint64_t startCycle = cycleCount;
+    const uint64_t endCycle = startCycle + cycles;
+    
+    while(cycleCount < endCycle)
     {
-        //00
-        case 0x00:
-            
-            switch(opcode & 0xFF)
-            {
-                //00110110 - Move to memory immediate
-                case 0x36:
-                {
-                    uint16_t destMemLocation = registers.getValueFromRegisterPair(RegisterManager::RegisterPair::HL);
-                    uint8_t dataByte = memory[programCounter + 1];
-                    
-                    memory[destMemLocation] = dataByte;
-                    
-                    programCounter += 2;
-                    return;
-                }
-                    
-                //00111010 - Load Accumulator Direct
-                case 0x3A:
-                {
-                    uint8_t data = memory[getAddressInDataBytes()];
-                    registers.setRegisterValue(RegisterManager::Register::A, data);
-                    
-                    programCounter += 3;
-                    return;
-                }
-                    
-                //00110010 - Store Accumulator Direct
-                case 0x32:
-                {
-                    uint8_t data = registers.getRegisterValue(RegisterManager::Register::A);
-                    memory[getAddressInDataBytes()] = data;
-                    
-                    programCounter += 3;
-                    return;
-                }
-                    
-                //00101010 - Load H and L direct
-                case 0x2A:
-                {
-                    uint16_t sourceMemoryAddress = getAddressInDataBytes();
-                    
-                    registers.setRegisterValue(RegisterManager::Register::L, memory[sourceMemoryAddress]);
-                    registers.setRegisterValue(RegisterManager::Register::H, memory[sourceMemoryAddress + 1]);
-                    
-                    programCounter += 3;
-                    return;
-                }
-                    
-                //00100010 - Store H and L direct
-                case 0x22:
-                {
-                    uint16_t destMemoryAddress = getAddressInDataBytes();
-                    
-                    memory[destMemoryAddress] = registers.getRegisterValue(RegisterManager::Register::L);
-                    memory[destMemoryAddress + 1] = registers.getRegisterValue(RegisterManager::Register::H);
-                    
-                    programCounter += 3;
-                    return;
-                }
-                    
-                //00110100 - Increment Memory
-                case 0x34:
-                {
-                    uint16_t address = registers.getValueFromRegisterPair(RegisterManager::RegisterPair::HL);
-                    
-                    uint8_t result = alu.operateAndSetFlags(memory[address], uint8_t(1), ALU::Operation::Addition, ALU::Flag::Carry, false);
-                    
-                    memory[address] = result;
-                    
-                    ++programCounter;
-                    return;
-                }
-                    
-                //00110101 - Decrement Memory
-                case 0x35:
-                {
-                    uint16_t address = registers.getValueFromRegisterPair(RegisterManager::RegisterPair::HL);
-                    
-                    uint8_t result = alu.operateAndSetFlags(memory[address], uint8_t(1), ALU::Operation::Subtraction, ALU::Flag::Carry, false);
-                    
-                    memory[address] = result;
-                    
-                    ++programCounter;
-                    return;
-                }
-                    
-                //00100111 - Decimal Adjust Accumulator
-                case 0x27:
-                {
-                    uint8_t accumulatorVal = registers.getRegisterValue(RegisterManager::Register::A);
-                    
-                    //If the value of the least significant 4 bits of the accumulator is greater than 9 or if the AC flag is set, 6 is added to the accumulator.
-                    if(((accumulatorVal & 0xF) > 0x9) || alu.getFlag(ALU::Flag::AuxillaryCarry))
-                    {
-                        accumulatorVal += 0x6;
-                    }
-                    
-                    //If the value of the most significant 4 bits of the accumulator is now greater than 9, or if the CY flag is set, 6 is added to the most significant 4 bits of the accumulator.
-                    if(((accumulatorVal & 0xF0) > 0x90) || (((accumulatorVal & 0xF0) >= 0x90) && ((accumulatorVal & 0xF) > 9)) || alu.getFlag(ALU::Flag::Carry))
-                    {
-                        accumulatorVal = alu.operateAndSetFlags(accumulatorVal, uint8_t(0x60));
-                    }
-                    
-                    registers.setRegisterValue(RegisterManager::Register::A, accumulatorVal);
-                    ++programCounter;
-                    return;
-                }
-                    
-                //00000111 - Rotate Left
-                case 0x7:
-                {
-                    ALU::Flag flagsToIgnore = ALU::Flag::Zero | ALU::Flag::Sign | ALU::Flag::Parity | ALU::Flag::AuxillaryCarry;
-                    
-                    uint8_t result = alu.operateAndSetFlags(registers.getRegisterValue(RegisterManager::Register::A), uint8_t(0), ALU::Operation::RotateLeft, flagsToIgnore);
-                    
-                    registers.setRegisterValue(RegisterManager::Register::A, result);
-                    
-                    ++programCounter;
-                    return;
-                }
-                    
-                //00001111 - Rotate Right
-                case 0xF:
-                {
-                    ALU::Flag flagsToIgnore = ALU::Flag::Zero | ALU::Flag::Sign | ALU::Flag::Parity | ALU::Flag::AuxillaryCarry;
-                    
-                    uint8_t result = alu.operateAndSetFlags(registers.getRegisterValue(RegisterManager::Register::A), uint8_t(0), ALU::Operation::RotateRight, flagsToIgnore);
-                    
-                    registers.setRegisterValue(RegisterManager::Register::A, result);
-                    
-                    ++programCounter;
-                    return;
-                }
-                    
-                //00010111 - Rotate Left Through Carry
-                case 0x17:
-                {
-                    ALU::Flag flagsToIgnore = ALU::Flag::Zero | ALU::Flag::Sign | ALU::Flag::Parity | ALU::Flag::AuxillaryCarry;
-                    
-                    uint8_t result = alu.operateAndSetFlags(registers.getRegisterValue(RegisterManager::Register::A), uint8_t(0), ALU::Operation::RotateLeft, flagsToIgnore, true);
-                    
-                    registers.setRegisterValue(RegisterManager::Register::A, result);
-                    
-                    ++programCounter;
-                    return;
-                }
-                    
-                //00011111 - Rotate Right Through Carry
-                case 0x1F:
-                {
-                    ALU::Flag flagsToIgnore = ALU::Flag::Zero | ALU::Flag::Sign | ALU::Flag::Parity | ALU::Flag::AuxillaryCarry;
-                    
-                    uint8_t result = alu.operateAndSetFlags(registers.getRegisterValue(RegisterManager::Register::A), uint8_t(0), ALU::Operation::RotateRight, flagsToIgnore, true);
-                    
-                    registers.setRegisterValue(RegisterManager::Register::A, result);
-                    
-                    ++programCounter;
-                    return;
-                }
-                    
-                //00101111 - Complement Accumulator
-                case 0x2F:
-                {
-                    registers.setRegisterValue(RegisterManager::Register::A, ~registers.getRegisterValue(RegisterManager::Register::A));
-                    ++programCounter;
-                    return;
-                }
-                 
-                //00111111 - Complement Carry
-                case 0x3F:
-                {
-                    alu.setFlag(ALU::Flag::Carry, !alu.getFlag(ALU::Flag::Carry));
-                    ++programCounter;
-                    return;
-                }
-                    
-                //00110111 - Set Carry
-                case 0x37:
-                {
-                    alu.setFlag(ALU::Flag::Carry, true);
-                    ++programCounter;
-                    return;
-                }
-                    
-                //00000000 - No Op
-                case 0x0:
-                {
-                    ++programCounter;
-                    return;
-                }
-                    
-                default:
-                    break;
-            }
-            
-            //Look at last 4 bits
-            switch(opcode & 0xCF)
-            {
-                //00RP0001 - Load Register Pair Immediate
-                case 0x1:
-                {
-                    RegisterManager::RegisterPair destPair = getRegisterPair(opcode);
-                    uint8_t lowOrderByte = memory[programCounter + 1];
-                    uint8_t highOrderByte = memory[programCounter + 2];
-                    
-                    registers.setRegisterPair(destPair, highOrderByte, lowOrderByte);
-                    
-                    programCounter += 3;
-                    return;
-                }
-                
-                //00RP1010 - Load accumulator indirect
-                case 0xA:
-                {
-                    RegisterManager::RegisterPair pair = getRegisterPair(opcode);
-                
-                    if(pair != RegisterManager::RegisterPair::BC && pair != RegisterManager::RegisterPair::DE)
-                    {
-                        assert(false);
-                        return;
-                    }
-                    
-                    uint8_t data = memory[registers.getValueFromRegisterPair(pair)];
-                    
-                    registers.setRegisterValue(RegisterManager::Register::A, data);
-                    
-                    ++programCounter;
-                    return;
-                }
-                
-                //00RP0010 - Store accumulator indirect
-                case 0x2:
-                {
-                    RegisterManager::RegisterPair pair = getRegisterPair(opcode);
-                    
-                    if(pair != RegisterManager::RegisterPair::BC && pair != RegisterManager::RegisterPair::DE)
-                    {
-                        assert(false);
-                        return;
-                    }
-                    
-                    uint16_t destAddress = registers.getValueFromRegisterPair(pair);
-                    
-                    memory[destAddress] = registers.getRegisterValue(RegisterManager::Register::A);
-                    
-                    ++programCounter;
-                    return;
-                }
-                    
-                //00RP0011 - Increment Register Pair
-                case 0x3:
-                {
-                    registers.setRegisterPair(getRegisterPair(opcode), registers.getValueFromRegisterPair(getRegisterPair(opcode)) + 1);
-                    
-                    ++programCounter;
-                    return;
-                }
-                    
-                //00RP1011 - Decrement Register Pair
-                case 0xB:
-                {
-                    registers.setRegisterPair(getRegisterPair(opcode), registers.getValueFromRegisterPair(getRegisterPair(opcode)) - 1);
-                    
-                    ++programCounter;
-                    return;
-                }
-                    
-                //00RP1001 - Add Register Pair to H and L
-                case 0x9:
-                {
-                    ALU::Flag flagsToExclude = ALU::Flag::Zero | ALU::Flag::Sign | ALU::Flag::Parity | ALU::Flag::AuxillaryCarry;
-                    
-                    uint16_t result = alu.operateAndSetFlags(registers.getValueFromRegisterPair(RegisterManager::RegisterPair::HL), registers.getValueFromRegisterPair(getRegisterPair(opcode)), ALU::Operation::Addition, flagsToExclude);
-                    
-                    registers.setRegisterPair(RegisterManager::RegisterPair::HL, result);
-                    
-                    ++programCounter;
-                    return;
-                }
-            }
-            
-            //Look at the last 3 bits
-            switch(opcode & 0xC7)
-            {
-                //00DDD110 - Move Immediate
-                case 0x6:
-                {
-                    RegisterManager::Register destReg = getFirstRegister(opcode);
-                    uint8_t dataByte = memory[programCounter + 1];
-                    
-                    registers.setRegisterValue(destReg, dataByte);
-                        
-                    programCounter += 2;
-                    return;
-                }
-                    
-                //00DDD100 - Increment Register
-                case 0x4:
-                {
-                    uint8_t result = alu.operateAndSetFlags(registers.getRegisterValue(getFirstRegister(opcode)), uint8_t(1), ALU::Operation::Addition, ALU::Flag::Carry, false);
-                    
-                    registers.setRegisterValue(getFirstRegister(opcode), result);
-                    
-                    ++programCounter;
-                    return;
-                }
-                
-                //00DDD101 - Decrement Register
-                case 0x5:
-                {
-                    uint8_t result = alu.operateAndSetFlags(registers.getRegisterValue(getFirstRegister(opcode)), uint8_t(1), ALU::Operation::Subtraction, ALU::Flag::Carry, false);
-                    
-                    registers.setRegisterValue(getFirstRegister(opcode), result);
-                    
-                    ++programCounter;
-                    return;
-                }
-            }
-            
-            break;
-            
-        //01
-        case 0x40:
-            
-            //01110110 - Halt
-            if((opcode & 0xFF) == 0x76)
+        //Run up to whichever comes first, the end of the batch or the next event
+        const uint64_t stopCycle = scheduledEvents.empty() ? endCycle : std::min(endCycle, scheduledEvents.back().cycle);
+        currentStopCycle = stopCycle;
+        
+        while(cycleCount < stopCycle)
+        {
+            //A halted CPU just idles until something happens
+            if(haltFlag)
             {
-                haltFlag = true;
+                cycleCount = stopCycle;
+                break;
             }
             
-            //01DDD110 - Move from memory
-            if((opcode & 0x7) == 0x6)
+            if(recompiler)
             {
-                uint16_t sourceMemoryLocation = registers.getValueFromRegisterPair(RegisterManager::RegisterPair::HL);
-                
-                RegisterManager::Register destReg = getFirstRegister(opcode);
-                
-                registers.setRegisterValue(destReg, memory[sourceMemoryLocation]);
-                
-                ++programCounter;
-                return;
+                recompiler->execute(stopCycle);
             }
-            
-            //01110SSS - Move to memory
-            else if((opcode & 0xF8) == 0x70)
+            else if(recompiledProgram != nullptr)
             {
-                uint16_t destMemoryLocation = registers.getValueFromRegisterPair(RegisterManager::RegisterPair::HL);
-                
-                RegisterManager::Register sourceReg = getSecondRegister(opcode);
-                
-                memory[destMemoryLocation] = registers.getRegisterValue(sourceReg);
-                
-                ++programCounter;
-                return;
+                recompiledProgram->execute(*this, stopCycle);
             }
-            
-            //01DDDSSS - Move register
             else
             {
-                RegisterManager::Register firstReg = getFirstRegister(opcode);
-                RegisterManager::Register secondReg = getSecondRegister(opcode);
-                
-                registers.setRegisterValue(firstReg, registers.getRegisterValue(secondReg));
-                
-                ++programCounter;
-                return;
+                runCycle();
             }
-            
-            break;
+        }
+        
+        runDueEvents();
+    }
     
-        //10
-        case 0x80:
-            
-            switch (opcode & 0xFF)
-            {
-                //10000110 - Add Memory
-                case 0x86:
-                {
-                    uint16_t location = registers.getValueFromRegisterPair(RegisterManager::RegisterPair::HL);
-                    
-                    uint8_t result = alu.operateAndSetFlags(registers.getRegisterValue(RegisterManager::Register::A), memory[location]);
-                    
-                    registers.setRegisterValue(RegisterManager::Register::A, result);
-                    
-                    ++programCounter;
-                    return;
-                }
-                    
-                //10001110 - Add memory with carry
-                case 0x8E:
-                {
-                    uint16_t location = registers.getValueFromRegisterPair(RegisterManager::RegisterPair::HL);
-                    
-                    uint8_t result = alu.operateAndSetFlags(registers.getRegisterValue(RegisterManager::Register::A), memory[location], ALU::Operation::Addition, ALU::Flag::None, true);
-                    
-                    registers.setRegisterValue(RegisterManager::Register::A, result);
-                    
-                    ++programCounter;
-                    return;
-                }
-                    
-                //10010110 - Subtract Memory
-                case 0x96:
+    currentStopCycle = 0;
+    
+    return cycleCount - startCycle;
+}
+
+bool Intel_8080_Emulator::step()
+{
+    if(haltFlag)
+    {
+        //Only an event can wake it
+        if(scheduledEvents.empty())
+        {
+            return false;
+        }
+        
+        cycleCount = std::max(cycleCount, scheduledEvents.back().cycle);
+    }
+    else
+    {
+        runCycle();
+    }
+    
+    runDueEvents();
+    
+    return true;
+}
+
+void Intel_8080_Emulator::scheduleEvent(uint64_t cycle, uint8_t eventId)
+{
+    //Goes in front of any events due on the same cycle, so those run first
+    const auto position = std::lower_bound(scheduledEvents.begin(), scheduledEvents.end(), cycle, [](const ScheduledEvent& event, uint64_t newCycle)
+    {
+        return event.cycle > newCycle;
+    });
+    
+    scheduledEvents.insert(position, {cycle, eventId});
+}
+
+void Intel_8080_Emulator::handleEvent(uint8_t, uint64_t)
+{
+    
+}
+
+void Intel_8080_Emulator::saveMachineState(std::vector<uint8_t>&) const
+{
+    
+}
+
+void Intel_8080_Emulator::restoreMachineState(std::span<const uint8_t>)
+{
+    
+}
+
+void Intel_8080_Emulator::runDueEvents()
+{
+    while(!scheduledEvents.empty() && scheduledEvents.back().cycle <= cycleCount)
+    {
+        const ScheduledEvent event = scheduledEvents.back();
+        scheduledEvents.pop_back();
+        
+        //The handler is free to schedule more events, including ones that are already due
+        handleEvent(event.eventId, event.cycle);
+    }
+}
+
+uint64_t Intel_8080_Emulator::getCycleCount() const
+{
+    return cycleCount;
+}
+
+uint64_t Intel_8080_Emulator::getInstructionCount() const
+{
+    return opCounter;
+}
+
+bool Intel_8080_Emulator::setRecompilerEnabled(bool enabled)
+{
+    //Translated code doesn't go through the instrumented table
+    if(!enabled || instrumented || !DynamicRecompiler::isSupported())
+    {
+        recompiler.reset();
+        return false;
+    }
+    
+    if(!recompiler)
+    {
+        recompiler = std::make_unique<DynamicRecompiler>(*this);
+    }
+    
+    return true;
+}
+
+bool Intel_8080_Emulator::setRecompiledProgram(const RecompiledProgram* program)
+{
+    if(program != nullptr && (instrumented || !program->matches(memoryBus)))
+    {
+        recompiledProgram = nullptr;
+        return false;
+    }
+    
+    recompiledProgram = program;
+    markProgramPages();
+    
+    return true;
+}
+
+void Intel_8080_Emulator::setProfile(OpcodeProfile* newProfile)
+{
+    profile = newProfile;
+    updateActiveOpTable();
+}
+
+bool Intel_8080_Emulator::setSwitchDispatch(bool enabled)
+{
+    //Would skip the instrumentation's handlers
+    if(enabled && instrumented)
+    {
+        return false;
+    }
+    
+    switchDispatch = enabled;
+    updateActiveOpTable();
+    
+    return true;
+}
+
+int Intel_8080_Emulator::setFusions(const OpcodeProfile* fusionProfile, double minimumShare)
+{
+    fusedOpTable.reset();
+    
+    //Fused handlers run the instructions after the first without going through the table
+    if(fusionProfile == nullptr || instrumented || fusionProfile->getTotal() == 0)
+    {
+        updateActiveOpTable();
+        return 0;
+    }
+    
+    auto table = std::make_unique<std::array<OpHandler, 256>>(*machineOpTable);
+    int fusionCount = 0;
+    
+    for(const FusionPattern& pattern : fusionPatterns)
+    {
+        uint64_t count = 0;
+        
+        for(int head = 0; head < 256; ++head)
+        {
+            for(int next = 0; next < 256; ++next)
+            {
+                if((*machineOpTable)[head] == pattern.headHandler && (*machineOpTable)[next] == pattern.nextHandler && (next & pattern.nextMask) == pattern.nextValue)
                 {
-                    uint16_t location = registers.getValueFromRegisterPair(RegisterManager::RegisterPair::HL);
-                    
-                    uint8_t result = alu.operateAndSetFlags(registers.getRegisterValue(RegisterManager::Register::A), memory[location], ALU::Operation::Subtraction);
-                    
-                    registers.setRegisterValue(RegisterManager::Register::A, result);
-                    
-                    ++programCounter;
-                    return;
+                    count += fusionProfile->getCount(head, next);
                 }
+            }
+        }
+        
+        if(double(count) / fusionProfile->getTotal() < minimumShare)
+        {
+            continue;
+        }
+        
+        for(int head = 0; head < 256; ++head)
+        {
+            if((*machineOpTable)[head] == pattern.headHandler)
+            {
+                (*table)[head] = pattern.fusedHandler;
+            }
+        }
+        
+        ++fusionCount;
+    }
+    
+    if(fusionCount > 0)
+    {
+        fusedOpTable = std::move(table);
+    }
+    
+    updateActiveOpTable();
+    
+    return fusionCount;
+}
+
+void Intel_8080_Emulator::updateActiveOpTable()
+{
+    if(profile != nullptr)
+    {
+        activeOpTable = &profilingOpTable;
+    }
+    else if(switchDispatch)
+    {
+        activeOpTable = &switchOpTable;
+    }
+    else if(fusedOpTable)
+    {
+        activeOpTable = fusedOpTable.get();
+    }
+    else
+    {
+        activeOpTable = machineOpTable;
+    }
+    
+    //Decoded instructions keep the handler they were decoded with
+    for(DecodedInstruction& instruction : decodedInstructions)
+    {
+        instruction.valid = false;
+    }
+}
+
+void Intel_8080_Emulator::invalidateCode(uint16_t address)
+{
+    //Code could have been run from any of the addresses the byte is mapped to
+    memoryBus.forEachAlias(address, [this](uint16_t aliasAddress)
+    {
+        invalidateAddress(aliasAddress);
+    });
+}
+
+void Intel_8080_Emulator::invalidateAddress(uint16_t address)
+{
+    //Decoded instructions that include the written byte start up to two bytes before it, wrapping round from the bottom of memory
+    for(uint16_t offset = 0; offset < 3; ++offset)
+    {
+        decodedInstructions[uint16_t(address - offset)].valid = false;
+    }
+    
+    if(recompiler && recompiler->invalidatePage(address >> 8))
+    {
+        codeModified = true;
+    }
+    
+    //Blocks translated ahead of time can't be regenerated, so any write to the ROM they came from drops back to the interpreter
+    if(recompiledProgram != nullptr && address >= recompiledProgram->getROMStart() && address < recompiledProgram->getROMEnd())
+    {
+        recompiledProgram = nullptr;
+        codeModified = true;
+    }
+}
+
+void Intel_8080_Emulator::invalidatePage(uint8_t page)
+{
+    //Decoded instructions from the two bytes before the page can run on into it
+    for(int offset = -2; offset < MemoryBus::pageSize; ++offset)
+    {
+        decodedInstructions[uint16_t((page << 8) + offset)].valid = false;
+    }
+    
+    if(recompiler && recompiler->invalidatePage(page))
+    {
+        codeModified = true;
+    }
+    
+    if(recompiledProgram != nullptr && (page << 8) < recompiledProgram->getROMEnd() && (page << 8) + MemoryBus::pageSize > recompiledProgram->getROMStart())
+    {
+        recompiledProgram = nullptr;
+        codeModified = true;
+    }
+}
+
+void Intel_8080_Emulator::markProgramPages()
+{
+    if(recompiledProgram == nullptr)
+    {
+        return;
+    }
+    
+    for(int page = recompiledProgram->getROMStart() >> 8; page <= (recompiledProgram->getROMEnd() - 1) >> 8; ++page)
+    {
+        memoryBus.watchPage(page);
+    }
+}
+
+bool Intel_8080_Emulator::watchWrites(uint16_t address)
+{
+    watchedStorageAddress = memoryBus.getStorageAddress(address);
+    watchedAddressWritten = false;
+    
+    if(watchedStorageAddress < 0)
+    {
+        return false;
+    }
+    
+    watchedAddress = address;
+    watchedPageWasWatched = memoryBus.isWatched(address >> 8);
+    
+    memoryBus.watchPage(address >> 8);
+    return true;
+}
+
+void Intel_8080_Emulator::stopWatchingWrites()
+{
+    //Code decoded or translated from the pages while they were watched counts on their writes being seen,
+    //so it is thrown away and watches them again when it is next run
+    if(watchedStorageAddress >= 0 && !watchedPageWasWatched)
+    {
+        memoryBus.forEachAlias(watchedAddress, [this](uint16_t aliasAddress)
+        {
+            invalidatePage(aliasAddress >> 8);
+        });
+        
+        memoryBus.unwatchPage(watchedAddress >> 8);
+    }
+    
+    watchedStorageAddress = -1;
+    watchedAddressWritten = false;
+}
+
+bool Intel_8080_Emulator::loadMemory(uint16_t address, std::span<const uint8_t> data)
+{
+    const bool loaded = memoryBus.load(address, data);
+    
+    //Anything that made it in before a failure still has to be invalidated, and marked as written for the next snapshot
+    for(size_t index = 0; index < data.size(); ++index)
+    {
+        invalidateCode(address + index);
+        
+        if(const int storageAddress = memoryBus.getStorageAddress(address + index); storageAddress >= 0)
+        {
+            writtenPages[storageAddress >> 8] = true;
+        }
+    }
+    
+    return loaded;
+}
+
+void Intel_8080_Emulator::snapshot(Snapshot& snapshot) const
+{
+    const uint8_t* storage = memoryBus.getStorage();
+    
+    //Pages written since the last snapshot are only copied if they really changed, a write to ROM or of the same value doesn't
+    for(int page = 0; page < MemoryBus::pageCount; ++page)
+    {
+        const uint8_t* pageStart = storage + page * MemoryBus::pageSize;
+        
+        if(!snapshotPages[page] || (writtenPages[page] && !std::equal(pageStart, pageStart + MemoryBus::pageSize, snapshotPages[page]->begin())))
+        {
+            auto newPage = std::make_shared<Snapshot::Page>();
+            std::copy_n(pageStart, MemoryBus::pageSize, newPage->begin());
+            snapshotPages[page] = std::move(newPage);
+        }
+    }
+    
+    writtenPages.reset();
+    snapshot.pages = snapshotPages;
+    
+    snapshot.cycleCount = cycleCount;
+    snapshot.instructionCount = opCounter;
+    
+    snapshot.programCounter = programCounter;
+    snapshot.bc = registers.getValueFromRegisterPair(RegisterManager::RegisterPair::BC);
+    snapshot.de = registers.getValueFromRegisterPair(RegisterManager::RegisterPair::DE);
+    snapshot.hl = registers.getValueFromRegisterPair(RegisterManager::RegisterPair::HL);
+    snapshot.stackPointer = registers.getValueFromRegisterPair(RegisterManager::RegisterPair::SP);
+    snapshot.accumulator = registers.getRegisterValue(RegisterManager::Register::A);
+    snapshot.flags = alu.createStatusByte();
+    
+    snapshot.interrupts = interrupts;
+    snapshot.halted = haltFlag;
+    
+    snapshot.events.clear();
+    
+    for(const ScheduledEvent& event : scheduledEvents)
+    {
+        snapshot.events.push_back({event.cycle, event.eventId});
+    }
+    
+    snapshot.machineState.clear();
+    saveMachineState(snapshot.machineState);
+}
+
+void Intel_8080_Emulator::restore(const Snapshot& snapshot)
+{
+    uint8_t* storage = memoryBus.getStorage();
+    std::bitset<MemoryBus::pageCount> changedPages;
+    
+    for(int page = 0; page < MemoryBus::pageCount; ++page)
+    {
+        const std::shared_ptr<const Snapshot::Page>& snapshotPage = snapshot.pages[page];
+        assert(snapshotPage);
+        
+        //Storage still holds the page shared with the snapshot if it hasn't been written since
+        if(snapshotPage == snapshotPages[page] && !writtenPages[page])
+        {
+            continue;
+        }
+        
+        uint8_t* pageStart = storage + page * MemoryBus::pageSize;
+        
+        if(!std::equal(snapshotPage->begin(), snapshotPage->end(), pageStart))
+        {
+            std::copy(snapshotPage->begin(), snapshotPage->end(), pageStart);
+            changedPages[page] = true;
+        }
+        
+        snapshotPages[page] = snapshotPage;
+    }
+    
+    writtenPages.reset();
+    
+    //Code is tracked by the address it ran from, which could be any page mapped over the changed memory
+    for(int page = 0; page < MemoryBus::pageCount; ++page)
+    {
+        const int storageAddress = memoryBus.getStorageAddress(page << 8);
+        
+        if(storageAddress >= 0 && changedPages[storageAddress >> 8] && memoryBus.isWatched(page))
+        {
+            invalidatePage(page);
+        }
+    }
+    
+    cycleCount = snapshot.cycleCount;
+    opCounter = snapshot.instructionCount;
+    
+    programCounter = snapshot.programCounter;
+    registers.setRegisterPair(RegisterManager::RegisterPair::BC, snapshot.bc);
+    registers.setRegisterPair(RegisterManager::RegisterPair::DE, snapshot.de);
+    registers.setRegisterPair(RegisterManager::RegisterPair::HL, snapshot.hl);
+    registers.setRegisterPair(RegisterManager::RegisterPair::SP, snapshot.stackPointer);
+    registers.setRegisterValue(RegisterManager::Register::A, snapshot.accumulator);
+    alu.setFromStatusByte(snapshot.flags);
+    
+    interrupts = snapshot.interrupts;
+    haltFlag = snapshot.halted;
+    
+    scheduledEvents.clear();
+    
+    for(const Snapshot::Event& event : snapshot.events)
+    {
+        scheduledEvents.push_back({event.cycle, event.eventId});
+    }
+    
+    restoreMachineState(snapshot.machineState);
+}
+
+void Intel_8080_Emulator::fetch()
+{
+    currentInstruction = &decode(programCounter);
+    currentOpcode = currentInstruction->opcode;
+}
+
+void Intel_8080_Emulator::decodeAndExecute(uint8_t opcode)
+{
+    //Translated code calls in here with the program counter on the instruction, which has to match what it was translated from
+    currentInstruction = &decode(programCounter);
+    assert(currentInstruction->opcode == opcode);
+    
+    (this->*(*machineOpTable)[opcode])(opcode);
+}
+
+void Intel_8080_Emulator::decodeInto(uint16_t address)
+{
+    const uint8_t opcode = readMemory(address);
+    
+    //110 encodes memory rather than a register, which the handlers using it never ask for
+    const auto getRegister = [](uint8_t encodedValue)
+    {
+        return (encodedValue & 0x7) == 0x6 ? RegisterManager::Register::A : RegisterManager::getRegFromEncodedValue(encodedValue);
+    };
+    
+    //Conditions are encoded as a flag in the top two bits and whether it has to be set in the lowest
+    static constexpr std::array<ALU::Flag, 4> conditionFlags
+    {
+        ALU::Flag::Zero,
+        ALU::Flag::Carry,
+        ALU::Flag::Parity,
+        ALU::Flag::Sign
+    };
+    
+    DecodedInstruction& instruction = decodedInstructions[address];
+    
+    instruction.handler = (*activeOpTable)[opcode];
+    instruction.opcode = opcode;
+    instruction.length = OpcodeInfo::getLength(opcode);
+    
+    //Reading past the instruction could reach an I/O handler or memory that isn't mapped
+    instruction.immediate = 0;
+    
+    for(int operand = 1; operand < instruction.length; ++operand)
+    {
+        instruction.immediate |= readMemory(address + operand) << ((operand - 1) * 8);
+    }
+    
+    instruction.firstRegister = getRegister(opcode >> 3);
+    instruction.secondRegister = getRegister(opcode);
+    instruction.registerPair = RegisterManager::getPairFromEncodedValue(opcode >> 4);
+    instruction.conditionFlag = conditionFlags[(opcode >> 4) & 0x3];
+    instruction.conditionValue = opcode & 0x8;
+    instruction.valid = true;
+    
+    //Operands can run on into the next page, a write to either has to reach this record
+    memoryBus.watchPage(address >> 8);
+    memoryBus.watchPage(uint16_t(address + instruction.length - 1) >> 8);
+}
+
+const std::array<Intel_8080_Emulator::OpHandler, 256> Intel_8080_Emulator::opTable = Intel_8080_Emulator::buildOpTable();
+const std::array<Intel_8080_Emulator::OpHandler, 256> Intel_8080_Emulator::profilingOpTable = Intel_8080_Emulator::buildProfilingOpTable();
+const std::array<Intel_8080_Emulator::OpHandler, 256> Intel_8080_Emulator::switchOpTable = Intel_8080_Emulator::buildSwitchOpTable();
+
+const std::array<Intel_8080_Emulator::FusionPattern, 4> Intel_8080_Emulator::fusionPatterns
+{{
+    //MOV r,M then INX H, stepping through a table
+    {&Intel_8080_Emulator::moveFromMemory, &Intel_8080_Emulator::incrementRegisterPair, 0xFF, 0x23, &Intel_8080_Emulator::moveFromMemoryIncrementHL},
+    
+    //DCR r then JNZ, closing a counted loop
+    {&Intel_8080_Emulator::decrementRegister, &Intel_8080_Emulator::conditionalJump, 0xFF, 0xC2, &Intel_8080_Emulator::decrementJumpNotZero},
+    
+    //LDAX then MOV M,A, INX H and INX of the source pair, copying a block a byte at a time
+    {&Intel_8080_Emulator::loadAccumulatorIndirect, &Intel_8080_Emulator::moveToMemory, 0xFF, 0x77, &Intel_8080_Emulator::copyIndirectToMemory},
+    
+    //PUSH then POP, moving one register pair to another through the stack
+    {&Intel_8080_Emulator::push, &Intel_8080_Emulator::pop, 0x00, 0x00, &Intel_8080_Emulator::pushPop}
+}};
+
+std::array<Intel_8080_Emulator::OpHandler, 256> Intel_8080_Emulator::buildProfilingOpTable()
+{
+    std::array<OpHandler, 256> table;
+    table.fill(&Intel_8080_Emulator::profileOpcode);
+    
+    return table;
+}
+
+std::array<Intel_8080_Emulator::OpHandler, 256> Intel_8080_Emulator::buildOpTable()
+{
+    std::array<OpHandler, 256> table{};
+    
+    //Decoded once here so executing an opcode is a single indirect call
+    for(int opcode = 0; opcode < 256; ++opcode)
+    {
+        table[opcode] = decodeOpHandler(opcode);
+        
+        //Every opcode does something, the undocumented ones are copies of documented ones. IN and OUT are left for the machine
+        assert(table[opcode] != nullptr || opcode == 0xDB || opcode == 0xD3);
+    }
+    
+    return table;
+}
+
+std::array<Intel_8080_Emulator::OpHandler, 256> Intel_8080_Emulator::buildSwitchOpTable()
+{
+    std::array<OpHandler, 256> table;
+    table.fill(&Intel_8080_Emulator::dispatchBySwitch);
+    
+    return table;
+}
+
+Intel_8080_Emulator::OpHandler Intel_8080_Emulator::decodeOpHandler(uint8_t opcode)
+{
+    OpHandler handler = nullptr;
+    
+    //Check first two bits
+    switch(opcode & 0xc0)
+    {
+        //00
+        case 0x00:
+            
+            //Look at last 4 bits
+            switch(opcode & 0xCF)
+            {
+                //00RP0001 - Load Register Pair Immediate
+                case 0x1:
+                    handler = &Intel_8080_Emulator::loadRegisterPairImmediate;
+                    break;
                     
-                //10011110 - Subtract Memory with Borrow
-                case 0x9E:
-                {
-                    uint16_t location = registers.getValueFromRegisterPair(RegisterManager::RegisterPair::HL);
-                    
-                    uint8_t result = alu.operateAndSetFlags(registers.getRegisterValue(RegisterManager::Register::A), memory[location], ALU::Operation::Subtraction, ALU::Flag::None, true);
-                    
-                    registers.setRegisterValue(RegisterManager::Register::A, result);
-                    
-                    ++programCounter;
-                    return;
-                }
+                //00RP0011 - Increment Register Pair
+                case 0x3:
+                    handler = &Intel_8080_Emulator::incrementRegisterPair;
+                    break;
                     
-                //10100110 - AND Memory
-                case 0xA6:
-                {
-                    uint16_t location = registers.getValueFromRegisterPair(RegisterManager::RegisterPair::HL);
+                //00RP1011 - Decrement Register Pair
+                case 0xB:
+                    handler = &Intel_8080_Emulator::decrementRegisterPair;
+                    break;
                     
-                    uint8_t result = alu.operateAndSetFlags(registers.getRegisterValue(RegisterManager::Register::A), memory[location], ALU::Operation::And, ALU::Flag::Carry);
+                //00RP1001 - Add Register Pair to H and L
+                case 0x9:
+                    handler = &Intel_8080_Emulator::addRegisterPairToHL;
+                    break;
+            }
+            
+            //Look at the last 3 bits
+            switch(opcode & 0xC7)
+            {
+                //00DDD110 - Move Immediate
+                case 0x6:
+                    handler = &Intel_8080_Emulator::moveImmediate;
+                    break;
                     
-                    //Clear the carry flag
-                    alu.setFlag(ALU::Flag::Carry, false);
+                //00DDD100 - Increment Register
+                case 0x4:
+                    handler = &Intel_8080_Emulator::incrementRegister;
+                    break;
                     
-                    registers.setRegisterValue(RegisterManager::Register::A, result);
+                //00DDD101 - Decrement Register
+                case 0x5:
+                    handler = &Intel_8080_Emulator::decrementRegister;
+                    break;
+            }
+            
+            //Only BC and DE can be used for indirect accumulator loads and stores
+            switch(opcode & 0xFF)
+            {
+                //00RP1010 - Load accumulator indirect
+                case 0x0A:
+                case 0x1A:
+                    handler = &Intel_8080_Emulator::loadAccumulatorIndirect;
+                    break;
                     
-                    ++programCounter;
-                    return;
-                }
+                //00RP0010 - Store accumulator indirect
+                case 0x02:
+                case 0x12:
+                    handler = &Intel_8080_Emulator::storeAccumulatorIndirect;
+                    break;
                     
-                //10101110 - Exclusive OR Memory
-                case 0xAE:
-                {
-                    uint16_t location = registers.getValueFromRegisterPair(RegisterManager::RegisterPair::HL);
+                //00110110 - Move to memory immediate
+                case 0x36:
+                    handler = &Intel_8080_Emulator::moveToMemoryImmediate;
+                    break;
                     
-                    uint8_t result = alu.operateAndSetFlags(registers.getRegisterValue(RegisterManager::Register::A), memory[location], ALU::Operation::Xor, ALU::Flag::CarryFlags);
+                //00111010 - Load Accumulator Direct
+                case 0x3A:
+                    handler = &Intel_8080_Emulator::loadAccumulatorDirect;
+                    break;
                     
-                    //Clear the carry and aux carry flags
-                    alu.setFlag(ALU::Flag::CarryFlags, false);
+                //00110010 - Store Accumulator Direct
+                case 0x32:
+                    handler = &Intel_8080_Emulator::storeAccumulatorDirect;
+                    break;
                     
-                    registers.setRegisterValue(RegisterManager::Register::A, result);
+                //00101010 - Load H and L direct
+                case 0x2A:
+                    handler = &Intel_8080_Emulator::loadHLDirect;
+                    break;
                     
-                    ++programCounter;
-                    return;
-                }
+                //00100010 - Store H and L direct
+                case 0x22:
+                    handler = &Intel_8080_Emulator::storeHLDirect;
+                    break;
                     
-                //10110110 - OR Memory
-                case 0xB6:
-                {
-                    uint16_t location = registers.getValueFromRegisterPair(RegisterManager::RegisterPair::HL);
+                //00110100 - Increment Memory
+                case 0x34:
+                    handler = &Intel_8080_Emulator::incrementMemory;
+                    break;
                     
-                    uint8_t result = alu.operateAndSetFlags(registers.getRegisterValue(RegisterManager::Register::A), memory[location], ALU::Operation::Or, ALU::Flag::CarryFlags);
+                //00110101 - Decrement Memory
+                case 0x35:
+                    handler = &Intel_8080_Emulator::decrementMemory;
+                    break;
                     
-                    //Clear the carry and aux carry flags
-                    alu.setFlag(ALU::Flag::CarryFlags, false);
+                //00100111 - Decimal Adjust Accumulator
+                case 0x27:
+                    handler = &Intel_8080_Emulator::decimalAdjustAccumulator;
+                    break;
                     
-                    registers.setRegisterValue(RegisterManager::Register::A, result);
+                //00000111 - Rotate Left
+                case 0x7:
+                    handler = &Intel_8080_Emulator::rotateLeft;
+                    break;
                     
-                    ++programCounter;
-                    return;
-                }
+                //00001111 - Rotate Right
+                case 0xF:
+                    handler = &Intel_8080_Emulator::rotateRight;
+                    break;
                     
-                //10111110 - Compare Memory
-                case 0xBE:
-                {
-                    uint8_t accVal = registers.getRegisterValue(RegisterManager::Register::A);
-                    uint8_t memVal = memory[registers.getValueFromRegisterPair(RegisterManager::RegisterPair::HL)];
+                //00010111 - Rotate Left Through Carry
+                case 0x17:
+                    handler = &Intel_8080_Emulator::rotateLeftThroughCarry;
+                    break;
                     
-                    alu.operateAndSetFlags(accVal, memVal, ALU::Operation::Subtraction, ALU::Flag::Carry | ALU::Flag::Zero);
+                //00011111 - Rotate Right Through Carry
+                case 0x1F:
+                    handler = &Intel_8080_Emulator::rotateRightThroughCarry;
+                    break;
                     
-                    //The Z flag is set to 1 if (A) = ((H) (L))
-                    alu.setFlag(ALU::Flag::Zero, accVal == memVal);
+                //00101111 - Complement Accumulator
+                case 0x2F:
+                    handler = &Intel_8080_Emulator::complementAccumulator;
+                    break;
                     
-                    //The CY flag is set to 1 if (A) < ((H) (L))
-                    alu.setFlag(ALU::Flag::Carry, accVal < memVal);
+                //00111111 - Complement Carry
+                case 0x3F:
+                    handler = &Intel_8080_Emulator::complementCarry;
+                    break;
                     
-                    ++programCounter;
-                    return;
-                }
+                //00110111 - Set Carry
+                case 0x37:
+                    handler = &Intel_8080_Emulator::setCarry;
+                    break;
                     
-                default:
+                //00000000 - No Op, 00NNN000 are undocumented copies of it
+                case 0x0:
+                case 0x08: case 0x10: case 0x18: case 0x20: case 0x28: case 0x30: case 0x38:
+                    handler = &Intel_8080_Emulator::noOp;
                     break;
             }
             
+            break;
+            
+        //01
+        case 0x40:
+            
+            //01110110 - Halt
+            if(opcode == 0x76)
+            {
+                handler = &Intel_8080_Emulator::halt;
+            }
+            
+            //01DDD110 - Move from memory
+            else if((opcode & 0x7) == 0x6)
+            {
+                handler = &Intel_8080_Emulator::moveFromMemory;
+            }
+            
+            //01110SSS - Move to memory
+            else if((opcode & 0xF8) == 0x70)
+            {
+                handler = &Intel_8080_Emulator::moveToMemory;
+            }
+            
+            //01DDDSSS - Move register
+            else
+            {
+                handler = &Intel_8080_Emulator::moveRegister;
+            }
+            
+            break;
+            
+        //10
+        case 0x80:
+        {
+            //Register operand unless SSS is 110, in which case the operand is memory
+            const bool memoryOperand = (opcode & 0x7) == 0x6;
+            
             //Look at the first 5 bits
             switch(opcode & 0xF8)
             {
-                //10000SSS - Add Register
+                //10000SSS - Add Register/Memory
                 case 0x80:
-                {
-                    uint8_t result = alu.operateAndSetFlags(registers.getRegisterValue(getSecondRegister(opcode)), registers.getRegisterValue(RegisterManager::Register::A));
-                    
-                    registers.setRegisterValue(RegisterManager::Register::A, result);
+                    handler = memoryOperand ? &Intel_8080_Emulator::addMemory : &Intel_8080_Emulator::addRegister;
+                    break;
                     
-                    ++programCounter;
-                    return;
-                }
-                
-                //10001SSS - Add Register with carry
+                //10001SSS - Add Register/Memory with carry
                 case 0x88:
-                {
-                    uint8_t result = alu.operateAndSetFlags(registers.getRegisterValue(getSecondRegister(opcode)), registers.getRegisterValue(RegisterManager::Register::A), ALU::Operation::Addition, ALU::Flag::None, true);
-                    
-                    registers.setRegisterValue(RegisterManager::Register::A, result);
-                    
-                    ++programCounter;
-                    return;
-                }
+                    handler = memoryOperand ? &Intel_8080_Emulator::addMemoryWithCarry : &Intel_8080_Emulator::addRegisterWithCarry;
+                    break;
                     
-                //10010SSS - Subtract Register
+                //10010SSS - Subtract Register/Memory
                 case 0x90:
-                {
-                    uint8_t result = alu.operateAndSetFlags(registers.getRegisterValue(RegisterManager::Register::A), registers.getRegisterValue(getSecondRegister(opcode)), ALU::Operation::Subtraction);
-                    
-                    registers.setRegisterValue(RegisterManager::Register::A, result);
-                    
-                    ++programCounter;
-                    return;
-                }
+                    handler = memoryOperand ? &Intel_8080_Emulator::subtractMemory : &Intel_8080_Emulator::subtractRegister;
+                    break;
                     
-                //10011SSS - Subtract Register with borrow
+                //10011SSS - Subtract Register/Memory with borrow
                 case 0x98:
-                {
-                    uint8_t result = alu.operateAndSetFlags(registers.getRegisterValue(RegisterManager::Register::A), registers.getRegisterValue(getSecondRegister(opcode)), ALU::Operation::Subtraction, ALU::Flag::None, true);
-                    
-                    registers.setRegisterValue(RegisterManager::Register::A, result);
+                    handler = memoryOperand ? &Intel_8080_Emulator::subtractMemoryWithBorrow : &Intel_8080_Emulator::subtractRegisterWithBorrow;
+                    break;
                     
-                    ++programCounter;
-                    return;
-                }
-                
-                //10100SSS - AND Register
+                //10100SSS - AND Register/Memory
                 case 0xA0:
-                {
-                    uint8_t result = alu.operateAndSetFlags(registers.getRegisterValue(RegisterManager::Register::A), registers.getRegisterValue(getSecondRegister(opcode)), ALU::Operation::And, ALU::Flag::Carry);
-                    
-                    //Clear the carry flag
-                    alu.setFlag(ALU::Flag::Carry, false);
-                    
-                    registers.setRegisterValue(RegisterManager::Register::A, result);
-                    
-                    ++programCounter;
-                    return;
-                }
+                    handler = memoryOperand ? &Intel_8080_Emulator::andMemory : &Intel_8080_Emulator::andRegister;
+                    break;
                     
-                //10101SSS - Exclusive OR Register
+                //10101SSS - Exclusive OR Register/Memory
                 case 0xA8:
-                {
-                    uint8_t result = alu.operateAndSetFlags(registers.getRegisterValue(RegisterManager::Register::A), registers.getRegisterValue(getSecondRegister(opcode)), ALU::Operation::Xor, ALU::Flag::CarryFlags);
-                    
-                    //Clear Carry and Aux Carry flags
-                    alu.setFlag(ALU::Flag::CarryFlags, false);
-                    
-                    registers.setRegisterValue(RegisterManager::Register::A, result);
-                    
-                    ++programCounter;
-                    return;
-                }
+                    handler = memoryOperand ? &Intel_8080_Emulator::xorMemory : &Intel_8080_Emulator::xorRegister;
+                    break;
                     
-                //10110SSS - OR Register
+                //10110SSS - OR Register/Memory
                 case 0xB0:
-                {
-                    uint8_t result = alu.operateAndSetFlags(registers.getRegisterValue(RegisterManager::Register::A), registers.getRegisterValue(getSecondRegister(opcode)), ALU::Operation::Or, ALU::Flag::CarryFlags);
-                    
-                    //Clear Carry and Aux Carry flags
-                    alu.setFlag(ALU::Flag::CarryFlags, false);
-                    
-                    registers.setRegisterValue(RegisterManager::Register::A, result);
-                    
-                    ++programCounter;
-                    return;
-                }
+                    handler = memoryOperand ? &Intel_8080_Emulator::orMemory : &Intel_8080_Emulator::orRegister;
+                    break;
                     
-                //10111SSS - Compare Register
+                //10111SSS - Compare Register/Memory
                 case 0xB8:
-                {
-                    uint8_t accVal = registers.getRegisterValue(RegisterManager::Register::A);
-                    uint8_t regVal = registers.getRegisterValue(getSecondRegister(opcode));
-                    
-                    alu.operateAndSetFlags(accVal, regVal, ALU::Operation::Subtraction, ALU::Flag::Zero | ALU::Flag::Carry);
-                    
-                    //The Z flag is set to 1 if (A) = (r)
-                    alu.setFlag(ALU::Flag::Zero, accVal == regVal);
+                    handler = memoryOperand ? &Intel_8080_Emulator::compareMemory : &Intel_8080_Emulator::compareRegister;
+                    break;
+            }
+            
+            break;
+        }
+        
+        //11
+        case 0xc0:
+            
+            //Check last 3 bits
+            switch(opcode & 0x7)
+            {
+                //11CCC010 - Conditional Jump
+                case 0x2:
+                    handler = &Intel_8080_Emulator::conditionalJump;
+                    break;
                     
-                    //The CY flag is set to 1 if (A) < (r)
-                    alu.setFlag(ALU::Flag::Carry, accVal < regVal);
+                //11CCC100 - Conditional Call
+                case 0x4:
+                    handler = &Intel_8080_Emulator::conditionalCall;
+                    break;
                     
-                    ++programCounter;
-                    return;
-                }
+                //11CCC000 - Conditional Return
+                case 0x0:
+                    handler = &Intel_8080_Emulator::conditionalReturn;
+                    break;
                     
-                default:
+                //11NNN111 - Restart
+                case 0x7:
+                    handler = &Intel_8080_Emulator::restart;
                     break;
             }
-            break;
             
-        //11
-        case 0xc0:
+            //Check the last 4 bits
+            switch(opcode & 0xF)
+            {
+                //11RP0101 - Push
+                case 0x5:
+                    handler = &Intel_8080_Emulator::push;
+                    break;
+                    
+                //11RP0001 - Pop
+                case 0x1:
+                    handler = &Intel_8080_Emulator::pop;
+                    break;
+            }
             
-            switch (opcode & 0xFF)
+            switch(opcode & 0xFF)
             {
                 //11000110 - Add Immediate
                 case 0xC6:
-                {
-                    uint8_t result = alu.operateAndSetFlags(memory[programCounter + 1], registers.getRegisterValue(RegisterManager::Register::A));
-                    
-                    registers.setRegisterValue(RegisterManager::Register::A, result);
-                    
-                    programCounter += 2;
-                    return;
-                }
+                    handler = &Intel_8080_Emulator::addImmediate;
+                    break;
                     
                 //11001110 - Add Immediate with Carry
                 case 0xCE:
-                {
-                    uint8_t result = alu.operateAndSetFlags(memory[programCounter + 1], registers.getRegisterValue(RegisterManager::Register::A), ALU::Operation::Addition, ALU::Flag::None, true);
-                    
-                    registers.setRegisterValue(RegisterManager::Register::A, result);
+                    handler = &Intel_8080_Emulator::addImmediateWithCarry;
+                    break;
                     
-                    programCounter += 2;
-                    return;
-                }
-                
                 //11101011 - Exchange H and L with D and E
                 case 0xEB:
-                {
-                    uint16_t hlVal = registers.getValueFromRegisterPair(RegisterManager::RegisterPair::HL);
-                    uint16_t deVal = registers.getValueFromRegisterPair(RegisterManager::RegisterPair::DE);
-                    
-                    registers.setRegisterPair(RegisterManager::RegisterPair::DE, hlVal);
-                    registers.setRegisterPair(RegisterManager::RegisterPair::HL, deVal);
+                    handler = &Intel_8080_Emulator::exchangeHLWithDE;
+                    break;
                     
-                    ++programCounter;
-                    return;
-                }
-                
                 //11010110 - Subtract Immediate
                 case 0xD6:
-                {
-                    uint8_t result = alu.operateAndSetFlags(registers.getRegisterValue(RegisterManager::Register::A), memory[programCounter + 1], ALU::Operation::Subtraction);
-                    
-                    registers.setRegisterValue(RegisterManager::Register::A, result);
-                    
-                    programCounter += 2;
-                    return;
-                }
+                    handler = &Intel_8080_Emulator::subtractImmediate;
+                    break;
                     
                 //11011110 - Subtract Immediate with Borrow
                 case 0xDE:
-                {
-                    uint8_t result = alu.operateAndSetFlags(registers.getRegisterValue(RegisterManager::Register::A), memory[programCounter + 1], ALU::Operation::Subtraction, ALU::Flag::None, true);
-                    
-                    registers.setRegisterValue(RegisterManager::Register::A, result);
-                    
-                    programCounter += 2;
-                    return;
-                }
+                    handler = &Intel_8080_Emulator::subtractImmediateWithBorrow;
+                    break;
                     
                 //11100110 - AND Immediate
                 case 0xE6:
-                {
-                    uint8_t result = alu.operateAndSetFlags(registers.getRegisterValue(RegisterManager::Register::A), memory[programCounter + 1], ALU::Operation::And, ALU::Flag::CarryFlags);
-                    
-                    //Clear Carry and Aux Carry flags
-                    alu.setFlag(ALU::Flag::CarryFlags, false);
-                    
-                    registers.setRegisterValue(RegisterManager::Register::A, result);
-                    
-                    programCounter += 2;
-                    return;
-                }
+                    handler = &Intel_8080_Emulator::andImmediate;
+                    break;
                     
                 //11101110 - Exclusive OR Immediate
                 case 0xEE:
-                {
-                    uint8_t result = alu.operateAndSetFlags(registers.getRegisterValue(RegisterManager::Register::A), memory[programCounter + 1], ALU::Operation::Xor, ALU::Flag::CarryFlags);
-                    
-                    //Clear Carry and Aux Carry flags
-                    alu.setFlag(ALU::Flag::CarryFlags, false);
-                    
-                    registers.setRegisterValue(RegisterManager::Register::A, result);
-                    
-                    programCounter += 2;
-                    return;
-                }
+                    handler = &Intel_8080_Emulator::xorImmediate;
+                    break;
                     
                 //11110110 - OR Immediate
                 case 0xF6:
-                {
-                    uint8_t result = alu.operateAndSetFlags(registers.getRegisterValue(RegisterManager::Register::A), memory[programCounter + 1], ALU::Operation::Or, ALU::Flag::CarryFlags);
-                    
-                    //Clear Carry and Aux Carry flags
-                    alu.setFlag(ALU::Flag::CarryFlags, false);
-                    
-                    registers.setRegisterValue(RegisterManager::Register::A, result);
-                    
-                    programCounter += 2;
-                    return;
-                }
+                    handler = &Intel_8080_Emulator::orImmediate;
+                    break;
                     
                 //11111110 - Compare Immediate
                 case 0xFE:
-                {
-                    uint8_t accVal = registers.getRegisterValue(RegisterManager::Register::A);
-                    uint8_t dataVal = memory[programCounter + 1];
-                    
-                    alu.operateAndSetFlags(accVal, dataVal, ALU::Operation::Subtraction, ALU::Flag::Zero | ALU::Flag::Carry);
-                    
-                    //The Z flag is set to 1 if (A) = (byte 2)
-                    alu.setFlag(ALU::Flag::Zero, accVal == dataVal);
-                    
-                    //The CY flag is set to 1 if (A) < (byte 2)
-                    alu.setFlag(ALU::Flag::Carry, accVal < dataVal);
-                    
-                    programCounter += 2;
-                    return;
-                }
+                    handler = &Intel_8080_Emulator::compareImmediate;
+                    break;
                     
-                //11000011 - Jump
+                //11000011 - Jump, 11001011 is an undocumented copy
                 case 0xC3:
-                {
-                    programCounter = getAddressInDataBytes();
-                    return;
-                }
+                case 0xCB:
+                    handler = &Intel_8080_Emulator::unconditionalJump;
+                    break;
                     
-                //11001101 - Call
+                //11001101 - Call, 11011101, 11101101 and 11111101 are undocumented copies
                 case 0xCD:
-                {
-                    if(debugMode)
-                    {
-                        if(5 == ((memory[programCounter + 2] << 8) | memory[programCounter + 1]))
-                        {
-                            if(registers.getRegisterValue(RegisterManager::Register::C) == 9)
-                            {
-                                uint16_t offset = (registers.getRegisterValue(RegisterManager::Register::D) << 8) | (registers.getRegisterValue(RegisterManager::Register::E));
-                            
-                                const auto messageStart = memory.begin() + offset+3;
-                                const auto messageEnd = std::find(messageStart, memory.end(), '$');
-                            
-                                std::for_each(messageStart, messageEnd, [](uint8_t val)
-                                {
-                                    std::cout << val;
-                                });
-                            
-                                std::cout << std::endl;
-                            }
-                            else if (registers.getRegisterValue(RegisterManager::Register::C) == 2)
-                            {
-                                std::cout << "print char routine called" << std::endl;
-                            }
-                        }
-                        else if (0 == ((memory[programCounter + 2] << 8) | memory[programCounter + 1]))
-                        {
-                            exit(0);
-                        }
-                        else
-                        {
-                            call();
-                        }
-                        return;
-                    }
-                    
-                    call();
-                    return;
-                }
+                case 0xDD: case 0xED: case 0xFD:
+                    handler = &Intel_8080_Emulator::unconditionalCall;
+                    break;
                     
-                //11001001 - Return
+                //11001001 - Return, 11011001 is an undocumented copy
                 case 0xC9:
-                {
-                    ret();
-                    return;
-                }
-                    
+                case 0xD9:
+                    handler = &Intel_8080_Emulator::unconditionalReturn;
+                    break;
                     
                 //11101001 - Jump H and L indirect - move H and L to Program Counter
                 case 0xE9:
-                {
-                    programCounter = registers.getValueFromRegisterPair(RegisterManager::RegisterPair::HL);
-                    return;
-                }
+                    handler = &Intel_8080_Emulator::jumpHLIndirect;
+                    break;
                     
                 //11110101 - Push processor status word
                 case 0xF5:
-                {
-                    uint16_t sp = registers.getValueFromRegisterPair(RegisterManager::RegisterPair::SP);
-                    
-                    memory[--sp] = registers.getRegisterValue(RegisterManager::Register::A);
-                    memory[--sp] = alu.createStatusByte();
-                    
-                    registers.setRegisterPair(RegisterManager::RegisterPair::SP, sp);
-                    ++programCounter;
-                    return;
-                }
+                    handler = &Intel_8080_Emulator::pushProcessorStatusWord;
+                    break;
                     
                 //11110001 - Pop processor status word
                 case 0xF1:
-                {
-                    uint16_t sp = registers.getValueFromRegisterPair(RegisterManager::RegisterPair::SP);
-                    
-                    alu.setFromStatusByte(memory[sp++]);
-                    registers.setRegisterValue(RegisterManager::Register::A, memory[sp++]);
-                    
-                    registers.setRegisterPair(RegisterManager::RegisterPair::SP, sp);
-                    ++programCounter;
-                    return;
-                }
-                    
-                //11100011 - Exchange stack top with H and L
-                case 0xE3:
-                {
-                    const uint16_t stackVal = registers.getValueFromRegisterPair(RegisterManager::RegisterPair::SP);
-                    
-                    const uint8_t firstStackVal = memory[stackVal];
-                    const uint8_t secondStackVal = memory[stackVal + 1];
-                    
-                    const uint8_t lVal = registers.getRegisterValue(RegisterManager::Register::L);
-                    const uint8_t hVal = registers.getRegisterValue(RegisterManager::Register::H);
-                    
-                    memory[stackVal] = lVal;
-                    memory[stackVal + 1] = hVal;
-                    
-                    registers.setRegisterValue(RegisterManager::Register::L, firstStackVal);
-                    registers.setRegisterValue(RegisterManager::Register::H, secondStackVal);
-                    
-                    ++programCounter;
-                    return;
-                }
-                    
-                //11111001 - Move HL to SP
-                case 0xF9:
-                {
-                    registers.setRegisterPair(RegisterManager::RegisterPair::SP, registers.getValueFromRegisterPair(RegisterManager::RegisterPair::HL));
-                    
-                    ++programCounter;
-                    return;
-                }
-                    
-                //11011011 - Input
-                case 0xDB:
-                {
-                    registers.setRegisterValue(RegisterManager::Register::A, inputOperation(memory[programCounter + 1]));
-                    ++programCounter;
-                }
-                    
-                //11010011 - Output
-                case 0xD3:
-                {
-                    outputOperation(memory[programCounter + 1], registers.getRegisterValue(RegisterManager::Register::A));
-                    ++programCounter;
-                }
-                    
-                //11111011 - Enable Interrupts
-                case 0xFB:
-                {
-                    interrupts = true;
-                    ++programCounter;
-                }
-                    
-                //11110011 - Disable Interrupts
-                case 0xF3:
-                {
-                    interrupts = false;
-                    ++programCounter;
-                }
-                    
-                default:
+                    handler = &Intel_8080_Emulator::popProcessorStatusWord;
                     break;
-            }
-            
-            //Check last 3 bits
-            switch (opcode & 0x7)
-            {
-                //11CCC010 - Conditional Jump
-                case 0x2:
-                {
-                    if(checkCurrentCondition())
-                    {
-                        programCounter = getAddressInDataBytes();
-                    }
-                    else
-                    {
-                        programCounter += 3;
-                    }
-                    
-                    return;
-                }
-                
-                //11CCC100 - Conditional Call
-                case 0x4:
-                {
-                    if(checkCurrentCondition())
-                    {
-                        //This is where we leave the script
-                        //assert(false);
-                        call();
-                    }
-                    else
-                    {
-                        programCounter += 3;
-                    }
-                    
-                    return;
-                }
-                    
-                //11CCC000 - Conditional Return
-                case 0x0:
-                {
-                    if(checkCurrentCondition())
-                    {
-                        ret();
-                    }
-                    else
-                    {
-                        ++programCounter;
-                    }
-                    
-                    return;
-                }
-                    
-                //11NNN111 - Restart
-                case 0x7:
-                {
-                    uint16_t sp = registers.getValueFromRegisterPair(RegisterManager::RegisterPair::SP);
                     
-                    memory[--sp] = programCounter >> 8;
-                    memory[--sp] = programCounter;
+                //11100011 - Exchange stack top with H and L
+                case 0xE3:
+                    handler = &Intel_8080_Emulator::exchangeStackTopWithHL;
+                    break;
                     
-                    registers.setRegisterPair(RegisterManager::RegisterPair::SP, sp);
+                //11111001 - Move HL to SP
+                case 0xF9:
+                    handler = &Intel_8080_Emulator::moveHLToSP;
+                    break;
                     
-                    uint8_t restartNumber = (opcode & 0x38) >> 3;
-                    programCounter = restartNumber * 8;
-                    return;
-                }
+                //11011011 - Input and 11010011 - Output are filled in by Intel_8080_Machine, which calls the machine's ports directly
                     
-                default:
+                //11111011 - Enable Interrupts
+                case 0xFB:
+                    handler = &Intel_8080_Emulator::enableInterrupts;
+                    break;
+                    
+                //11110011 - Disable Interrupts
+                case 0xF3:
+                    handler = &Intel_8080_Emulator::disableInterrupts;
                     break;
             }
             
-        //Check the last 4 bits
-        switch (opcode & 0xF)
-        {
-            //11RP0101 - Push
-            case 0x5:
-            {
-                const uint16_t val = registers.getValueFromRegisterPair(getRegisterPair(opcode));
-                uint16_t sp = registers.getValueFromRegisterPair(RegisterManager::RegisterPair::SP);
-                
-                memory[--sp] = val >> 8;
-                memory[--sp] = val;
-                
-                registers.setRegisterPair(RegisterManager::RegisterPair::SP, sp);
-                ++programCounter;
-                return;
-            }
-                
-            //11RP0001 - Pop
-            case 0x1:
-            {
-                uint16_t sp = registers.getValueFromRegisterPair(RegisterManager::RegisterPair::SP);
-                
-                registers.setRegisterPair(getRegisterPair(opcode), memory[sp + 1], memory[sp]);
-                
-                sp += 2;
-                registers.setRegisterPair(RegisterManager::RegisterPair::SP, sp);
-                ++programCounter;
-                return;
-            }
-                
-            default:
-                break;
-        }
+            break;
     }
+    
+    return handler;
+}
+
+//00110110 - Move to memory immediate
+void Intel_8080_Emulator::moveToMemoryImmediate(uint8_t)
+{
+    uint16_t destMemLocation = registers.getValueFromRegisterPair(RegisterManager::RegisterPair::HL);
+    uint8_t dataByte = getDataByte();
+    
+    writeMemory(destMemLocation, dataByte);
+    
+    programCounter += 2;
+}
+
+//00111010 - Load Accumulator Direct
+void Intel_8080_Emulator::loadAccumulatorDirect(uint8_t)
+{
+    uint8_t data = readMemory(getAddressInDataBytes());
+    registers.setRegisterValue(RegisterManager::Register::A, data);
+    
+    programCounter += 3;
+}
+
+//00110010 - Store Accumulator Direct
+void Intel_8080_Emulator::storeAccumulatorDirect(uint8_t)
+{
+    uint8_t data = registers.getRegisterValue(RegisterManager::Register::A);
+    writeMemory(getAddressInDataBytes(), data);
+    
+    programCounter += 3;
+}
+
+//00101010 - Load H and L direct
+void Intel_8080_Emulator::loadHLDirect(uint8_t)
+{
+    uint16_t sourceMemoryAddress = getAddressInDataBytes();
+    
+    registers.setRegisterValue(RegisterManager::Register::L, readMemory(sourceMemoryAddress));
+    registers.setRegisterValue(RegisterManager::Register::H, readMemory(sourceMemoryAddress + 1));
+    
+    programCounter += 3;
+}
+
+//00100010 - Store H and L direct
+void Intel_8080_Emulator::storeHLDirect(uint8_t)
+{
+    uint16_t destMemoryAddress = getAddressInDataBytes();
+    
+    writeMemory(destMemoryAddress, registers.getRegisterValue(RegisterManager::Register::L));
+    writeMemory(destMemoryAddress + 1, registers.getRegisterValue(RegisterManager::Register::H));
+    
+    programCounter += 3;
+}
+
+//00110100 - Increment Memory
+void Intel_8080_Emulator::incrementMemory(uint8_t)
+{
+    uint16_t address = registers.getValueFromRegisterPair(RegisterManager::RegisterPair::HL);
+    
+    uint8_t result = alu.operateAndSetFlags(readMemory(address), uint8_t(1), ALU::Operation::Addition, ALU::Flag::Carry, false);
+    
+    writeMemory(address, result);
+    
+    ++programCounter;
+}
+
+//00110101 - Decrement Memory
+void Intel_8080_Emulator::decrementMemory(uint8_t)
+{
+    uint16_t address = registers.getValueFromRegisterPair(RegisterManager::RegisterPair::HL);
+    
+    uint8_t result = alu.operateAndSetFlags(readMemory(address), uint8_t(1), ALU::Operation::Subtraction, ALU::Flag::Carry, false);
+    
+    writeMemory(address, result);
+    
+    ++programCounter;
+}
+
+//00100111 - Decimal Adjust Accumulator
+void Intel_8080_Emulator::decimalAdjustAccumulator(uint8_t)
+{
+    const uint8_t accumulatorVal = registers.getRegisterValue(RegisterManager::Register::A);
+    
+    registers.setRegisterValue(RegisterManager::Register::A, alu.decimalAdjust(accumulatorVal));
+    ++programCounter;
+}
+
+//00000111 - Rotate Left
+void Intel_8080_Emulator::rotateLeft(uint8_t)
+{
+    ALU::Flag flagsToIgnore = ALU::Flag::Zero | ALU::Flag::Sign | ALU::Flag::Parity | ALU::Flag::AuxillaryCarry;
+    
+    uint8_t result = alu.operateAndSetFlags(registers.getRegisterValue(RegisterManager::Register::A), uint8_t(0), ALU::Operation::RotateLeft, flagsToIgnore);
+    
+    registers.setRegisterValue(RegisterManager::Register::A, result);
+    
+    ++programCounter;
+}
+
+//00001111 - Rotate Right
+void Intel_8080_Emulator::rotateRight(uint8_t)
+{
+    ALU::Flag flagsToIgnore = ALU::Flag::Zero | ALU::Flag::Sign | ALU::Flag::Parity | ALU::Flag::AuxillaryCarry;
+    
+    uint8_t result = alu.operateAndSetFlags(registers.getRegisterValue(RegisterManager::Register::A), uint8_t(0), ALU::Operation::RotateRight, flagsToIgnore);
+    
+    registers.setRegisterValue(RegisterManager::Register::A, result);
+    
+    ++programCounter;
+}
+
+//00010111 - Rotate Left Through Carry
+void Intel_8080_Emulator::rotateLeftThroughCarry(uint8_t)
+{
+    ALU::Flag flagsToIgnore = ALU::Flag::Zero | ALU::Flag::Sign | ALU::Flag::Parity | ALU::Flag::AuxillaryCarry;
+    
+    uint8_t result = alu.operateAndSetFlags(registers.getRegisterValue(RegisterManager::Register::A), uint8_t(0), ALU::Operation::RotateLeft, flagsToIgnore, true);
+    
+    registers.setRegisterValue(RegisterManager::Register::A, result);
+    
+    ++programCounter;
+}
+
+//00011111 - Rotate Right Through Carry
+void Intel_8080_Emulator::rotateRightThroughCarry(uint8_t)
+{
+    ALU::Flag flagsToIgnore = ALU::Flag::Zero | ALU::Flag::Sign | ALU::Flag::Parity | ALU::Flag::AuxillaryCarry;
+    
+    uint8_t result = alu.operateAndSetFlags(registers.getRegisterValue(RegisterManager::Register::A), uint8_t(0), ALU::Operation::RotateRight, flagsToIgnore, true);
+    
+    registers.setRegisterValue(RegisterManager::Register::A, result);
+    
+    ++programCounter;
+}
+
+//00101111 - Complement Accumulator
+void Intel_8080_Emulator::complementAccumulator(uint8_t)
+{
+    registers.setRegisterValue(RegisterManager::Register::A, ~registers.getRegisterValue(RegisterManager::Register::A));
+    ++programCounter;
+}
+
+//00111111 - Complement Carry
+void Intel_8080_Emulator::complementCarry(uint8_t)
+{
+    alu.setFlag(ALU::Flag::Carry, !alu.getFlag(ALU::Flag::Carry));
+    ++programCounter;
+}
+
+//00110111 - Set Carry
+void Intel_8080_Emulator::setCarry(uint8_t)
+{
+    alu.setFlag(ALU::Flag::Carry, true);
+    ++programCounter;
+}
+
+//00000000 - No Op
+void Intel_8080_Emulator::noOp(uint8_t)
+{
+    ++programCounter;
+}
+
+//00RP0001 - Load Register Pair Immediate
+void Intel_8080_Emulator::loadRegisterPairImmediate(uint8_t)
+{
+    RegisterManager::RegisterPair destPair = getRegisterPair();
+    
+    registers.setRegisterPair(destPair, getAddressInDataBytes());
+    
+    programCounter += 3;
+}
+
+//00RP1010 - Load accumulator indirect
+void Intel_8080_Emulator::loadAccumulatorIndirect(uint8_t)
+{
+    RegisterManager::RegisterPair pair = getRegisterPair();
+    
+    uint8_t data = readMemory(registers.getValueFromRegisterPair(pair));
+    
+    registers.setRegisterValue(RegisterManager::Register::A, data);
+    
+    ++programCounter;
+}
+
+//00RP0010 - Store accumulator indirect
+void Intel_8080_Emulator::storeAccumulatorIndirect(uint8_t)
+{
+    RegisterManager::RegisterPair pair = getRegisterPair();
+    
+    uint16_t destAddress = registers.getValueFromRegisterPair(pair);
+    
+    writeMemory(destAddress, registers.getRegisterValue(RegisterManager::Register::A));
+    
+    ++programCounter;
+}
+
+//00RP0011 - Increment Register Pair
+void Intel_8080_Emulator::incrementRegisterPair(uint8_t)
+{
+    registers.setRegisterPair(getRegisterPair(), registers.getValueFromRegisterPair(getRegisterPair()) + 1);
+    
+    ++programCounter;
+}
+
+//00RP1011 - Decrement Register Pair
+void Intel_8080_Emulator::decrementRegisterPair(uint8_t)
+{
+    registers.setRegisterPair(getRegisterPair(), registers.getValueFromRegisterPair(getRegisterPair()) - 1);
+    
+    ++programCounter;
+}
+
+//00RP1001 - Add Register Pair to H and L
+void Intel_8080_Emulator::addRegisterPairToHL(uint8_t)
+{
+    ALU::Flag flagsToExclude = ALU::Flag::Zero | ALU::Flag::Sign | ALU::Flag::Parity | ALU::Flag::AuxillaryCarry;
+    
+    uint16_t result = alu.operateAndSetFlags(registers.getValueFromRegisterPair(RegisterManager::RegisterPair::HL), registers.getValueFromRegisterPair(getRegisterPair()), ALU::Operation::Addition, flagsToExclude);
+    
+    registers.setRegisterPair(RegisterManager::RegisterPair::HL, result);
+    
+    ++programCounter;
+}
+
+//00DDD110 - Move Immediate
+void Intel_8080_Emulator::moveImmediate(uint8_t)
+{
+    RegisterManager::Register destReg = getFirstRegister();
+    uint8_t dataByte = getDataByte();
+    
+    registers.setRegisterValue(destReg, dataByte);
+    
+    programCounter += 2;
+}
+
+//00DDD100 - Increment Register
+void Intel_8080_Emulator::incrementRegister(uint8_t)
+{
+    uint8_t result = alu.operateAndSetFlags(registers.getRegisterValue(getFirstRegister()), uint8_t(1), ALU::Operation::Addition, ALU::Flag::Carry, false);
+    
+    registers.setRegisterValue(getFirstRegister(), result);
+    
+    ++programCounter;
+}
+
+//00DDD101 - Decrement Register
+void Intel_8080_Emulator::decrementRegister(uint8_t)
+{
+    uint8_t result = alu.operateAndSetFlags(registers.getRegisterValue(getFirstRegister()), uint8_t(1), ALU::Operation::Subtraction, ALU::Flag::Carry, false);
+    
+    registers.setRegisterValue(getFirstRegister(), result);
+    
+    ++programCounter;
+}
+
+//01110110 - Halt
+void Intel_8080_Emulator::halt(uint8_t)
+{
+    haltFlag = true;
+    ++programCounter;
+}
+
+//01DDD110 - Move from memory
+void Intel_8080_Emulator::moveFromMemory(uint8_t)
+{
+    uint16_t sourceMemoryLocation = registers.getValueFromRegisterPair(RegisterManager::RegisterPair::HL);
+    
+    RegisterManager::Register destReg = getFirstRegister();
+    
+    registers.setRegisterValue(destReg, readMemory(sourceMemoryLocation));
+    
+    ++programCounter;
+}
+
+//01110SSS - Move to memory
+void Intel_8080_Emulator::moveToMemory(uint8_t)
+{
+    uint16_t destMemoryLocation = registers.getValueFromRegisterPair(RegisterManager::RegisterPair::HL);
+    
+    RegisterManager::Register sourceReg = getSecondRegister();
+    
+    writeMemory(destMemoryLocation, registers.getRegisterValue(sourceReg));
+    
+    ++programCounter;
+}
+
+//01DDDSSS - Move register
+void Intel_8080_Emulator::moveRegister(uint8_t)
+{
+    RegisterManager::Register firstReg = getFirstRegister();
+    RegisterManager::Register secondReg = getSecondRegister();
+    
+    registers.setRegisterValue(firstReg, registers.getRegisterValue(secondReg));
+    
+    ++programCounter;
+}
+
+//10000110 - Add Memory
+void Intel_8080_Emulator::addMemory(uint8_t)
+{
+    uint16_t location = registers.getValueFromRegisterPair(RegisterManager::RegisterPair::HL);
+    
+    uint8_t result = alu.operateAndSetFlags(registers.getRegisterValue(RegisterManager::Register::A), readMemory(location));
+    
+    registers.setRegisterValue(RegisterManager::Register::A, result);
+    
+    ++programCounter;
+}
+
+//10001110 - Add memory with carry
+void Intel_8080_Emulator::addMemoryWithCarry(uint8_t)
+{
+    uint16_t location = registers.getValueFromRegisterPair(RegisterManager::RegisterPair::HL);
+    
+    uint8_t result = alu.operateAndSetFlags(registers.getRegisterValue(RegisterManager::Register::A), readMemory(location), ALU::Operation::Addition, ALU::Flag::None, true);
+    
+    registers.setRegisterValue(RegisterManager::Register::A, result);
+    
+    ++programCounter;
+}
+
+//10010110 - Subtract Memory
+void Intel_8080_Emulator::subtractMemory(uint8_t)
+{
+    uint16_t location = registers.getValueFromRegisterPair(RegisterManager::RegisterPair::HL);
+    
+    uint8_t result = alu.operateAndSetFlags(registers.getRegisterValue(RegisterManager::Register::A), readMemory(location), ALU::Operation::Subtraction);
+    
+    registers.setRegisterValue(RegisterManager::Register::A, result);
+    
+    ++programCounter;
+}
+
+//10011110 - Subtract Memory with Borrow
+void Intel_8080_Emulator::subtractMemoryWithBorrow(uint8_t)
+{
+    uint16_t location = registers.getValueFromRegisterPair(RegisterManager::RegisterPair::HL);
+    
+    uint8_t result = alu.operateAndSetFlags(registers.getRegisterValue(RegisterManager::Register::A), readMemory(location), ALU::Operation::Subtraction, ALU::Flag::None, true);
+    
+    registers.setRegisterValue(RegisterManager::Register::A, result);
+    
+    ++programCounter;
+}
+
+//10100110 - AND Memory
+void Intel_8080_Emulator::andMemory(uint8_t)
+{
+    uint16_t location = registers.getValueFromRegisterPair(RegisterManager::RegisterPair::HL);
+    
+    uint8_t result = alu.operateAndSetFlags(registers.getRegisterValue(RegisterManager::Register::A), readMemory(location), ALU::Operation::And, ALU::Flag::Carry);
+    
+    //Clear the carry flag
+    alu.setFlag(ALU::Flag::Carry, false);
+    
+    registers.setRegisterValue(RegisterManager::Register::A, result);
+    
+    ++programCounter;
+}
+
+//10101110 - Exclusive OR Memory
+void Intel_8080_Emulator::xorMemory(uint8_t)
+{
+    uint16_t location = registers.getValueFromRegisterPair(RegisterManager::RegisterPair::HL);
+    
+    uint8_t result = alu.operateAndSetFlags(registers.getRegisterValue(RegisterManager::Register::A), readMemory(location), ALU::Operation::Xor, ALU::Flag::CarryFlags);
+    
+    //Clear the carry and aux carry flags
+    alu.setFlag(ALU::Flag::CarryFlags, false);
+    
+    registers.setRegisterValue(RegisterManager::Register::A, result);
+    
+    ++programCounter;
+}
+
+//10110110 - OR Memory
+void Intel_8080_Emulator::orMemory(uint8_t)
+{
+    uint16_t location = registers.getValueFromRegisterPair(RegisterManager::RegisterPair::HL);
+    
+    uint8_t result = alu.operateAndSetFlags(registers.getRegisterValue(RegisterManager::Register::A), readMemory(location), ALU::Operation::Or, ALU::Flag::CarryFlags);
+    
+    //Clear the carry and aux carry flags
+    alu.setFlag(ALU::Flag::CarryFlags, false);
+    
+    registers.setRegisterValue(RegisterManager::Register::A, result);
+    
+    ++programCounter;
+}
+
+//10111110 - Compare Memory
+void Intel_8080_Emulator::compareMemory(uint8_t)
+{
+    uint8_t accVal = registers.getRegisterValue(RegisterManager::Register::A);
+    uint8_t memVal = readMemory(registers.getValueFromRegisterPair(RegisterManager::RegisterPair::HL));
+    
+    alu.operateAndSetFlags(accVal, memVal, ALU::Operation::Subtraction, ALU::Flag::Carry | ALU::Flag::Zero);
+    
+    //The Z flag is set to 1 if (A) = ((H) (L))
+    alu.setFlag(ALU::Flag::Zero, accVal == memVal);
+    
+    //The CY flag is set to 1 if (A) < ((H) (L))
+    alu.setFlag(ALU::Flag::Carry, accVal < memVal);
+    
+    ++programCounter;
+}
+
+//10000SSS - Add Register
+void Intel_8080_Emulator::addRegister(uint8_t)
+{
+    uint8_t result = alu.operateAndSetFlags(registers.getRegisterValue(getSecondRegister()), registers.getRegisterValue(RegisterManager::Register::A));
+    
+    registers.setRegisterValue(RegisterManager::Register::A, result);
+    
+    ++programCounter;
+}
+
+//10001SSS - Add Register with carry
+void Intel_8080_Emulator::addRegisterWithCarry(uint8_t)
+{
+    uint8_t result = alu.operateAndSetFlags(registers.getRegisterValue(getSecondRegister()), registers.getRegisterValue(RegisterManager::Register::A), ALU::Operation::Addition, ALU::Flag::None, true);
+    
+    registers.setRegisterValue(RegisterManager::Register::A, result);
+    
+    ++programCounter;
+}
+
+//10010SSS - Subtract Register
+void Intel_8080_Emulator::subtractRegister(uint8_t)
+{
+    uint8_t result = alu.operateAndSetFlags(registers.getRegisterValue(RegisterManager::Register::A), registers.getRegisterValue(getSecondRegister()), ALU::Operation::Subtraction);
+    
+    registers.setRegisterValue(RegisterManager::Register::A, result);
+    
+    ++programCounter;
+}
+
+//10011SSS - Subtract Register with borrow
+void Intel_8080_Emulator::subtractRegisterWithBorrow(uint8_t)
+{
+    uint8_t result = alu.operateAndSetFlags(registers.getRegisterValue(RegisterManager::Register::A), registers.getRegisterValue(getSecondRegister()), ALU::Operation::Subtraction, ALU::Flag::None, true);
+    
+    registers.setRegisterValue(RegisterManager::Register::A, result);
+    
+    ++programCounter;
+}
+
+//10100SSS - AND Register
+void Intel_8080_Emulator::andRegister(uint8_t)
+{
+    uint8_t result = alu.operateAndSetFlags(registers.getRegisterValue(RegisterManager::Register::A), registers.getRegisterValue(getSecondRegister()), ALU::Operation::And, ALU::Flag::Carry);
+    
+    //Clear the carry flag
+    alu.setFlag(ALU::Flag::Carry, false);
+    
+    registers.setRegisterValue(RegisterManager::Register::A, result);
+    
+    ++programCounter;
+}
+
+//10101SSS - Exclusive OR Register
+void Intel_8080_Emulator::xorRegister(uint8_t)
+{
+    uint8_t result = alu.operateAndSetFlags(registers.getRegisterValue(RegisterManager::Register::A), registers.getRegisterValue(getSecondRegister()), ALU::Operation::Xor, ALU::Flag::CarryFlags);
+    
+    //Clear Carry and Aux Carry flags
+    alu.setFlag(ALU::Flag::CarryFlags, false);
+    
+    registers.setRegisterValue(RegisterManager::Register::A, result);
+    
+    ++programCounter;
+}
+
+//10110SSS - OR Register
+void Intel_8080_Emulator::orRegister(uint8_t)
+{
+    uint8_t result = alu.operateAndSetFlags(registers.getRegisterValue(RegisterManager::Register::A), registers.getRegisterValue(getSecondRegister()), ALU::Operation::Or, ALU::Flag::CarryFlags);
+    
+    //Clear Carry and Aux Carry flags
+    alu.setFlag(ALU::Flag::CarryFlags, false);
+    
+    registers.setRegisterValue(RegisterManager::Register::A, result);
+    
+    ++programCounter;
+}
+
+//10111SSS - Compare Register
+void Intel_8080_Emulator::compareRegister(uint8_t)
+{
+    uint8_t accVal = registers.getRegisterValue(RegisterManager::Register::A);
+    uint8_t regVal = registers.getRegisterValue(getSecondRegister());
+    
+    alu.operateAndSetFlags(accVal, regVal, ALU::Operation::Subtraction, ALU::Flag::Zero | ALU::Flag::Carry);
+    
+    //The Z flag is set to 1 if (A) = (r)
+    alu.setFlag(ALU::Flag::Zero, accVal == regVal);
+    
+    //The CY flag is set to 1 if (A) < (r)
+    alu.setFlag(ALU::Flag::Carry, accVal < regVal);
+    
+    ++programCounter;
+}
+
+//11000110 - Add Immediate
+void Intel_8080_Emulator::addImmediate(uint8_t)
+{
+    uint8_t result = alu.operateAndSetFlags(getDataByte(), registers.getRegisterValue(RegisterManager::Register::A));
+    
+    registers.setRegisterValue(RegisterManager::Register::A, result);
+    
+    programCounter += 2;
+}
+
+//11001110 - Add Immediate with Carry
+void Intel_8080_Emulator::addImmediateWithCarry(uint8_t)
+{
+    uint8_t result = alu.operateAndSetFlags(getDataByte(), registers.getRegisterValue(RegisterManager::Register::A), ALU::Operation::Addition, ALU::Flag::None, true);
+    
+    registers.setRegisterValue(RegisterManager::Register::A, result);
+    
+    programCounter += 2;
+}
+
+//11101011 - Exchange H and L with D and E
+void Intel_8080_Emulator::exchangeHLWithDE(uint8_t)
+{
+    uint16_t hlVal = registers.getValueFromRegisterPair(RegisterManager::RegisterPair::HL);
+    uint16_t deVal = registers.getValueFromRegisterPair(RegisterManager::RegisterPair::DE);
+    
+    registers.setRegisterPair(RegisterManager::RegisterPair::DE, hlVal);
+    registers.setRegisterPair(RegisterManager::RegisterPair::HL, deVal);
+    
+    ++programCounter;
+}
+
+//11010110 - Subtract Immediate
+void Intel_8080_Emulator::subtractImmediate(uint8_t)
+{
+    uint8_t result = alu.operateAndSetFlags(registers.getRegisterValue(RegisterManager::Register::A), getDataByte(), ALU::Operation::Subtraction);
+    
+    registers.setRegisterValue(RegisterManager::Register::A, result);
+    
+    programCounter += 2;
+}
+
+//11011110 - Subtract Immediate with Borrow
+void Intel_8080_Emulator::subtractImmediateWithBorrow(uint8_t)
+{
+    uint8_t result = alu.operateAndSetFlags(registers.getRegisterValue(RegisterManager::Register::A), getDataByte(), ALU::Operation::Subtraction, ALU::Flag::None, true);
+    
+    registers.setRegisterValue(RegisterManager::Register::A, result);
+    
+    programCounter += 2;
+}
+
+//11100110 - AND Immediate
+void Intel_8080_Emulator::andImmediate(uint8_t)
+{
+    uint8_t result = alu.operateAndSetFlags(registers.getRegisterValue(RegisterManager::Register::A), getDataByte(), ALU::Operation::And, ALU::Flag::CarryFlags);
+    
+    //Clear Carry and Aux Carry flags
+    alu.setFlag(ALU::Flag::CarryFlags, false);
+    
+    registers.setRegisterValue(RegisterManager::Register::A, result);
+    
+    programCounter += 2;
+}
+
+//11101110 - Exclusive OR Immediate
+void Intel_8080_Emulator::xorImmediate(uint8_t)
+{
+    uint8_t result = alu.operateAndSetFlags(registers.getRegisterValue(RegisterManager::Register::A), getDataByte(), ALU::Operation::Xor, ALU::Flag::CarryFlags);
+    
+    //Clear Carry and Aux Carry flags
+    alu.setFlag(ALU::Flag::CarryFlags, false);
+    
+    registers.setRegisterValue(RegisterManager::Register::A, result);
+    
+    programCounter += 2;
+}
+
+//11110110 - OR Immediate
+void Intel_8080_Emulator::orImmediate(uint8_t)
+{
+    uint8_t result = alu.operateAndSetFlags(registers.getRegisterValue(RegisterManager::Register::A), getDataByte(), ALU::Operation::Or, ALU::Flag::CarryFlags);
+    
+    //Clear Carry and Aux Carry flags
+    alu.setFlag(ALU::Flag::CarryFlags, false);
+    
+    registers.setRegisterValue(RegisterManager::Register::A, result);
+    
+    programCounter += 2;
+}
+
+//11111110 - Compare Immediate
+void Intel_8080_Emulator::compareImmediate(uint8_t)
+{
+    uint8_t accVal = registers.getRegisterValue(RegisterManager::Register::A);
+    uint8_t dataVal = getDataByte();
+    
+    alu.operateAndSetFlags(accVal, dataVal, ALU::Operation::Subtraction, ALU::Flag::Zero | ALU::Flag::Carry);
+    
+    //The Z flag is set to 1 if (A) = (byte 2)
+    alu.setFlag(ALU::Flag::Zero, accVal == dataVal);
+    
+    //The CY flag is set to 1 if (A) < (byte 2)
+    alu.setFlag(ALU::Flag::Carry, accVal < dataVal);
+    
+    programCounter += 2;
+}
+
+//11000011 - Jump
+void Intel_8080_Emulator::unconditionalJump(uint8_t)
+{
+    programCounter = getAddressInDataBytes();
+}
+
+//11001101 - Call
+void Intel_8080_Emulator::unconditionalCall(uint8_t)
+{
+    call();
+}
+
+//11001001 - Return
+void Intel_8080_Emulator::unconditionalReturn(uint8_t)
+{
+    ret();
+}
+
+//11101001 - Jump H and L indirect - move H and L to Program Counter
+void Intel_8080_Emulator::jumpHLIndirect(uint8_t)
+{
+    programCounter = registers.getValueFromRegisterPair(RegisterManager::RegisterPair::HL);
+}
+
+//11110101 - Push processor status word
+void Intel_8080_Emulator::pushProcessorStatusWord(uint8_t)
+{
+    uint16_t sp = registers.getValueFromRegisterPair(RegisterManager::RegisterPair::SP);
+    
+    writeMemory(--sp, registers.getRegisterValue(RegisterManager::Register::A));
+    writeMemory(--sp, alu.createStatusByte());
+    
+    registers.setRegisterPair(RegisterManager::RegisterPair::SP, sp);
+    ++programCounter;
+}
+
+//11110001 - Pop processor status word
+void Intel_8080_Emulator::popProcessorStatusWord(uint8_t)
+{
+    uint16_t sp = registers.getValueFromRegisterPair(RegisterManager::RegisterPair::SP);
+    
+    alu.setFromStatusByte(readMemory(sp++));
+    registers.setRegisterValue(RegisterManager::Register::A, readMemory(sp++));
+    
+    registers.setRegisterPair(RegisterManager::RegisterPair::SP, sp);
+    ++programCounter;
+}
+
+//11100011 - Exchange stack top with H and L
+void Intel_8080_Emulator::exchangeStackTopWithHL(uint8_t)
+{
+    const uint16_t stackVal = registers.getValueFromRegisterPair(RegisterManager::RegisterPair::SP);
+    
+    const uint8_t firstStackVal = readMemory(stackVal);
+    const uint8_t secondStackVal = readMemory(stackVal + 1);
+    
+    const uint8_t lVal = registers.getRegisterValue(RegisterManager::Register::L);
+    const uint8_t hVal = registers.getRegisterValue(RegisterManager::Register::H);
+    
+    writeMemory(stackVal, lVal);
+    writeMemory(stackVal + 1, hVal);
+    
+    registers.setRegisterValue(RegisterManager::Register::L, firstStackVal);
+    registers.setRegisterValue(RegisterManager::Register::H, secondStackVal);
+    
+    ++programCounter;
 }
 
-RegisterManager::Register Intel_8080_Emulator::getFirstRegister(uint8_t opcode) const
+//11111001 - Move HL to SP
+void Intel_8080_Emulator::moveHLToSP(uint8_t)
 {
-    uint8_t regIndex = (opcode & 0x38) >> 3;
+    registers.setRegisterPair(RegisterManager::RegisterPair::SP, registers.getValueFromRegisterPair(RegisterManager::RegisterPair::HL));
     
-    if(const auto reg = RegisterManager::getRegFromEncodedValue(regIndex); reg)
+    ++programCounter;
+}
+
+//11111011 - Enable Interrupts
+void Intel_8080_Emulator::enableInterrupts(uint8_t)
+{
+    interrupts = true;
+    ++programCounter;
+}
+
+//11110011 - Disable Interrupts
+void Intel_8080_Emulator::disableInterrupts(uint8_t)
+{
+    interrupts = false;
+    ++programCounter;
+}
+
+//11CCC010 - Conditional Jump
+void Intel_8080_Emulator::conditionalJump(uint8_t)
+{
+    if(checkCurrentCondition())
+    {
+        programCounter = getAddressInDataBytes();
+    }
+    else
+    {
+        programCounter += 3;
+    }
+}
+
+//11CCC100 - Conditional Call
+void Intel_8080_Emulator::conditionalCall(uint8_t)
+{
+    if(checkCurrentCondition())
+    {
+        cycleCount += takenBranchExtraCycles;
+        call();
+    }
+    else
+    {
+        programCounter += 3;
+    }
+}
+
+//11CCC000 - Conditional Return
+void Intel_8080_Emulator::conditionalReturn(uint8_t)
+{
+    if(checkCurrentCondition())
+    {
+        cycleCount += takenBranchExtraCycles;
+        ret();
+    }
+    else
     {
-        return *reg;
+        ++programCounter;
     }
+}
+
+//11NNN111 - Restart
+void Intel_8080_Emulator::restart(uint8_t opcode)
+{
+    pushToStack(programCounter + 1);
+    
+    uint8_t restartNumber = (opcode & 0x38) >> 3;
+    programCounter = restartNumber * 8;
+}
+
+//11RP0101 - Push
+void Intel_8080_Emulator::push(uint8_t)
+{
+    pushToStack(registers.getValueFromRegisterPair(getRegisterPair()));
+    ++programCounter;
+}
+
+//11RP0001 - Pop
+void Intel_8080_Emulator::pop(uint8_t)
+{
+    uint16_t sp = registers.getValueFromRegisterPair(RegisterManager::RegisterPair::SP);
+    
+    registers.setRegisterPair(getRegisterPair(), readMemory(sp + 1), readMemory(sp));
     
-    assert(false);
-    return RegisterManager::Register::A;
+    sp += 2;
+    registers.setRegisterPair(RegisterManager::RegisterPair::SP, sp);
+    ++programCounter;
 }
 
-RegisterManager::Register Intel_8080_Emulator::getSecondRegister(uint8_t opcode) const
+//01DDD110 00100011 - Move from memory, Increment H and L
+void Intel_8080_Emulator::moveFromMemoryIncrementHL(uint8_t opcode)
 {
-    uint8_t regIndex =  opcode & 0x7;
+    moveFromMemory(opcode);
     
-    if(const auto reg = RegisterManager::getRegFromEncodedValue(regIndex); reg)
+    if(continueFusion(0x23))
     {
-        return *reg;
+        registers.setRegisterPair(RegisterManager::RegisterPair::HL, registers.getValueFromRegisterPair(RegisterManager::RegisterPair::HL) + 1);
+        ++programCounter;
     }
+}
+
+//00DDD101 11000010 - Decrement Register, Jump if not zero
+void Intel_8080_Emulator::decrementJumpNotZero(uint8_t opcode)
+{
+    const RegisterManager::Register counter = getFirstRegister();
     
-    assert(false);
-    return RegisterManager::Register::A;
+    decrementRegister(opcode);
+    
+    //The decremented value already says whether the jump is taken, so the zero flag isn't worked out again
+    if(continueFusion(0xC2))
+    {
+        programCounter = registers.getRegisterValue(counter) != 0 ? getAddressInDataBytes() : programCounter + 3;
+    }
 }
 
-RegisterManager::RegisterPair Intel_8080_Emulator::getRegisterPair(uint8_t opcode) const
+//00RP1010 01110111 00100011 00RP0011 - Load accumulator indirect, Move to memory, Increment H and L, Increment the source pair
+void Intel_8080_Emulator::copyIndirectToMemory(uint8_t opcode)
 {
-    uint8_t pairIndex = (opcode & 0x30) >> 4;
+    loadAccumulatorIndirect(opcode);
+    
+    //Checked one at a time as the store could have written over the instructions after it
+    if(!continueFusion(0x77))
+    {
+        return;
+    }
+    
+    moveToMemory(0x77);
+    
+    if(!continueFusion(0x23))
+    {
+        return;
+    }
     
-    return RegisterManager::getPairFromEncodedValue(pairIndex);
+    registers.setRegisterPair(RegisterManager::RegisterPair::HL, registers.getValueFromRegisterPair(RegisterManager::RegisterPair::HL) + 1);
+    ++programCounter;
+    
+    if(const uint8_t increment = (opcode & 0x30) | 0x03; continueFusion(increment))
+    {
+        incrementRegisterPair(increment);
+    }
 }
 
-uint16_t Intel_8080_Emulator::getAddressInDataBytes() const
+//11RP0101 11RP0001 - Push, Pop
+void Intel_8080_Emulator::pushPop(uint8_t opcode)
 {
-    uint8_t lowOrderAddrData = memory[programCounter + 1];
-    uint8_t highOrderAddrData = memory[programCounter + 2];
+    const uint16_t value = registers.getValueFromRegisterPair(getRegisterPair());
     
-    return highOrderAddrData << 8 | lowOrderAddrData;
+    push(opcode);
+    
+    //POP PSW has its own handler
+    if(const uint8_t next = readMemory(programCounter); (next & 0xCF) == 0xC1 && next != 0xF1 && continueFusion(next))
+    {
+        const uint16_t sp = registers.getValueFromRegisterPair(RegisterManager::RegisterPair::SP);
+        
+        //The pop gets back what was pushed, unless the stack is somewhere writes don't stick
+        if(memoryBus.isWritable(sp >> 8) && memoryBus.isWritable(uint16_t(sp + 1) >> 8))
+        {
+            registers.setRegisterPair(getRegisterPair(), value);
+            registers.setRegisterPair(RegisterManager::RegisterPair::SP, sp + 2);
+            ++programCounter;
+        }
+        else
+        {
+            pop(next);
+        }
+    }
 }
 
-bool Intel_8080_Emulator::checkCurrentCondition() const
+bool Intel_8080_Emulator::continueFusion(uint8_t opcode)
 {
-    uint8_t conditionVal = (currentOpcode & 0x38) >> 3;
+    if(cycleCount >= currentStopCycle)
+    {
+        return false;
+    }
     
-    switch(conditionVal & 0x7)
+    if(const DecodedInstruction& next = decode(programCounter); next.opcode == opcode)
     {
-        case 0x0:
-            return !alu.getFlag(ALU::Flag::Zero);
-            
-        case 0x1:
-            return alu.getFlag(ALU::Flag::Zero);
-            
-        case 0x2:
-            return !alu.getFlag(ALU::Flag::Carry);
-            
-        case 0x3:
-            return alu.getFlag(ALU::Flag::Carry);
-            
-        case 0x4:
-            return !alu.getFlag(ALU::Flag::Parity);
-            
-        case 0x5:
-            return alu.getFlag(ALU::Flag::Parity);
-            
-        case 0x6:
-            return !alu.getFlag(ALU::Flag::Sign);
-            
-        case 0x7:
-            return alu.getFlag(ALU::Flag::Sign);
+        currentInstruction = &next;
+    }
+    else
+    {
+        return false;
     }
     
-    return false;
+    ++opCounter;
+    cycleCount += opCycles[opcode];
+    currentOpcode = opcode;
+    
+    return true;
 }
 
-void Intel_8080_Emulator::call()
+void Intel_8080_Emulator::profileOpcode(uint8_t opcode)
 {
-    uint16_t sp = registers.getValueFromRegisterPair(RegisterManager::RegisterPair::SP);
-    
-    uint16_t nextInstructionPos = programCounter + 3;
+    profile->record(previousOpcode, opcode);
+    previousOpcode = opcode;
     
-    memory[--sp] = nextInstructionPos >> 8;
-    memory[--sp] = nextInstructionPos;
+    (this->*(*machineOpTable)[opcode])(opcode);
+}
+
+void Intel_8080_Emulator::dispatchBySwitch(uint8_t opcode)
+{
+    const OpHandler handler = decodeOpHandler(opcode);
     
-    registers.setRegisterPair(RegisterManager::RegisterPair::SP, sp);
+    (this->*(handler != nullptr ? handler : (*machineOpTable)[opcode]))(opcode);
+}
+
+
+RegisterManager::Register Intel_8080_Emulator::getFirstRegister() const
+{
+    return currentInstruction->firstRegister;
+}
+
+RegisterManager::Register Intel_8080_Emulator::getSecondRegister() const
+{
+    return currentInstruction->secondRegister;
+}
+
+RegisterManager::RegisterPair Intel_8080_Emulator::getRegisterPair() const
+{
+    return currentInstruction->registerPair;
+}
+
+uint8_t Intel_8080_Emulator::getDataByte() const
+{
+    return currentInstruction->immediate & 0xFF;
+}
+
+uint16_t Intel_8080_Emulator::getAddressInDataBytes() const
+{
+    return currentInstruction->immediate;
+}
+
+bool Intel_8080_Emulator::checkCurrentCondition() const
+{
+    return alu.getFlag(currentInstruction->conditionFlag) == currentInstruction->conditionValue;
+}
+
+void Intel_8080_Emulator::call()
+{
+    pushToStack(programCounter + 3);
     
     programCounter = getAddressInDataBytes();
 }
@@ -1153,20 +1944,30 @@ void Intel_8080_Emulator::ret()
 {
     const uint16_t sp = registers.getValueFromRegisterPair(RegisterManager::RegisterPair::SP);
     
-    programCounter = (memory[sp + 1] << 8) | memory[sp];
+    programCounter = (readMemory(sp + 1) << 8) | readMemory(sp);
     
     registers.setRegisterPair(RegisterManager::RegisterPair::SP, sp + 2);
 }
 
-std::string Intel_8080_Emulator::getCurrentOpName() const
+void Intel_8080_Emulator::pushToStack(uint16_t value)
+{
+    uint16_t sp = registers.getValueFromRegisterPair(RegisterManager::RegisterPair::SP);
+    
+    writeMemory(--sp, value >> 8);
+    writeMemory(--sp, value);
+    
+    registers.setRegisterPair(RegisterManager::RegisterPair::SP, sp);
+}
+
+std::string Intel_8080_Emulator::getOpName(uint8_t opcode)
 {
     //Check first two bits
-    switch(currentOpcode & 0xc0)
+    switch(opcode & 0xc0)
     {
         //00
         case 0x00:
             
-            switch(currentOpcode & 0xFF)
+            switch(opcode & 0xFF)
             {
                 //00110110 - Move to memory immediate
                 case 0x36:
@@ -1228,8 +2029,9 @@ std::string Intel_8080_Emulator::getCurrentOpName() const
                 case 0x37:
                     return "Set carry";
                     
-                //00000000 - No Op
+                //00000000 - No Op, 00NNN000 are undocumented copies of it
                 case 0x0:
+                case 0x08: case 0x10: case 0x18: case 0x20: case 0x28: case 0x30: case 0x38:
                     return "No Op";
                     
                 default:
@@ -1237,7 +2039,7 @@ std::string Intel_8080_Emulator::getCurrentOpName() const
             }
             
             //Look at last 4 bits
-            switch(currentOpcode & 0xCF)
+            switch(opcode & 0xCF)
             {
                 //00RP0001 - Load Register Pair Immediate
                 case 0x1:
@@ -1265,7 +2067,7 @@ std::string Intel_8080_Emulator::getCurrentOpName() const
             }
             
             //Look at the last 3 bits
-            switch(currentOpcode & 0xC7)
+            switch(opcode & 0xC7)
             {
                 //00DDD110 - Move Immediate
                 case 0x6:
@@ -1281,19 +2083,21 @@ std::string Intel_8080_Emulator::getCurrentOpName() const
                     
             }
             
+            break;
+            
         //01
         case 0x40:
             
             //01110110 - Halt
-            if((currentOpcode & 0xFF) == 0x76)
+            if((opcode & 0xFF) == 0x76)
                 return "Halt";
             
             //01DDD110 - Move from memory
-            if((currentOpcode & 0x7) == 0x6)
+            if((opcode & 0x7) == 0x6)
                 return "Move from memory";
             
             //01110SSS - Move to memory
-            else if((currentOpcode & 0xF8) == 0x70)
+            else if((opcode & 0xF8) == 0x70)
                 return "Move to memory";
             
             //01DDDSSS - Move register
@@ -1305,7 +2109,7 @@ std::string Intel_8080_Emulator::getCurrentOpName() const
         //10
         case 0x80:
             
-            switch (currentOpcode & 0xFF)
+            switch (opcode & 0xFF)
             {
                 //10000110 - Add Memory
                 case 0x86:
@@ -1344,7 +2148,7 @@ std::string Intel_8080_Emulator::getCurrentOpName() const
             }
             
             //Look at the first 5 bits
-            switch(currentOpcode & 0xF8)
+            switch(opcode & 0xF8)
             {
                 //10000SSS - Add Register
                 case 0x80:
@@ -1386,7 +2190,7 @@ std::string Intel_8080_Emulator::getCurrentOpName() const
         //11
         case 0xc0:
             
-            switch (currentOpcode & 0xFF)
+            switch (opcode & 0xFF)
             {
                 //11000110 - Add Immediate
                 case 0xC6:
@@ -1424,16 +2228,19 @@ std::string Intel_8080_Emulator::getCurrentOpName() const
                 case 0xFE:
                     return "Compare immediate";
                     
-                //11000011 - Jump
+                //11000011 - Jump, 11001011 is an undocumented copy
                 case 0xC3:
+                case 0xCB:
                     return "Jump";
                     
-                //11001101 - Call
+                //11001101 - Call, 11011101, 11101101 and 11111101 are undocumented copies
                 case 0xCD:
+                case 0xDD: case 0xED: case 0xFD:
                     return "Call";
                     
-                //11001001 - Return
+                //11001001 - Return, 11011001 is an undocumented copy
                 case 0xC9:
+                case 0xD9:
                     return "Return";
                     
                 //11101001 - Jump H and L indirect - move H and L to Program Counter
@@ -1477,7 +2284,7 @@ std::string Intel_8080_Emulator::getCurrentOpName() const
             }
             
             //Check last 3 bits
-            switch (currentOpcode & 0x7)
+            switch (opcode & 0x7)
             {
                 //11CCC010 - Conditional Jump
                 case 0x2:
@@ -1500,7 +2307,7 @@ std::string Intel_8080_Emulator::getCurrentOpName() const
             }
             
         //Check the last 4 bits
-        switch (currentOpcode & 0xF)
+        switch (opcode & 0xF)
         {
             //11RP0101 - Push
             case 0x5:
@@ -1517,63 +2324,3 @@ std::string Intel_8080_Emulator::getCurrentOpName() const
     
     return "Unrecognised Op";
 }
-
-std::string Intel_8080_Emulator::getCurrentConditionName() const
-{
-    uint8_t conditionVal = (currentOpcode & 0x38) >> 3;
-    
-    switch(conditionVal & 0x7)
-    {
-        case 0x0:
-            return "Not Zero";
-            
-        case 0x1:
-            return "Zero";
-            
-        case 0x2:
-            return "No Carry";
-            
-        case 0x3:
-            return "Carry";
-            
-        case 0x4:
-            return "Parity Odd";
-            
-        case 0x5:
-            return "Parity Even";
-            
-        case 0x6:
-            return "Plus";
-            
-        case 0x7:
-            return "Minus";
-    }
-    
-    return "";
-}
-
-std::string Intel_8080_Emulator::getFlagValuesStr() const
-{
-    std::stringstream strm;
-    
-    strm << "Z: " << int(alu.getFlag(ALU::Flag::Zero)) << ", S: " << int(alu.getFlag(ALU::Flag::Sign)) << ", P: " << int(alu.getFlag(ALU::Flag::Parity)) << ", C: " << int(alu.getFlag(ALU::Flag::Carry)) << ", AC: " << int(alu.getFlag(ALU::Flag::AuxillaryCarry));
-    
-    return strm.str();
-}
-
-std::string Intel_8080_Emulator::getCurrentRegValuesStr() const
-{
-    std::stringstream strm;
-    
-    strm << "B: " << int(registers.getRegisterValue(RegisterManager::Register::B)) <<
-          ", C: " << int(registers.getRegisterValue(RegisterManager::Register::C)) <<
-          ", D: " << int(registers.getRegisterValue(RegisterManager::Register::D)) <<
-          ", E: " << int(registers.getRegisterValue(RegisterManager::Register::E)) <<
-          ", H: " << int(registers.getRegisterValue(RegisterManager::Register::H)) <<
-          ", L: " << int(registers.getRegisterValue(RegisterManager::Register::L)) <<
-          ", W: " << int(registers.getRegisterValue(RegisterManager::Register::W)) <<
-          ", Z: " << int(registers.getRegisterValue(RegisterManager::Register::Z)) <<
-          ", A: " << int(registers.getRegisterValue(RegisterManager::Register::A));
-    
-    return strm.str();
-}
@@ -7,40 +7,283 @@
 
 #pragma once
 
+#include <bitset>
 #include <cstdint>
+#include <memory>
+#include <span>
 #include <vector>
 #include "RegisterManager.hpp"
 #include "ALU.hpp"
+#include "DynamicRecompiler.hpp"
+#include "MemoryBus.hpp"
+#include "OpcodeProfile.hpp"
+#include "Snapshot.hpp"
 #include <stack>
 #include <sstream>
 
+class RecompiledProgram;
+
+template<typename Machine, typename Instrumentation>
+class Intel_8080_Machine;
+
+//The CPU on its own, machines derive from Intel_8080_Machine to connect it to their I/O
 class Intel_8080_Emulator
 {
+    friend class DynamicRecompiler;
+    friend class RecompiledProgram;
+    friend class TimeTravelDebugger;
+    friend class LockstepInterpreter;
+    
+    template<typename Machine, typename Instrumentation>
+    friend class Intel_8080_Machine;
+    
 public:
-    Intel_8080_Emulator();
     virtual ~Intel_8080_Emulator();
     
-    static constexpr bool debugMode = false;
+    //Clock speed of the 8080 in Hz
+    static constexpr uint64_t clockSpeed = 2000000;
+    
+    //Readable name of the instruction an opcode decodes to
+    static std::string getOpName(uint8_t opcode);
     
 protected:
+    using OpHandler = void (Intel_8080_Emulator::*)(uint8_t opcode);
+    
+    //The table has every opcode's handler, including the machine's own ones for IN and OUT
+    //An instrumented table has to see every instruction, so nothing that runs them any other way can be turned on
+    Intel_8080_Emulator(const std::array<OpHandler, 256>& machineTable, bool instrumented);
+    
     void runCycle();
     void performInterrupt(uint8_t opcode);
     
-    std::array<uint8_t, 65535> memory;
+    //Runs instructions until at least the given number of cycles have passed, returns the number of cycles actually run
+    uint64_t runFor(uint64_t cycles);
+    
+    //Runs one instruction through the interpreter and then any events it brought due, stopping where runFor would between instructions
+    //A halted CPU idles to the next event instead, returns false if there isn't one to wake it
+    bool step();
+    
+    uint64_t getCycleCount() const;
+    uint64_t getInstructionCount() const;
     
+    //Calls handleEvent with the given id once the cycle count reaches the given cycle. Events due on the same cycle run in the order they were scheduled
+    void scheduleEvent(uint64_t cycle, uint8_t eventId);
+    
+    //Copies everything that decides how the machine carries on from here into the snapshot, including the machine's own state
+    void snapshot(Snapshot& snapshot) const;
+    
+    //Puts back a snapshot taken from a machine of the same kind, with the same memory map
+    //Only pages that differ are copied, and anything decoded or translated from them is thrown away
+    void restore(const Snapshot& snapshot);
+    
+    //Runs translated blocks of native code instead of interpreting, returns false if it isn't available on this host
+    bool setRecompilerEnabled(bool enabled);
+    
+    //Runs the blocks of a ROM translated ahead of time instead of interpreting them, pass nullptr to stop
+    //Returns false if the ROM in memory isn't the one the blocks were generated from
+    bool setRecompiledProgram(const RecompiledProgram* program);
+    
+    //Counts every pair of instructions the interpreter runs into the given profile, pass nullptr to stop
+    void setProfile(OpcodeProfile* profile);
+    
+    //Works out each instruction's handler by walking the opcode switches every time it runs, the way the interpreter used to,
+    //instead of looking it up in the table. Only for measuring the table against it, returns false for an instrumented machine
+    bool setSwitchDispatch(bool enabled);
+    
+    //Runs the instruction sequences that make up at least minimumShare of the profile as single handlers, pass nullptr to stop
+    //Returns the number of sequences fused
+    int setFusions(const OpcodeProfile* profile, double minimumShare = 0.001);
+    
+private:
+    //Registers, flags and program counter are declared together so they share a cache line
+    alignas(64) RegisterManager registers;
+    ALU alu;
+    
+protected:
     uint16_t programCounter;
     
+    //Set up by the machine before anything runs, loads have to go through loadMemory
+    MemoryBus memoryBus;
+    
+    uint8_t readMemory(uint16_t address) const;
+    
+    //For machines that look at the registers, like a system call handler
+    const RegisterManager& getRegisters() const;
+    
+    //Copies data in behind the bus, so ROM can be loaded, and throws away anything decoded or translated from what it replaces
+    bool loadMemory(uint16_t address, std::span<const uint8_t> data);
+    
 private:
-    virtual uint8_t inputOperation(uint8_t port)=0;
-    virtual void outputOperation(uint8_t port, uint8_t value)=0;
+    virtual void handleEvent(uint8_t eventId, uint64_t dueCycle);
+    
+    //Anything the machine keeps that snapshots need, like the state behind its I/O ports. Restore is given what save wrote
+    //It is written into snapshot files, so changing it means bumping Snapshot::formatVersion
+    virtual void saveMachineState(std::vector<uint8_t>& state) const;
+    virtual void restoreMachineState(std::span<const uint8_t> state);
+    
+    void runDueEvents();
     
     void fetch();
     void decodeAndExecute(uint8_t opcode);
     
-    RegisterManager::Register getFirstRegister(uint8_t opcode) const;
-    RegisterManager::Register getSecondRegister(uint8_t opcode) const;
-    RegisterManager::RegisterPair getRegisterPair(uint8_t opcode) const;
+    //Everything an instruction needs from its bytes, worked out the first time it runs and kept until one of them is written to
+    struct DecodedInstruction
+    {
+        //The handler from the table that was active when it was decoded, every record is thrown away when that changes
+        OpHandler handler;
+        
+        //Bytes past the length aren't read, immediate is zero in them
+        uint16_t immediate;
+        uint8_t opcode;
+        uint8_t length;
+        RegisterManager::Register firstRegister;
+        RegisterManager::Register secondRegister;
+        RegisterManager::RegisterPair registerPair;
+        
+        //Conditional instructions are taken when conditionFlag is set to conditionValue
+        ALU::Flag conditionFlag;
+        bool conditionValue;
+        
+        bool valid;
+    };
+    
+    const DecodedInstruction& decode(uint16_t address);
+    void decodeInto(uint16_t address);
+    
+    //All stores go through here so writes to translated code and memory shared with snapshots can be tracked
+    void writeMemory(uint16_t address, uint8_t value);
+    
+    //Throws away anything decoded or translated from the byte at the given address, or any other address mapped to it
+    void invalidateCode(uint16_t address);
+    void invalidateAddress(uint16_t address);
+    void invalidatePage(uint8_t page);
+    void markProgramPages();
+    
+    //Sets watchedAddressWritten whenever the byte at the address is written, through any address mapped to it
+    //Returns false if it isn't RAM or ROM. Stopping puts the pages back to how they were watched before
+    bool watchWrites(uint16_t address);
+    void stopWatchingWrites();
+
+    //Maps every opcode straight to its handler, built once at startup. IN and OUT are left for the machine
+    static std::array<OpHandler, 256> buildOpTable();
+    static const std::array<OpHandler, 256> opTable;
+    
+    //Every opcode goes through profileOpcode
+    static std::array<OpHandler, 256> buildProfilingOpTable();
+    static const std::array<OpHandler, 256> profilingOpTable;
+    
+    //Every opcode goes through dispatchBySwitch
+    static std::array<OpHandler, 256> buildSwitchOpTable();
+    static const std::array<OpHandler, 256> switchOpTable;
+    
+    //The handler an opcode decodes to, or nullptr for IN and OUT, which are the machine's
+    static OpHandler decodeOpHandler(uint8_t opcode);
     
+    //A sequence of instructions run by one handler, starting with an opcode using headHandler then one matching nextMask and nextValue using nextHandler
+    struct FusionPattern
+    {
+        OpHandler headHandler;
+        OpHandler nextHandler;
+        uint8_t nextMask;
+        uint8_t nextValue;
+        OpHandler fusedHandler;
+    };
+    
+    static const std::array<FusionPattern, 4> fusionPatterns;
+    
+    //runCycle goes through the profiling table while profiling, otherwise the fused one if there is one
+    void updateActiveOpTable();
+
+    //Instruction handlers
+    void moveToMemoryImmediate(uint8_t opcode);
+    void loadAccumulatorDirect(uint8_t opcode);
+    void storeAccumulatorDirect(uint8_t opcode);
+    void loadHLDirect(uint8_t opcode);
+    void storeHLDirect(uint8_t opcode);
+    void incrementMemory(uint8_t opcode);
+    void decrementMemory(uint8_t opcode);
+    void decimalAdjustAccumulator(uint8_t opcode);
+    void rotateLeft(uint8_t opcode);
+    void rotateRight(uint8_t opcode);
+    void rotateLeftThroughCarry(uint8_t opcode);
+    void rotateRightThroughCarry(uint8_t opcode);
+    void complementAccumulator(uint8_t opcode);
+    void complementCarry(uint8_t opcode);
+    void setCarry(uint8_t opcode);
+    void noOp(uint8_t opcode);
+    void loadRegisterPairImmediate(uint8_t opcode);
+    void loadAccumulatorIndirect(uint8_t opcode);
+    void storeAccumulatorIndirect(uint8_t opcode);
+    void incrementRegisterPair(uint8_t opcode);
+    void decrementRegisterPair(uint8_t opcode);
+    void addRegisterPairToHL(uint8_t opcode);
+    void moveImmediate(uint8_t opcode);
+    void incrementRegister(uint8_t opcode);
+    void decrementRegister(uint8_t opcode);
+    void halt(uint8_t opcode);
+    void moveFromMemory(uint8_t opcode);
+    void moveToMemory(uint8_t opcode);
+    void moveRegister(uint8_t opcode);
+    void addMemory(uint8_t opcode);
+    void addMemoryWithCarry(uint8_t opcode);
+    void subtractMemory(uint8_t opcode);
+    void subtractMemoryWithBorrow(uint8_t opcode);
+    void andMemory(uint8_t opcode);
+    void xorMemory(uint8_t opcode);
+    void orMemory(uint8_t opcode);
+    void compareMemory(uint8_t opcode);
+    void addRegister(uint8_t opcode);
+    void addRegisterWithCarry(uint8_t opcode);
+    void subtractRegister(uint8_t opcode);
+    void subtractRegisterWithBorrow(uint8_t opcode);
+    void andRegister(uint8_t opcode);
+    void xorRegister(uint8_t opcode);
+    void orRegister(uint8_t opcode);
+    void compareRegister(uint8_t opcode);
+    void addImmediate(uint8_t opcode);
+    void addImmediateWithCarry(uint8_t opcode);
+    void exchangeHLWithDE(uint8_t opcode);
+    void subtractImmediate(uint8_t opcode);
+    void subtractImmediateWithBorrow(uint8_t opcode);
+    void andImmediate(uint8_t opcode);
+    void xorImmediate(uint8_t opcode);
+    void orImmediate(uint8_t opcode);
+    void compareImmediate(uint8_t opcode);
+    void unconditionalJump(uint8_t opcode);
+    void unconditionalCall(uint8_t opcode);
+    void unconditionalReturn(uint8_t opcode);
+    void jumpHLIndirect(uint8_t opcode);
+    void pushProcessorStatusWord(uint8_t opcode);
+    void popProcessorStatusWord(uint8_t opcode);
+    void exchangeStackTopWithHL(uint8_t opcode);
+    void moveHLToSP(uint8_t opcode);
+    void enableInterrupts(uint8_t opcode);
+    void disableInterrupts(uint8_t opcode);
+    void conditionalJump(uint8_t opcode);
+    void conditionalCall(uint8_t opcode);
+    void conditionalReturn(uint8_t opcode);
+    void restart(uint8_t opcode);
+    void push(uint8_t opcode);
+    void pop(uint8_t opcode);
+    
+    //Fused handlers, each runs its first instruction then carries on through the rest for as long as they match
+    void moveFromMemoryIncrementHL(uint8_t opcode);
+    void decrementJumpNotZero(uint8_t opcode);
+    void copyIndirectToMemory(uint8_t opcode);
+    void pushPop(uint8_t opcode);
+    
+    //Moves on to the next instruction if it is the given opcode and the ones already run haven't reached the stop cycle
+    bool continueFusion(uint8_t opcode);
+    
+    void profileOpcode(uint8_t opcode);
+    void dispatchBySwitch(uint8_t opcode);
+
+    //Operands of the instruction being run, from its decoded record
+    RegisterManager::Register getFirstRegister() const;
+    RegisterManager::Register getSecondRegister() const;
+    RegisterManager::RegisterPair getRegisterPair() const;
+    
+    uint8_t getDataByte() const;
     uint16_t getAddressInDataBytes() const;
     
     bool checkCurrentCondition() const;
@@ -48,18 +291,127 @@ private:
     void call();
     void ret();
     
-    std::string getCurrentOpName() const;
-    std::string getCurrentConditionName() const;
-    std::string getFlagValuesStr() const;
-    std::string getCurrentRegValuesStr() const;
+    void pushToStack(uint16_t value);
     
     uint8_t currentOpcode;
+    const DecodedInstruction* currentInstruction = nullptr;
     
-    RegisterManager registers;
-    ALU alu;
+    //One record per address, the pages holding valid ones are watched on the memory bus so writes can invalidate them
+    std::vector<DecodedInstruction> decodedInstructions;
+    
+    //Number of states taken by each opcode. Conditional calls and returns add takenBranchExtraCycles when taken
+    static constexpr std::array<uint8_t, 256> opCycles
+    {
+        4, 10, 7,  5,  5,  5,  7,  4,  4,  10, 7,  5,  5,  5,  7,  4,   //0x00
+        4, 10, 7,  5,  5,  5,  7,  4,  4,  10, 7,  5,  5,  5,  7,  4,   //0x10
+        4, 10, 16, 5,  5,  5,  7,  4,  4,  10, 16, 5,  5,  5,  7,  4,   //0x20
+        4, 10, 13, 5,  10, 10, 10, 4,  4,  10, 13, 5,  5,  5,  7,  4,   //0x30
+        5, 5,  5,  5,  5,  5,  7,  5,  5,  5,  5,  5,  5,  5,  7,  5,   //0x40
+        5, 5,  5,  5,  5,  5,  7,  5,  5,  5,  5,  5,  5,  5,  7,  5,   //0x50
+        5, 5,  5,  5,  5,  5,  7,  5,  5,  5,  5,  5,  5,  5,  7,  5,   //0x60
+        7, 7,  7,  7,  7,  7,  7,  7,  5,  5,  5,  5,  5,  5,  7,  5,   //0x70
+        4, 4,  4,  4,  4,  4,  7,  4,  4,  4,  4,  4,  4,  4,  7,  4,   //0x80
+        4, 4,  4,  4,  4,  4,  7,  4,  4,  4,  4,  4,  4,  4,  7,  4,   //0x90
+        4, 4,  4,  4,  4,  4,  7,  4,  4,  4,  4,  4,  4,  4,  7,  4,   //0xA0
+        4, 4,  4,  4,  4,  4,  7,  4,  4,  4,  4,  4,  4,  4,  7,  4,   //0xB0
+        5, 10, 10, 10, 11, 11, 7,  11, 5,  10, 10, 10, 11, 17, 7,  11,  //0xC0
+        5, 10, 10, 10, 11, 11, 7,  11, 5,  10, 10, 10, 11, 17, 7,  11,  //0xD0
+        5, 10, 10, 18, 11, 11, 7,  11, 5,  5,  10, 4,  11, 17, 7,  11,  //0xE0
+        5, 10, 10, 4,  11, 11, 7,  11, 5,  5,  10, 4,  11, 17, 7,  11   //0xF0
+    };
+    
+    static constexpr uint8_t takenBranchExtraCycles = 6;
+    static constexpr uint8_t interruptCycles = 11;
+    
+    uint64_t cycleCount = 0;
+    
+    struct ScheduledEvent
+    {
+        uint64_t cycle;
+        uint8_t eventId;
+    };
+    
+    //Kept latest first so the next event due is always at the back
+    std::vector<ScheduledEvent> scheduledEvents;
+    
+    //Storage as of the last snapshot taken or restored, which the next snapshot shares for every page not written since
+    //Kept up to date by snapshot, so has to be mutable
+    mutable std::array<std::shared_ptr<const Snapshot::Page>, MemoryBus::pageCount> snapshotPages;
+    mutable std::bitset<MemoryBus::pageCount> writtenPages;
+    
+    std::unique_ptr<DynamicRecompiler> recompiler;
+    const RecompiledProgram* recompiledProgram = nullptr;
+    
+    //opTable with the machine's I/O handlers, the one everything else is built from
+    const std::array<OpHandler, 256>* machineOpTable;
+    const bool instrumented;
+    
+    const std::array<OpHandler, 256>* activeOpTable;
+    std::unique_ptr<std::array<OpHandler, 256>> fusedOpTable;
+    
+    //Fused handlers stop at the same instruction boundary the interpreter would, outside runFor they never carry on
+    uint64_t currentStopCycle = 0;
+    
+    OpcodeProfile* profile = nullptr;
+    uint8_t previousOpcode = 0x0;
+    
+    bool switchDispatch = false;
+    
+    //Set when a write has thrown away translated code, so the running block knows to stop
+    bool codeModified = false;
+    
+    //Where in storage the byte being watched is, or -1
+    int watchedStorageAddress = -1;
+    bool watchedAddressWritten = false;
+    
+    //The address given to watchWrites, and whether its page was already being watched for code
+    uint16_t watchedAddress = 0;
+    bool watchedPageWasWatched = false;
     
     bool haltFlag = false;
     bool interrupts = false;
     
     uint64_t opCounter = 0;
 };
+
+inline const RegisterManager& Intel_8080_Emulator::getRegisters() const
+{
+    return registers;
+}
+
+inline uint8_t Intel_8080_Emulator::readMemory(uint16_t address) const
+{
+    return memoryBus.read(address);
+}
+
+inline void Intel_8080_Emulator::writeMemory(uint16_t address, uint8_t value)
+{
+    const int storageAddress = memoryBus.getStorageAddress(address);
+    
+    //Pages code has been read from are watched, so only writes to them come back as needing to invalidate it
+    if(memoryBus.write(address, value))
+    {
+        invalidateCode(address);
+        
+        //A byte with its writes watched is always on a watched page, so it is only looked for here
+        if(storageAddress == watchedStorageAddress)
+        {
+            watchedAddressWritten = true;
+        }
+    }
+    
+    if(storageAddress >= 0)
+    {
+        writtenPages[storageAddress >> 8] = true;
+    }
+}
+
+inline const Intel_8080_Emulator::DecodedInstruction& Intel_8080_Emulator::decode(uint16_t address)
+{
+    if(!decodedInstructions[address].valid)
+    {
+        decodeInto(address);
+    }
+    
+    return decodedInstructions[address];
+}
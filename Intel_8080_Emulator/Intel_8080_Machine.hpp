@@ -0,0 +1,141 @@
+//
+//  Intel_8080_Machine.hpp
+//  Intel_8080_Emulator
+//
+
+#pragma once
+
+#include "Intel_8080_Emulator.hpp"
+#include "Instrumentation.hpp"
+
+//Base for a machine built around the CPU, derived from as class Machine : public Intel_8080_Machine<Machine>
+//The machine provides these, they can be private if it makes Intel_8080_Machine<Machine> a friend
+//    uint8_t inputOperation(uint8_t port);
+//    void outputOperation(uint8_t port, uint8_t value);
+//IN and OUT call them directly rather than through a vtable, so they can be inlined into the handlers
+//Instrumentation is one of the policies in Instrumentation.hpp, the default leaves the op table exactly as it would be without one
+template<typename Machine, typename Instrumentation = NoInstrumentation>
+class Intel_8080_Machine : public Intel_8080_Emulator
+{
+public:
+    Instrumentation& getInstrumentation();
+    const Instrumentation& getInstrumentation() const;
+    
+protected:
+    Intel_8080_Machine();
+    
+private:
+    //Built the first time one of these machines is made, from the core's table
+    static const std::array<OpHandler, 256>& getMachineOpTable();
+    
+    //Every opcode going through instrumentOpcode first, when the instrumentation is enabled
+    static const std::array<OpHandler, 256>& getOpTable();
+    
+    void instrumentOpcode(uint8_t opcode);
+    
+    void input(uint8_t opcode);
+    void output(uint8_t opcode);
+    
+    Instrumentation instrumentation;
+};
+
+template<typename Machine, typename Instrumentation>
+Intel_8080_Machine<Machine, Instrumentation>::Intel_8080_Machine()  : Intel_8080_Emulator(getOpTable(), Instrumentation::enabled)
+{
+    
+}
+
+template<typename Machine, typename Instrumentation>
+Instrumentation& Intel_8080_Machine<Machine, Instrumentation>::getInstrumentation()
+{
+    return instrumentation;
+}
+
+template<typename Machine, typename Instrumentation>
+const Instrumentation& Intel_8080_Machine<Machine, Instrumentation>::getInstrumentation() const
+{
+    return instrumentation;
+}
+
+template<typename Machine, typename Instrumentation>
+const std::array<Intel_8080_Emulator::OpHandler, 256>& Intel_8080_Machine<Machine, Instrumentation>::getMachineOpTable()
+{
+    static const std::array<OpHandler, 256> machineTable = []()
+    {
+        std::array<OpHandler, 256> table = opTable;
+        
+        //11011011 - Input
+        table[0xDB] = static_cast<OpHandler>(&Intel_8080_Machine::input);
+        
+        //11010011 - Output
+        table[0xD3] = static_cast<OpHandler>(&Intel_8080_Machine::output);
+        
+        return table;
+    }();
+    
+    return machineTable;
+}
+
+template<typename Machine, typename Instrumentation>
+const std::array<Intel_8080_Emulator::OpHandler, 256>& Intel_8080_Machine<Machine, Instrumentation>::getOpTable()
+{
+    if constexpr(Instrumentation::enabled)
+    {
+        static const std::array<OpHandler, 256> instrumentedTable = []()
+        {
+            std::array<OpHandler, 256> table;
+            table.fill(static_cast<OpHandler>(&Intel_8080_Machine::instrumentOpcode));
+            return table;
+        }();
+        
+        return instrumentedTable;
+    }
+    else
+    {
+        return getMachineOpTable();
+    }
+}
+
+template<typename Machine, typename Instrumentation>
+void Intel_8080_Machine<Machine, Instrumentation>::instrumentOpcode(uint8_t opcode)
+{
+    if constexpr(Instrumentation::recordsState)
+    {
+        //runCycle has already added on the instruction's cycles
+        instrumentation.onInstruction(TraceRecord
+        {
+            cycleCount - opCycles[opcode],
+            programCounter,
+            registers.getValueFromRegisterPair(RegisterManager::RegisterPair::SP),
+            registers.getValueFromRegisterPair(RegisterManager::RegisterPair::BC),
+            registers.getValueFromRegisterPair(RegisterManager::RegisterPair::DE),
+            registers.getValueFromRegisterPair(RegisterManager::RegisterPair::HL),
+            registers.getRegisterValue(RegisterManager::Register::A),
+            alu.createStatusByte(),
+            opcode,
+            {uint8_t(currentInstruction->immediate), uint8_t(currentInstruction->immediate >> 8)}
+        });
+    }
+    else
+    {
+        instrumentation.onInstruction(opcode);
+    }
+    
+    (this->*getMachineOpTable()[opcode])(opcode);
+}
+
+//11011011 - Input
+template<typename Machine, typename Instrumentation>
+void Intel_8080_Machine<Machine, Instrumentation>::input(uint8_t)
+{
+    registers.setRegisterValue(RegisterManager::Register::A, static_cast<Machine*>(this)->inputOperation(getDataByte()));
+    programCounter += 2;
+}
+
+//11010011 - Output
+template<typename Machine, typename Instrumentation>
+void Intel_8080_Machine<Machine, Instrumentation>::output(uint8_t)
+{
+    static_cast<Machine*>(this)->outputOperation(getDataByte(), registers.getRegisterValue(RegisterManager::Register::A));
+    programCounter += 2;
+}
@@ -0,0 +1,1293 @@
+//
+//  LockstepInterpreter.cpp
+//  Intel_8080_Emulator
+//
+
+#include "LockstepInterpreter.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <utility>
+
+LockstepInterpreter::LockstepInterpreter(std::span<Intel_8080_Emulator* const> machinesToRun)  : machineCount(machinesToRun.size())
+{
+    assert(machineCount <= laneCount);
+    
+    std::copy(machinesToRun.begin(), machinesToRun.end(), machines.begin());
+    
+    handlers = getHandlerTable();
+    
+    //An opcode any of the machines handle themselves, like IN and OUT, or every one when instrumented, has to go through them
+    for(size_t machine = 0; machine < machineCount; ++machine)
+    {
+        for(int opcode = 0; opcode < 256; ++opcode)
+        {
+            if((*machines[machine]->machineOpTable)[opcode] != Intel_8080_Emulator::opTable[opcode])
+            {
+                handlers[opcode] = nullptr;
+            }
+        }
+    }
+}
+
+void LockstepInterpreter::runFor(std::span<const uint64_t> cycles)
+{
+    assert(cycles.size() == machineCount);
+    
+    findSharedPages();
+    
+    running.fill(0x00);
+    
+    for(size_t lane = 0; lane < machineCount; ++lane)
+    {
+        loadLane(lane);
+        
+        instructionCount -= instructionCounts[lane];
+        
+        endCycles[lane] = cycleCounts[lane] + cycles[lane];
+        
+        //Like runFor, a machine given no cycles doesn't even run the events it has due
+        if(cycles[lane] > 0)
+        {
+            const Intel_8080_Emulator& machine = *machines[lane];
+            
+            stopCycles[lane] = machine.scheduledEvents.empty() ? endCycles[lane] : std::min(endCycles[lane], machine.scheduledEvents.back().cycle);
+            
+            settleLane(lane);
+        }
+    }
+    
+    leader = findNextLeader(laneCount - 1);
+    
+    while(leader >= 0)
+    {
+        step();
+    }
+    
+    for(size_t lane = 0; lane < machineCount; ++lane)
+    {
+        storeLane(lane);
+        
+        instructionCount += instructionCounts[lane];
+    }
+}
+
+size_t LockstepInterpreter::getMachineCount() const
+{
+    return machineCount;
+}
+
+uint64_t LockstepInterpreter::getInstructionCount() const
+{
+    return instructionCount;
+}
+
+uint64_t LockstepInterpreter::getScalarInstructionCount() const
+{
+    return scalarInstructionCount;
+}
+
+uint64_t LockstepInterpreter::getStepCount() const
+{
+    return stepCount;
+}
+
+const std::array<LockstepInterpreter::Handler, 256>& LockstepInterpreter::getHandlerTable()
+{
+    //Built from the core's table the first time it is needed, so opcodes decode exactly the same way
+    static const std::array<Handler, 256> handlerTable = []()
+    {
+        static const std::pair<Intel_8080_Emulator::OpHandler, Handler> equivalents[]
+        {
+            {&Intel_8080_Emulator::noOp, &LockstepInterpreter::noOp},
+            {&Intel_8080_Emulator::loadRegisterPairImmediate, &LockstepInterpreter::loadRegisterPairImmediate},
+            {&Intel_8080_Emulator::incrementRegisterPair, &LockstepInterpreter::incrementRegisterPair},
+            {&Intel_8080_Emulator::decrementRegisterPair, &LockstepInterpreter::decrementRegisterPair},
+            {&Intel_8080_Emulator::addRegisterPairToHL, &LockstepInterpreter::addRegisterPairToHL},
+            {&Intel_8080_Emulator::moveImmediate, &LockstepInterpreter::moveImmediate},
+            {&Intel_8080_Emulator::incrementRegister, &LockstepInterpreter::incrementRegister},
+            {&Intel_8080_Emulator::decrementRegister, &LockstepInterpreter::decrementRegister},
+            {&Intel_8080_Emulator::loadAccumulatorIndirect, &LockstepInterpreter::loadAccumulatorIndirect},
+            {&Intel_8080_Emulator::storeAccumulatorIndirect, &LockstepInterpreter::storeAccumulatorIndirect},
+            {&Intel_8080_Emulator::moveToMemoryImmediate, &LockstepInterpreter::moveToMemoryImmediate},
+            {&Intel_8080_Emulator::loadAccumulatorDirect, &LockstepInterpreter::loadAccumulatorDirect},
+            {&Intel_8080_Emulator::storeAccumulatorDirect, &LockstepInterpreter::storeAccumulatorDirect},
+            {&Intel_8080_Emulator::loadHLDirect, &LockstepInterpreter::loadHLDirect},
+            {&Intel_8080_Emulator::storeHLDirect, &LockstepInterpreter::storeHLDirect},
+            {&Intel_8080_Emulator::incrementMemory, &LockstepInterpreter::incrementMemory},
+            {&Intel_8080_Emulator::decrementMemory, &LockstepInterpreter::decrementMemory},
+            {&Intel_8080_Emulator::decimalAdjustAccumulator, &LockstepInterpreter::decimalAdjustAccumulator},
+            {&Intel_8080_Emulator::rotateLeft, &LockstepInterpreter::rotateLeft},
+            {&Intel_8080_Emulator::rotateRight, &LockstepInterpreter::rotateRight},
+            {&Intel_8080_Emulator::rotateLeftThroughCarry, &LockstepInterpreter::rotateLeftThroughCarry},
+            {&Intel_8080_Emulator::rotateRightThroughCarry, &LockstepInterpreter::rotateRightThroughCarry},
+            {&Intel_8080_Emulator::complementAccumulator, &LockstepInterpreter::complementAccumulator},
+            {&Intel_8080_Emulator::complementCarry, &LockstepInterpreter::complementCarry},
+            {&Intel_8080_Emulator::setCarry, &LockstepInterpreter::setCarry},
+            {&Intel_8080_Emulator::moveRegister, &LockstepInterpreter::moveRegister},
+            {&Intel_8080_Emulator::moveFromMemory, &LockstepInterpreter::moveFromMemory},
+            {&Intel_8080_Emulator::moveToMemory, &LockstepInterpreter::moveToMemory},
+            {&Intel_8080_Emulator::addRegister, &LockstepInterpreter::arithmeticRegister},
+            {&Intel_8080_Emulator::addRegisterWithCarry, &LockstepInterpreter::arithmeticRegister},
+            {&Intel_8080_Emulator::subtractRegister, &LockstepInterpreter::arithmeticRegister},
+            {&Intel_8080_Emulator::subtractRegisterWithBorrow, &LockstepInterpreter::arithmeticRegister},
+            {&Intel_8080_Emulator::andRegister, &LockstepInterpreter::arithmeticRegister},
+            {&Intel_8080_Emulator::xorRegister, &LockstepInterpreter::arithmeticRegister},
+            {&Intel_8080_Emulator::orRegister, &LockstepInterpreter::arithmeticRegister},
+            {&Intel_8080_Emulator::compareRegister, &LockstepInterpreter::arithmeticRegister},
+            {&Intel_8080_Emulator::addMemory, &LockstepInterpreter::arithmeticMemory},
+            {&Intel_8080_Emulator::addMemoryWithCarry, &LockstepInterpreter::arithmeticMemory},
+            {&Intel_8080_Emulator::subtractMemory, &LockstepInterpreter::arithmeticMemory},
+            {&Intel_8080_Emulator::subtractMemoryWithBorrow, &LockstepInterpreter::arithmeticMemory},
+            {&Intel_8080_Emulator::andMemory, &LockstepInterpreter::arithmeticMemory},
+            {&Intel_8080_Emulator::xorMemory, &LockstepInterpreter::arithmeticMemory},
+            {&Intel_8080_Emulator::orMemory, &LockstepInterpreter::arithmeticMemory},
+            {&Intel_8080_Emulator::compareMemory, &LockstepInterpreter::arithmeticMemory},
+            {&Intel_8080_Emulator::addImmediate, &LockstepInterpreter::arithmeticImmediate},
+            {&Intel_8080_Emulator::addImmediateWithCarry, &LockstepInterpreter::arithmeticImmediate},
+            {&Intel_8080_Emulator::subtractImmediate, &LockstepInterpreter::arithmeticImmediate},
+            {&Intel_8080_Emulator::subtractImmediateWithBorrow, &LockstepInterpreter::arithmeticImmediate},
+            {&Intel_8080_Emulator::andImmediate, &LockstepInterpreter::arithmeticImmediate},
+            {&Intel_8080_Emulator::xorImmediate, &LockstepInterpreter::arithmeticImmediate},
+            {&Intel_8080_Emulator::orImmediate, &LockstepInterpreter::arithmeticImmediate},
+            {&Intel_8080_Emulator::compareImmediate, &LockstepInterpreter::arithmeticImmediate},
+            {&Intel_8080_Emulator::unconditionalJump, &LockstepInterpreter::unconditionalJump},
+            {&Intel_8080_Emulator::conditionalJump, &LockstepInterpreter::conditionalJump},
+            {&Intel_8080_Emulator::unconditionalCall, &LockstepInterpreter::unconditionalCall},
+            {&Intel_8080_Emulator::conditionalCall, &LockstepInterpreter::conditionalCall},
+            {&Intel_8080_Emulator::unconditionalReturn, &LockstepInterpreter::unconditionalReturn},
+            {&Intel_8080_Emulator::conditionalReturn, &LockstepInterpreter::conditionalReturn},
+            {&Intel_8080_Emulator::restart, &LockstepInterpreter::restart},
+            {&Intel_8080_Emulator::push, &LockstepInterpreter::push},
+            {&Intel_8080_Emulator::pop, &LockstepInterpreter::pop},
+            {&Intel_8080_Emulator::pushProcessorStatusWord, &LockstepInterpreter::pushProcessorStatusWord},
+            {&Intel_8080_Emulator::popProcessorStatusWord, &LockstepInterpreter::popProcessorStatusWord},
+            {&Intel_8080_Emulator::exchangeHLWithDE, &LockstepInterpreter::exchangeHLWithDE},
+            {&Intel_8080_Emulator::exchangeStackTopWithHL, &LockstepInterpreter::exchangeStackTopWithHL},
+            {&Intel_8080_Emulator::jumpHLIndirect, &LockstepInterpreter::jumpHLIndirect},
+            {&Intel_8080_Emulator::moveHLToSP, &LockstepInterpreter::moveHLToSP},
+            {&Intel_8080_Emulator::enableInterrupts, &LockstepInterpreter::enableInterrupts},
+            {&Intel_8080_Emulator::disableInterrupts, &LockstepInterpreter::disableInterrupts}
+        };
+        
+        //HLT is left to the machines
+        std::array<Handler, 256> table{};
+        
+        for(int opcode = 0; opcode < 256; ++opcode)
+        {
+            for(const auto& [coreHandler, handler] : equivalents)
+            {
+                if(Intel_8080_Emulator::opTable[opcode] == coreHandler)
+                {
+                    table[opcode] = handler;
+                }
+            }
+        }
+        
+        return table;
+    }();
+    
+    return handlerTable;
+}
+
+void LockstepInterpreter::step()
+{
+    const uint16_t address = programCounters[leader];
+    
+    //Every lane waiting at the same address goes along with the leader
+    for(int lane = 0; lane < laneCount; ++lane)
+    {
+        selected[lane] = running[lane] & getMask<uint8_t>(programCounters[lane] == address);
+    }
+    
+    const Intel_8080_Emulator::DecodedInstruction& instruction = machines[leader]->decode(address);
+    const uint8_t opcode = instruction.opcode;
+    
+    if(sharedPages[address >> 8] && sharedPages[uint16_t(address + instruction.length - 1) >> 8])
+    {
+        immediates.fill(instruction.immediate);
+    }
+    else
+    {
+        //Code in RAM can be different in each machine, any with another instruction there wait for their own turn
+        forEachSelected([this, address, opcode](int lane, Intel_8080_Emulator& machine)
+        {
+            const Intel_8080_Emulator::DecodedInstruction& laneInstruction = machine.decode(address);
+            
+            selected[lane] = getMask<uint8_t>(laneInstruction.opcode == opcode);
+            immediates[lane] = laneInstruction.immediate;
+        });
+    }
+    
+    ++stepCount;
+    
+    if(const Handler handler = handlers[opcode]; handler != nullptr)
+    {
+        const uint8_t opCycles = Intel_8080_Emulator::opCycles[opcode];
+        
+        for(int lane = 0; lane < laneCount; ++lane)
+        {
+            cycleCounts[lane] += selected[lane] & opCycles;
+            instructionCounts[lane] += selected[lane] & 1;
+        }
+        
+        (this->*handler)(opcode);
+    }
+    else
+    {
+        forEachSelected([this](int lane, Intel_8080_Emulator&)
+        {
+            runScalar(lane);
+        });
+    }
+    
+    uint8_t anyStopped = 0x00;
+    
+    for(int lane = 0; lane < laneCount; ++lane)
+    {
+        anyStopped |= selected[lane] & getMask<uint8_t>(cycleCounts[lane] >= stopCycles[lane]);
+    }
+    
+    if(anyStopped == 0x00)
+    {
+        return;
+    }
+    
+    bool leaderStopped = false;
+    
+    forEachSelected([this, &leaderStopped](int lane, Intel_8080_Emulator&)
+    {
+        if(cycleCounts[lane] >= stopCycles[lane])
+        {
+            settleLane(lane);
+            leaderStopped |= lane == leader;
+        }
+    });
+    
+    //Handing over here lets the others catch up, and they all meet again where their events send them
+    if(leaderStopped)
+    {
+        leader = findNextLeader(leader);
+    }
+}
+
+void LockstepInterpreter::settleLane(int lane)
+{
+    Intel_8080_Emulator& machine = *machines[lane];
+    
+    while(true)
+    {
+        if(cycleCounts[lane] < stopCycles[lane])
+        {
+            if(!machine.haltFlag)
+            {
+                running[lane] = 0xFF;
+                return;
+            }
+            
+            //A halted CPU just idles until something happens
+            cycleCounts[lane] = stopCycles[lane];
+        }
+        
+        //Events work on the machine itself, so it is brought up to date around them
+        if(!machine.scheduledEvents.empty() && machine.scheduledEvents.back().cycle <= cycleCounts[lane])
+        {
+            storeLane(lane);
+            machine.runDueEvents();
+            loadLane(lane);
+        }
+        
+        if(cycleCounts[lane] >= endCycles[lane])
+        {
+            running[lane] = 0x00;
+            return;
+        }
+        
+        stopCycles[lane] = machine.scheduledEvents.empty() ? endCycles[lane] : std::min(endCycles[lane], machine.scheduledEvents.back().cycle);
+    }
+}
+
+int LockstepInterpreter::findNextLeader(int lane) const
+{
+    for(int offset = 1; offset <= laneCount; ++offset)
+    {
+        if(const int next = (lane + offset) % laneCount; running[next])
+        {
+            return next;
+        }
+    }
+    
+    return -1;
+}
+
+void LockstepInterpreter::loadLane(int lane)
+{
+    const Intel_8080_Emulator& machine = *machines[lane];
+    
+    for(uint8_t encoded = 0; encoded < registers.size(); ++encoded)
+    {
+        if(encoded != memoryOperand)
+        {
+            registers[encoded][lane] = machine.registers.getRegisterValue(RegisterManager::getRegFromEncodedValue(encoded));
+        }
+    }
+    
+    flags[lane] = machine.alu.createStatusByte();
+    stackPointers[lane] = machine.registers.getValueFromRegisterPair(RegisterManager::RegisterPair::SP);
+    programCounters[lane] = machine.programCounter;
+    cycleCounts[lane] = machine.cycleCount;
+    instructionCounts[lane] = machine.opCounter;
+}
+
+void LockstepInterpreter::storeLane(int lane)
+{
+    Intel_8080_Emulator& machine = *machines[lane];
+    
+    for(uint8_t encoded = 0; encoded < registers.size(); ++encoded)
+    {
+        if(encoded != memoryOperand)
+        {
+            machine.registers.setRegisterValue(RegisterManager::getRegFromEncodedValue(encoded), registers[encoded][lane]);
+        }
+    }
+    
+    machine.alu.setFromStatusByte(flags[lane]);
+    machine.registers.setRegisterPair(RegisterManager::RegisterPair::SP, stackPointers[lane]);
+    machine.programCounter = programCounters[lane];
+    machine.cycleCount = cycleCounts[lane];
+    machine.opCounter = instructionCounts[lane];
+}
+
+void LockstepInterpreter::runScalar(int lane)
+{
+    Intel_8080_Emulator& machine = *machines[lane];
+    
+    storeLane(lane);
+    
+    //Counted the same way runCycle does, then run by the machine's own table so nothing fused carries on past this one instruction
+    const uint8_t opcode = machine.decode(machine.programCounter).opcode;
+    
+    ++machine.opCounter;
+    machine.cycleCount += Intel_8080_Emulator::opCycles[opcode];
+    machine.decodeAndExecute(opcode);
+    
+    loadLane(lane);
+    
+    //HLT stops the lane straight away, and an I/O handler could have scheduled an event
+    stopCycles[lane] = machine.haltFlag ? cycleCounts[lane] : std::min(endCycles[lane], machine.scheduledEvents.empty() ? endCycles[lane] : machine.scheduledEvents.back().cycle);
+    
+    ++scalarInstructionCount;
+}
+
+void LockstepInterpreter::findSharedPages()
+{
+    const MemoryBus& firstBus = machines[0]->memoryBus;
+    
+    for(int page = 0; page < MemoryBus::pageCount; ++page)
+    {
+        const uint8_t* firstPage = firstBus.getReadPages()[page];
+        bool shared = firstPage != nullptr && !firstBus.isWritable(page);
+        
+        for(size_t machine = 1; shared && machine < machineCount; ++machine)
+        {
+            const MemoryBus& bus = machines[machine]->memoryBus;
+            const uint8_t* machinePage = bus.getReadPages()[page];
+            
+            shared = machinePage != nullptr && !bus.isWritable(page) && (machinePage == firstPage || std::memcmp(machinePage, firstPage, MemoryBus::pageSize) == 0);
+        }
+        
+        sharedPages[page] = shared;
+    }
+}
+
+template<typename Value>
+constexpr Value LockstepInterpreter::getMask(bool condition)
+{
+    return Value(0) - Value(condition);
+}
+
+template<typename Value>
+void LockstepInterpreter::merge(Row<Value>& row, const Row<Value>& values)
+{
+    for(int lane = 0; lane < laneCount; ++lane)
+    {
+        const Value mask = getMask<Value>(selected[lane]);
+        row[lane] = (values[lane] & mask) | (row[lane] & ~mask);
+    }
+}
+
+template<typename Function>
+void LockstepInterpreter::forEachSelected(Function function)
+{
+    for(int lane = 0; lane < laneCount; ++lane)
+    {
+        if(selected[lane])
+        {
+            function(lane, *machines[lane]);
+        }
+    }
+}
+
+void LockstepInterpreter::advance(uint8_t length)
+{
+    for(int lane = 0; lane < laneCount; ++lane)
+    {
+        programCounters[lane] += selected[lane] & length;
+    }
+}
+
+LockstepInterpreter::Row<uint16_t> LockstepInterpreter::getPair(uint8_t pair) const
+{
+    if(pair == pairSP)
+    {
+        return stackPointers;
+    }
+    
+    Row<uint16_t> values;
+    
+    for(int lane = 0; lane < laneCount; ++lane)
+    {
+        values[lane] = registers[pair * 2][lane] << 8 | registers[pair * 2 + 1][lane];
+    }
+    
+    return values;
+}
+
+void LockstepInterpreter::setPair(uint8_t pair, const Row<uint16_t>& values)
+{
+    if(pair == pairSP)
+    {
+        merge(stackPointers, values);
+        return;
+    }
+    
+    Row<uint8_t> highOrder;
+    Row<uint8_t> lowOrder;
+    
+    for(int lane = 0; lane < laneCount; ++lane)
+    {
+        highOrder[lane] = values[lane] >> 8;
+        lowOrder[lane] = values[lane];
+    }
+    
+    merge(registers[pair * 2], highOrder);
+    merge(registers[pair * 2 + 1], lowOrder);
+}
+
+void LockstepInterpreter::pushToStack(int lane, uint16_t value)
+{
+    Intel_8080_Emulator& machine = *machines[lane];
+    uint16_t sp = stackPointers[lane];
+    
+    machine.writeMemory(--sp, value >> 8);
+    machine.writeMemory(--sp, value);
+    
+    stackPointers[lane] = sp;
+}
+
+uint16_t LockstepInterpreter::popFromStack(int lane)
+{
+    const Intel_8080_Emulator& machine = *machines[lane];
+    const uint16_t sp = stackPointers[lane];
+    
+    stackPointers[lane] = sp + 2;
+    
+    return machine.readMemory(sp + 1) << 8 | machine.readMemory(sp);
+}
+
+void LockstepInterpreter::arithmetic(uint8_t opcode, const Row<uint8_t>& operands, bool andSetsAuxiliaryCarry)
+{
+    const uint8_t operation = (opcode >> 3) & 0x7;
+    const Row<uint8_t>& accumulator = registers[registerA];
+    
+    Row<uint8_t> results;
+    Row<uint8_t> resultFlags;
+    
+    switch(operation)
+    {
+        //ADD
+        case 0x0:
+            addOrSubtract<false, false>(operands, results, resultFlags);
+            break;
+            
+        //ADC
+        case 0x1:
+            addOrSubtract<false, true>(operands, results, resultFlags);
+            break;
+            
+        //SUB, and CMP which only keeps the flags
+        case 0x2:
+        case 0x7:
+            addOrSubtract<true, false>(operands, results, resultFlags);
+            break;
+            
+        //SBB
+        case 0x3:
+            addOrSubtract<true, true>(operands, results, resultFlags);
+            break;
+            
+        //ANA
+        case 0x4:
+        {
+            const uint8_t auxiliaryCarryMask = andSetsAuxiliaryCarry ? auxiliaryCarryFlag : 0x0;
+            
+            for(int lane = 0; lane < laneCount; ++lane)
+            {
+                results[lane] = accumulator[lane] & operands[lane];
+                resultFlags[lane] = getZeroSignParity(results[lane]) | ((results[lane] ^ accumulator[lane] ^ operands[lane]) & auxiliaryCarryMask) | fixedFlags;
+            }
+            
+            break;
+        }
+        
+        //XRA
+        case 0x5:
+        {
+            for(int lane = 0; lane < laneCount; ++lane)
+            {
+                results[lane] = accumulator[lane] ^ operands[lane];
+                resultFlags[lane] = getZeroSignParity(results[lane]) | fixedFlags;
+            }
+            
+            break;
+        }
+        
+        //ORA
+        case 0x6:
+        {
+            for(int lane = 0; lane < laneCount; ++lane)
+            {
+                results[lane] = accumulator[lane] | operands[lane];
+                resultFlags[lane] = getZeroSignParity(results[lane]) | fixedFlags;
+            }
+            
+            break;
+        }
+    }
+    
+    merge(flags, resultFlags);
+    
+    if(operation != 0x7)
+    {
+        merge(registers[registerA], results);
+    }
+}
+
+template<bool subtract, bool withCarry>
+void LockstepInterpreter::addOrSubtract(const Row<uint8_t>& operands, Row<uint8_t>& results, Row<uint8_t>& resultFlags) const
+{
+    const Row<uint8_t>& accumulator = registers[registerA];
+    
+    for(int lane = 0; lane < laneCount; ++lane)
+    {
+        const uint8_t carryIn = withCarry ? flags[lane] & carryFlag : 0x0;
+        
+        //A carry or borrow out ends up in bit 8
+        const uint16_t wideResult = subtract ? accumulator[lane] - operands[lane] - carryIn : accumulator[lane] + operands[lane] + carryIn;
+        const uint8_t result = wideResult;
+        
+        results[lane] = result;
+        resultFlags[lane] = getZeroSignParity(result) | ((result ^ accumulator[lane] ^ operands[lane]) & auxiliaryCarryFlag) | ((wideResult >> 8) & carryFlag) | fixedFlags;
+    }
+}
+
+LockstepInterpreter::Row<uint8_t> LockstepInterpreter::checkCondition(uint8_t opcode) const
+{
+    //Conditions are encoded as a flag in the top two bits and whether it has to be set in the lowest
+    static constexpr std::array<uint8_t, 4> conditionFlags
+    {
+        zeroFlag,
+        carryFlag,
+        parityFlag,
+        signFlag
+    };
+    
+    const uint8_t conditionFlag = conditionFlags[(opcode >> 4) & 0x3];
+    const uint8_t conditionValue = opcode & 0x8 ? conditionFlag : 0x0;
+    
+    Row<uint8_t> taken;
+    
+    for(int lane = 0; lane < laneCount; ++lane)
+    {
+        taken[lane] = getMask<uint8_t>((flags[lane] & conditionFlag) == conditionValue);
+    }
+    
+    return taken;
+}
+
+constexpr uint8_t LockstepInterpreter::getZeroSignParity(uint8_t value)
+{
+    //Folded down to one bit, which is clear for even parity
+    uint8_t parity = value ^ (value >> 4);
+    parity ^= parity >> 2;
+    parity ^= parity >> 1;
+    
+    return (value & signFlag) | (getMask<uint8_t>(value == 0) & zeroFlag) | (~parity & 0x1) << 2;
+}
+
+//00000000 - No Op
+void LockstepInterpreter::noOp(uint8_t)
+{
+    advance(1);
+}
+
+//00RP0001 - Load Register Pair Immediate
+void LockstepInterpreter::loadRegisterPairImmediate(uint8_t opcode)
+{
+    setPair((opcode >> 4) & 0x3, immediates);
+    advance(3);
+}
+
+//00RP0011 - Increment Register Pair
+void LockstepInterpreter::incrementRegisterPair(uint8_t opcode)
+{
+    const uint8_t pair = (opcode >> 4) & 0x3;
+    Row<uint16_t> values = getPair(pair);
+    
+    for(uint16_t& value : values)
+    {
+        ++value;
+    }
+    
+    setPair(pair, values);
+    advance(1);
+}
+
+//00RP1011 - Decrement Register Pair
+void LockstepInterpreter::decrementRegisterPair(uint8_t opcode)
+{
+    const uint8_t pair = (opcode >> 4) & 0x3;
+    Row<uint16_t> values = getPair(pair);
+    
+    for(uint16_t& value : values)
+    {
+        --value;
+    }
+    
+    setPair(pair, values);
+    advance(1);
+}
+
+//00RP1001 - Add Register Pair to H and L
+void LockstepInterpreter::addRegisterPairToHL(uint8_t opcode)
+{
+    const Row<uint16_t> hl = getPair(pairHL);
+    const Row<uint16_t> values = getPair((opcode >> 4) & 0x3);
+    
+    Row<uint16_t> results;
+    Row<uint8_t> resultFlags;
+    
+    for(int lane = 0; lane < laneCount; ++lane)
+    {
+        const uint32_t wideResult = hl[lane] + values[lane];
+        
+        results[lane] = wideResult;
+        resultFlags[lane] = (flags[lane] & ~carryFlag) | (wideResult >> 16);
+    }
+    
+    setPair(pairHL, results);
+    merge(flags, resultFlags);
+    advance(1);
+}
+
+//00DDD110 - Move Immediate
+void LockstepInterpreter::moveImmediate(uint8_t opcode)
+{
+    Row<uint8_t> values;
+    
+    for(int lane = 0; lane < laneCount; ++lane)
+    {
+        values[lane] = immediates[lane];
+    }
+    
+    merge(registers[(opcode >> 3) & 0x7], values);
+    advance(2);
+}
+
+//00DDD100 - Increment Register
+void LockstepInterpreter::incrementRegister(uint8_t opcode)
+{
+    Row<uint8_t>& reg = registers[(opcode >> 3) & 0x7];
+    
+    Row<uint8_t> results;
+    Row<uint8_t> resultFlags;
+    
+    for(int lane = 0; lane < laneCount; ++lane)
+    {
+        results[lane] = reg[lane] + 1;
+        resultFlags[lane] = (flags[lane] & carryFlag) | getZeroSignParity(results[lane]) | ((results[lane] ^ reg[lane] ^ 1) & auxiliaryCarryFlag) | fixedFlags;
+    }
+    
+    merge(reg, results);
+    merge(flags, resultFlags);
+    advance(1);
+}
+
+//00DDD101 - Decrement Register
+void LockstepInterpreter::decrementRegister(uint8_t opcode)
+{
+    Row<uint8_t>& reg = registers[(opcode >> 3) & 0x7];
+    
+    Row<uint8_t> results;
+    Row<uint8_t> resultFlags;
+    
+    for(int lane = 0; lane < laneCount; ++lane)
+    {
+        results[lane] = reg[lane] - 1;
+        resultFlags[lane] = (flags[lane] & carryFlag) | getZeroSignParity(results[lane]) | ((results[lane] ^ reg[lane] ^ 1) & auxiliaryCarryFlag) | fixedFlags;
+    }
+    
+    merge(reg, results);
+    merge(flags, resultFlags);
+    advance(1);
+}
+
+//00RP1010 - Load accumulator indirect
+void LockstepInterpreter::loadAccumulatorIndirect(uint8_t opcode)
+{
+    const Row<uint16_t> addresses = getPair((opcode >> 4) & 0x3);
+    
+    forEachSelected([this, &addresses](int lane, Intel_8080_Emulator& machine)
+    {
+        registers[registerA][lane] = machine.readMemory(addresses[lane]);
+    });
+    
+    advance(1);
+}
+
+//00RP0010 - Store accumulator indirect
+void LockstepInterpreter::storeAccumulatorIndirect(uint8_t opcode)
+{
+    const Row<uint16_t> addresses = getPair((opcode >> 4) & 0x3);
+    
+    forEachSelected([this, &addresses](int lane, Intel_8080_Emulator& machine)
+    {
+        machine.writeMemory(addresses[lane], registers[registerA][lane]);
+    });
+    
+    advance(1);
+}
+
+//00110110 - Move to memory immediate
+void LockstepInterpreter::moveToMemoryImmediate(uint8_t)
+{
+    const Row<uint16_t> addresses = getPair(pairHL);
+    
+    forEachSelected([this, &addresses](int lane, Intel_8080_Emulator& machine)
+    {
+        machine.writeMemory(addresses[lane], immediates[lane]);
+    });
+    
+    advance(2);
+}
+
+//00111010 - Load Accumulator Direct
+void LockstepInterpreter::loadAccumulatorDirect(uint8_t)
+{
+    forEachSelected([this](int lane, Intel_8080_Emulator& machine)
+    {
+        registers[registerA][lane] = machine.readMemory(immediates[lane]);
+    });
+    
+    advance(3);
+}
+
+//00110010 - Store Accumulator Direct
+void LockstepInterpreter::storeAccumulatorDirect(uint8_t)
+{
+    forEachSelected([this](int lane, Intel_8080_Emulator& machine)
+    {
+        machine.writeMemory(immediates[lane], registers[registerA][lane]);
+    });
+    
+    advance(3);
+}
+
+//00101010 - Load H and L direct
+void LockstepInterpreter::loadHLDirect(uint8_t)
+{
+    forEachSelected([this](int lane, Intel_8080_Emulator& machine)
+    {
+        registers[registerL][lane] = machine.readMemory(immediates[lane]);
+        registers[registerH][lane] = machine.readMemory(immediates[lane] + 1);
+    });
+    
+    advance(3);
+}
+
+//00100010 - Store H and L direct
+void LockstepInterpreter::storeHLDirect(uint8_t)
+{
+    forEachSelected([this](int lane, Intel_8080_Emulator& machine)
+    {
+        machine.writeMemory(immediates[lane], registers[registerL][lane]);
+        machine.writeMemory(immediates[lane] + 1, registers[registerH][lane]);
+    });
+    
+    advance(3);
+}
+
+//00110100 - Increment Memory
+void LockstepInterpreter::incrementMemory(uint8_t)
+{
+    const Row<uint16_t> addresses = getPair(pairHL);
+    
+    forEachSelected([this, &addresses](int lane, Intel_8080_Emulator& machine)
+    {
+        const uint8_t value = machine.readMemory(addresses[lane]);
+        const uint8_t result = value + 1;
+        
+        flags[lane] = (flags[lane] & carryFlag) | getZeroSignParity(result) | ((result ^ value ^ 1) & auxiliaryCarryFlag) | fixedFlags;
+        machine.writeMemory(addresses[lane], result);
+    });
+    
+    advance(1);
+}
+
+//00110101 - Decrement Memory
+void LockstepInterpreter::decrementMemory(uint8_t)
+{
+    const Row<uint16_t> addresses = getPair(pairHL);
+    
+    forEachSelected([this, &addresses](int lane, Intel_8080_Emulator& machine)
+    {
+        const uint8_t value = machine.readMemory(addresses[lane]);
+        const uint8_t result = value - 1;
+        
+        flags[lane] = (flags[lane] & carryFlag) | getZeroSignParity(result) | ((result ^ value ^ 1) & auxiliaryCarryFlag) | fixedFlags;
+        machine.writeMemory(addresses[lane], result);
+    });
+    
+    advance(1);
+}
+
+//00100111 - Decimal Adjust Accumulator
+void LockstepInterpreter::decimalAdjustAccumulator(uint8_t)
+{
+    //The ALU's table has its flags in its own order
+    static constexpr std::array<std::pair<ALU::Flag, uint8_t>, 5> statusFlags
+    {{
+        {ALU::Flag::Carry, carryFlag},
+        {ALU::Flag::Parity, parityFlag},
+        {ALU::Flag::AuxillaryCarry, auxiliaryCarryFlag},
+        {ALU::Flag::Zero, zeroFlag},
+        {ALU::Flag::Sign, signFlag}
+    }};
+    
+    forEachSelected([this](int lane, Intel_8080_Emulator&)
+    {
+        const int index = registers[registerA][lane] | (flags[lane] & carryFlag) << 8 | (flags[lane] & auxiliaryCarryFlag ? 0x200 : 0x0);
+        const uint16_t entry = ALU::daaTable[index];
+        
+        uint8_t status = fixedFlags;
+        
+        for(const auto& [aluFlag, statusFlag] : statusFlags)
+        {
+            if((entry >> 8) & static_cast<uint8_t>(aluFlag))
+            {
+                status |= statusFlag;
+            }
+        }
+        
+        registers[registerA][lane] = entry;
+        flags[lane] = status;
+    });
+    
+    advance(1);
+}
+
+//00000111 - Rotate Left
+void LockstepInterpreter::rotateLeft(uint8_t)
+{
+    const Row<uint8_t>& accumulator = registers[registerA];
+    
+    Row<uint8_t> results;
+    Row<uint8_t> resultFlags;
+    
+    for(int lane = 0; lane < laneCount; ++lane)
+    {
+        results[lane] = accumulator[lane] << 1 | accumulator[lane] >> 7;
+        resultFlags[lane] = (flags[lane] & ~carryFlag) | accumulator[lane] >> 7;
+    }
+    
+    merge(registers[registerA], results);
+    merge(flags, resultFlags);
+    advance(1);
+}
+
+//00001111 - Rotate Right
+void LockstepInterpreter::rotateRight(uint8_t)
+{
+    const Row<uint8_t>& accumulator = registers[registerA];
+    
+    Row<uint8_t> results;
+    Row<uint8_t> resultFlags;
+    
+    for(int lane = 0; lane < laneCount; ++lane)
+    {
+        results[lane] = accumulator[lane] >> 1 | accumulator[lane] << 7;
+        resultFlags[lane] = (flags[lane] & ~carryFlag) | (accumulator[lane] & 0x1);
+    }
+    
+    merge(registers[registerA], results);
+    merge(flags, resultFlags);
+    advance(1);
+}
+
+//00010111 - Rotate Left Through Carry
+void LockstepInterpreter::rotateLeftThroughCarry(uint8_t)
+{
+    const Row<uint8_t>& accumulator = registers[registerA];
+    
+    Row<uint8_t> results;
+    Row<uint8_t> resultFlags;
+    
+    for(int lane = 0; lane < laneCount; ++lane)
+    {
+        results[lane] = accumulator[lane] << 1 | (flags[lane] & carryFlag);
+        resultFlags[lane] = (flags[lane] & ~carryFlag) | accumulator[lane] >> 7;
+    }
+    
+    merge(registers[registerA], results);
+    merge(flags, resultFlags);
+    advance(1);
+}
+
+//00011111 - Rotate Right Through Carry
+void LockstepInterpreter::rotateRightThroughCarry(uint8_t)
+{
+    const Row<uint8_t>& accumulator = registers[registerA];
+    
+    Row<uint8_t> results;
+    Row<uint8_t> resultFlags;
+    
+    for(int lane = 0; lane < laneCount; ++lane)
+    {
+        results[lane] = accumulator[lane] >> 1 | (flags[lane] & carryFlag) << 7;
+        resultFlags[lane] = (flags[lane] & ~carryFlag) | (accumulator[lane] & 0x1);
+    }
+    
+    merge(registers[registerA], results);
+    merge(flags, resultFlags);
+    advance(1);
+}
+
+//00101111 - Complement Accumulator
+void LockstepInterpreter::complementAccumulator(uint8_t)
+{
+    Row<uint8_t> results;
+    
+    for(int lane = 0; lane < laneCount; ++lane)
+    {
+        results[lane] = ~registers[registerA][lane];
+    }
+    
+    merge(registers[registerA], results);
+    advance(1);
+}
+
+//00111111 - Complement Carry
+void LockstepInterpreter::complementCarry(uint8_t)
+{
+    for(int lane = 0; lane < laneCount; ++lane)
+    {
+        flags[lane] ^= selected[lane] & carryFlag;
+    }
+    
+    advance(1);
+}
+
+//00110111 - Set Carry
+void LockstepInterpreter::setCarry(uint8_t)
+{
+    for(int lane = 0; lane < laneCount; ++lane)
+    {
+        flags[lane] |= selected[lane] & carryFlag;
+    }
+    
+    advance(1);
+}
+
+//01DDDSSS - Move register
+void LockstepInterpreter::moveRegister(uint8_t opcode)
+{
+    merge(registers[(opcode >> 3) & 0x7], registers[opcode & 0x7]);
+    advance(1);
+}
+
+//01DDD110 - Move from memory
+void LockstepInterpreter::moveFromMemory(uint8_t opcode)
+{
+    const Row<uint16_t> addresses = getPair(pairHL);
+    Row<uint8_t>& destination = registers[(opcode >> 3) & 0x7];
+    
+    forEachSelected([&addresses, &destination](int lane, Intel_8080_Emulator& machine)
+    {
+        destination[lane] = machine.readMemory(addresses[lane]);
+    });
+    
+    advance(1);
+}
+
+//01110SSS - Move to memory
+void LockstepInterpreter::moveToMemory(uint8_t opcode)
+{
+    const Row<uint16_t> addresses = getPair(pairHL);
+    const Row<uint8_t>& source = registers[opcode & 0x7];
+    
+    forEachSelected([&addresses, &source](int lane, Intel_8080_Emulator& machine)
+    {
+        machine.writeMemory(addresses[lane], source[lane]);
+    });
+    
+    advance(1);
+}
+
+//10CCCSSS - Arithmetic and logic on a register
+void LockstepInterpreter::arithmeticRegister(uint8_t opcode)
+{
+    arithmetic(opcode, registers[opcode & 0x7], true);
+    advance(1);
+}
+
+//10CCC110 - Arithmetic and logic on memory
+void LockstepInterpreter::arithmeticMemory(uint8_t opcode)
+{
+    const Row<uint16_t> addresses = getPair(pairHL);
+    Row<uint8_t> operands{};
+    
+    forEachSelected([&addresses, &operands](int lane, Intel_8080_Emulator& machine)
+    {
+        operands[lane] = machine.readMemory(addresses[lane]);
+    });
+    
+    arithmetic(opcode, operands, true);
+    advance(1);
+}
+
+//11CCC110 - Arithmetic and logic immediate
+void LockstepInterpreter::arithmeticImmediate(uint8_t opcode)
+{
+    Row<uint8_t> operands;
+    
+    for(int lane = 0; lane < laneCount; ++lane)
+    {
+        operands[lane] = immediates[lane];
+    }
+    
+    arithmetic(opcode, operands, false);
+    advance(2);
+}
+
+//11000011 - Jump
+void LockstepInterpreter::unconditionalJump(uint8_t)
+{
+    merge(programCounters, immediates);
+}
+
+//11CCC010 - Conditional Jump
+void LockstepInterpreter::conditionalJump(uint8_t opcode)
+{
+    const Row<uint8_t> taken = checkCondition(opcode);
+    Row<uint16_t> targets;
+    
+    for(int lane = 0; lane < laneCount; ++lane)
+    {
+        const uint16_t mask = getMask<uint16_t>(taken[lane]);
+        targets[lane] = (immediates[lane] & mask) | ((programCounters[lane] + 3) & ~mask);
+    }
+    
+    merge(programCounters, targets);
+}
+
+//11001101 - Call
+void LockstepInterpreter::unconditionalCall(uint8_t)
+{
+    forEachSelected([this](int lane, Intel_8080_Emulator&)
+    {
+        pushToStack(lane, programCounters[lane] + 3);
+        programCounters[lane] = immediates[lane];
+    });
+}
+
+//11CCC100 - Conditional Call
+void LockstepInterpreter::conditionalCall(uint8_t opcode)
+{
+    const Row<uint8_t> taken = checkCondition(opcode);
+    
+    forEachSelected([this, &taken](int lane, Intel_8080_Emulator&)
+    {
+        if(taken[lane])
+        {
+            cycleCounts[lane] += Intel_8080_Emulator::takenBranchExtraCycles;
+            pushToStack(lane, programCounters[lane] + 3);
+            programCounters[lane] = immediates[lane];
+        }
+        else
+        {
+            programCounters[lane] += 3;
+        }
+    });
+}
+
+//11001001 - Return
+void LockstepInterpreter::unconditionalReturn(uint8_t)
+{
+    forEachSelected([this](int lane, Intel_8080_Emulator&)
+    {
+        programCounters[lane] = popFromStack(lane);
+    });
+}
+
+//11CCC000 - Conditional Return
+void LockstepInterpreter::conditionalReturn(uint8_t opcode)
+{
+    const Row<uint8_t> taken = checkCondition(opcode);
+    
+    forEachSelected([this, &taken](int lane, Intel_8080_Emulator&)
+    {
+        if(taken[lane])
+        {
+            cycleCounts[lane] += Intel_8080_Emulator::takenBranchExtraCycles;
+            programCounters[lane] = popFromStack(lane);
+        }
+        else
+        {
+            ++programCounters[lane];
+        }
+    });
+}
+
+//11NNN111 - Restart
+void LockstepInterpreter::restart(uint8_t opcode)
+{
+    forEachSelected([this, opcode](int lane, Intel_8080_Emulator&)
+    {
+        pushToStack(lane, programCounters[lane] + 1);
+        programCounters[lane] = opcode & 0x38;
+    });
+}
+
+//11RP0101 - Push
+void LockstepInterpreter::push(uint8_t opcode)
+{
+    const Row<uint16_t> values = getPair((opcode >> 4) & 0x3);
+    
+    forEachSelected([this, &values](int lane, Intel_8080_Emulator&)
+    {
+        pushToStack(lane, values[lane]);
+    });
+    
+    advance(1);
+}
+
+//11RP0001 - Pop
+void LockstepInterpreter::pop(uint8_t opcode)
+{
+    Row<uint16_t> values{};
+    
+    forEachSelected([this, &values](int lane, Intel_8080_Emulator&)
+    {
+        values[lane] = popFromStack(lane);
+    });
+    
+    setPair((opcode >> 4) & 0x3, values);
+    advance(1);
+}
+
+//11110101 - Push processor status word
+void LockstepInterpreter::pushProcessorStatusWord(uint8_t)
+{
+    forEachSelected([this](int lane, Intel_8080_Emulator&)
+    {
+        pushToStack(lane, registers[registerA][lane] << 8 | flags[lane]);
+    });
+    
+    advance(1);
+}
+
+//11110001 - Pop processor status word
+void LockstepInterpreter::popProcessorStatusWord(uint8_t)
+{
+    forEachSelected([this](int lane, Intel_8080_Emulator&)
+    {
+        const uint16_t value = popFromStack(lane);
+        
+        //Bits 1, 3 and 5 aren't flags, so always read back the same
+        flags[lane] = (value & (carryFlag | parityFlag | auxiliaryCarryFlag | zeroFlag | signFlag)) | fixedFlags;
+        registers[registerA][lane] = value >> 8;
+    });
+    
+    advance(1);
+}
+
+//11101011 - Exchange H and L with D and E
+void LockstepInterpreter::exchangeHLWithDE(uint8_t)
+{
+    const Row<uint8_t> d = registers[2];
+    const Row<uint8_t> e = registers[3];
+    
+    merge(registers[2], registers[registerH]);
+    merge(registers[3], registers[registerL]);
+    merge(registers[registerH], d);
+    merge(registers[registerL], e);
+    
+    advance(1);
+}
+
+//11100011 - Exchange stack top with H and L
+void LockstepInterpreter::exchangeStackTopWithHL(uint8_t)
+{
+    forEachSelected([this](int lane, Intel_8080_Emulator& machine)
+    {
+        const uint16_t sp = stackPointers[lane];
+        
+        const uint8_t firstStackVal = machine.readMemory(sp);
+        const uint8_t secondStackVal = machine.readMemory(sp + 1);
+        
+        machine.writeMemory(sp, registers[registerL][lane]);
+        machine.writeMemory(sp + 1, registers[registerH][lane]);
+        
+        registers[registerL][lane] = firstStackVal;
+        registers[registerH][lane] = secondStackVal;
+    });
+    
+    advance(1);
+}
+
+//11101001 - Jump H and L indirect - move H and L to Program Counter
+void LockstepInterpreter::jumpHLIndirect(uint8_t)
+{
+    merge(programCounters, getPair(pairHL));
+}
+
+//11111001 - Move HL to SP
+void LockstepInterpreter::moveHLToSP(uint8_t)
+{
+    merge(stackPointers, getPair(pairHL));
+    advance(1);
+}
+
+//11111011 - Enable Interrupts
+void LockstepInterpreter::enableInterrupts(uint8_t)
+{
+    //Only ever looked at by events, which run on the machine itself
+    forEachSelected([](int, Intel_8080_Emulator& machine)
+    {
+        machine.interrupts = true;
+    });
+    
+    advance(1);
+}
+
+//11110011 - Disable Interrupts
+void LockstepInterpreter::disableInterrupts(uint8_t)
+{
+    forEachSelected([](int, Intel_8080_Emulator& machine)
+    {
+        machine.interrupts = false;
+    });
+    
+    advance(1);
+}
@@ -0,0 +1,199 @@
+//
+//  LockstepInterpreter.hpp
+//  Intel_8080_Emulator
+//
+
+#pragma once
+
+#include "Intel_8080_Emulator.hpp"
+
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <span>
+
+//Interprets up to laneCount machines running the same ROM together, an instruction at a time across all of them
+//Registers, flags and program counters are kept as arrays with a lane for each machine, so an instruction at the same address
+//in many machines is run for all of them at once by loops with no branches, which the compiler turns into vector instructions.
+//Machines somewhere else wait their turn, and opcodes a machine handles itself, like IN and OUT, go through its own
+//interpreter one machine at a time. Every machine ends up exactly where runFor would have left it
+class LockstepInterpreter
+{
+public:
+    //32 single byte registers fill an AVX2 vector
+    static constexpr int laneCount = 32;
+    
+    //The machines have to outlive the interpreter. They are interpreted here whatever they are set to run with otherwise, like the recompiler
+    explicit LockstepInterpreter(std::span<Intel_8080_Emulator* const> machinesToRun);
+    
+    //Runs each machine for at least the number of cycles at the same index, the same as calling runFor on each in turn
+    void runFor(std::span<const uint64_t> cycles);
+    
+    size_t getMachineCount() const;
+    
+    //Totals over every run. Instructions count once for each machine that ran them, steps once however many machines ran them together
+    uint64_t getInstructionCount() const;
+    uint64_t getScalarInstructionCount() const;
+    uint64_t getStepCount() const;
+
+private:
+    using Handler = void (LockstepInterpreter::*)(uint8_t opcode);
+    
+    template<typename Value>
+    using Row = std::array<Value, laneCount>;
+    
+    //The core's handler for each opcode mapped to the one here that does the same across lanes, nullptr where there isn't one
+    static const std::array<Handler, 256>& getHandlerTable();
+    
+    //Runs the instruction at the leader's address for every lane waiting there
+    void step();
+    
+    //Runs any events the lane has due and works out whether it has an instruction to run before it has to stop, as runFor does between instructions
+    void settleLane(int lane);
+    
+    //The next lane round from the given one with instructions left to run, or -1 if there aren't any
+    int findNextLeader(int lane) const;
+    
+    //Copies a lane's state from its machine, or back into it
+    void loadLane(int lane);
+    void storeLane(int lane);
+    
+    //Runs the lane's next instruction through its machine's own interpreter
+    void runScalar(int lane);
+    
+    //Pages that are ROM in every machine and hold the same bytes in each, so an instruction decoded from one is the same for all of them
+    void findSharedPages();
+    
+    //All ones when the condition holds, worked out without a branch so loops using it can still be vectorised
+    template<typename Value>
+    static constexpr Value getMask(bool condition);
+    
+    //Copies values into the row for the lanes running the current instruction, leaving the others
+    template<typename Value>
+    void merge(Row<Value>& row, const Row<Value>& values);
+    
+    //Calls function with each lane running the current instruction and its machine, for anything that has to touch memory
+    template<typename Function>
+    void forEachSelected(Function function);
+    
+    void advance(uint8_t length);
+    
+    Row<uint16_t> getPair(uint8_t pair) const;
+    void setPair(uint8_t pair, const Row<uint16_t>& values);
+    
+    void pushToStack(int lane, uint16_t value);
+    uint16_t popFromStack(int lane);
+    
+    //Operation in bits 3 to 5 of an arithmetic or logic opcode, on A and the operands
+    //AND takes its auxiliary carry from the operands, except for ANI, which clears it like the other logic operations
+    void arithmetic(uint8_t opcode, const Row<uint8_t>& operands, bool andSetsAuxiliaryCarry);
+    
+    template<bool subtract, bool withCarry>
+    void addOrSubtract(const Row<uint8_t>& operands, Row<uint8_t>& results, Row<uint8_t>& resultFlags) const;
+    
+    //Whether each lane meets the condition in bits 3 to 5 of a conditional opcode
+    Row<uint8_t> checkCondition(uint8_t opcode) const;
+    
+    //Zero, sign and parity in status byte positions
+    static constexpr uint8_t getZeroSignParity(uint8_t value);
+    
+    //Instruction handlers, named after the core's ones they match
+    void noOp(uint8_t opcode);
+    void loadRegisterPairImmediate(uint8_t opcode);
+    void incrementRegisterPair(uint8_t opcode);
+    void decrementRegisterPair(uint8_t opcode);
+    void addRegisterPairToHL(uint8_t opcode);
+    void moveImmediate(uint8_t opcode);
+    void incrementRegister(uint8_t opcode);
+    void decrementRegister(uint8_t opcode);
+    void loadAccumulatorIndirect(uint8_t opcode);
+    void storeAccumulatorIndirect(uint8_t opcode);
+    void moveToMemoryImmediate(uint8_t opcode);
+    void loadAccumulatorDirect(uint8_t opcode);
+    void storeAccumulatorDirect(uint8_t opcode);
+    void loadHLDirect(uint8_t opcode);
+    void storeHLDirect(uint8_t opcode);
+    void incrementMemory(uint8_t opcode);
+    void decrementMemory(uint8_t opcode);
+    void decimalAdjustAccumulator(uint8_t opcode);
+    void rotateLeft(uint8_t opcode);
+    void rotateRight(uint8_t opcode);
+    void rotateLeftThroughCarry(uint8_t opcode);
+    void rotateRightThroughCarry(uint8_t opcode);
+    void complementAccumulator(uint8_t opcode);
+    void complementCarry(uint8_t opcode);
+    void setCarry(uint8_t opcode);
+    void moveRegister(uint8_t opcode);
+    void moveFromMemory(uint8_t opcode);
+    void moveToMemory(uint8_t opcode);
+    void arithmeticRegister(uint8_t opcode);
+    void arithmeticMemory(uint8_t opcode);
+    void arithmeticImmediate(uint8_t opcode);
+    void unconditionalJump(uint8_t opcode);
+    void conditionalJump(uint8_t opcode);
+    void unconditionalCall(uint8_t opcode);
+    void conditionalCall(uint8_t opcode);
+    void unconditionalReturn(uint8_t opcode);
+    void conditionalReturn(uint8_t opcode);
+    void restart(uint8_t opcode);
+    void push(uint8_t opcode);
+    void pop(uint8_t opcode);
+    void pushProcessorStatusWord(uint8_t opcode);
+    void popProcessorStatusWord(uint8_t opcode);
+    void exchangeHLWithDE(uint8_t opcode);
+    void exchangeStackTopWithHL(uint8_t opcode);
+    void jumpHLIndirect(uint8_t opcode);
+    void moveHLToSP(uint8_t opcode);
+    void enableInterrupts(uint8_t opcode);
+    void disableInterrupts(uint8_t opcode);
+    
+    //Registers are rows in the order of their 3 bit encoding, 110 is memory so its row is never used
+    static constexpr uint8_t registerH = 4;
+    static constexpr uint8_t registerL = 5;
+    static constexpr uint8_t memoryOperand = 6;
+    static constexpr uint8_t registerA = 7;
+    
+    static constexpr uint8_t pairHL = 2;
+    static constexpr uint8_t pairSP = 3;
+    
+    //Flags are kept as the status byte PUSH PSW writes, with bit 1 always set
+    static constexpr uint8_t carryFlag = 0x01;
+    static constexpr uint8_t parityFlag = 0x04;
+    static constexpr uint8_t auxiliaryCarryFlag = 0x10;
+    static constexpr uint8_t zeroFlag = 0x40;
+    static constexpr uint8_t signFlag = 0x80;
+    static constexpr uint8_t fixedFlags = 0x02;
+    
+    std::array<Intel_8080_Emulator*, laneCount> machines{};
+    size_t machineCount;
+    
+    //Handlers for opcodes every machine leaves to the core, the rest run on the machines themselves
+    std::array<Handler, 256> handlers;
+    
+    alignas(64) std::array<Row<uint8_t>, 8> registers{};
+    alignas(64) Row<uint8_t> flags{};
+    alignas(64) Row<uint16_t> stackPointers{};
+    alignas(64) Row<uint16_t> programCounters{};
+    alignas(64) Row<uint64_t> cycleCounts{};
+    alignas(64) Row<uint64_t> instructionCounts{};
+    
+    //Immediate bytes of the instruction being run, one for each lane in case it is in RAM and they differ
+    alignas(64) Row<uint16_t> immediates{};
+    
+    //0xFF for lanes running the current instruction, and for lanes with instructions left before they stop
+    alignas(64) Row<uint8_t> selected{};
+    alignas(64) Row<uint8_t> running{};
+    
+    //Where each lane has to stop for its next event or the end of the run, whichever is first, and the end of the run
+    alignas(64) Row<uint64_t> stopCycles{};
+    Row<uint64_t> endCycles{};
+    
+    //The lane whose instructions are being run, with any others at the same address. It leads until it has to stop
+    int leader = -1;
+    
+    std::bitset<MemoryBus::pageCount> sharedPages;
+    
+    uint64_t instructionCount = 0;
+    uint64_t scalarInstructionCount = 0;
+    uint64_t stepCount = 0;
+};
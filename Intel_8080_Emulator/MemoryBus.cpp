@@ -0,0 +1,242 @@
+//
+//  MemoryBus.cpp
+//  Intel_8080_Emulator
+//
+
+#include "MemoryBus.hpp"
+
+#include <cassert>
+
+const std::array<uint8_t, MemoryBus::pageSize> MemoryBus::emptyPage{};
+
+MemoryBus::MemoryBus()
+{
+    mapRAM(0x0, 0x10000);
+}
+
+void MemoryBus::mapRAM(uint16_t start, uint32_t size)
+{
+    mapStorage(start, size, true);
+}
+
+void MemoryBus::mapROM(uint16_t start, uint32_t size)
+{
+    mapStorage(start, size, false);
+}
+
+void MemoryBus::mapMirror(uint16_t start, uint32_t size, uint16_t source)
+{
+    assert(start % pageSize == 0 && size % pageSize == 0 && source % pageSize == 0 && start + size <= 0x10000 && source + size <= 0x10000);
+    
+    for(uint32_t offset = 0; offset < size; offset += pageSize)
+    {
+        const uint8_t page = (start + offset) >> 8;
+        const uint8_t sourcePage = (source + offset) >> 8;
+        
+        readPages[page] = readPages[sourcePage];
+        storagePages[page] = storagePages[sourcePage];
+        handlers[page] = handlers[sourcePage];
+        writable[page] = writable[sourcePage];
+        watched[page] = watched[sourcePage];
+    }
+    
+    updateAliases();
+}
+
+void MemoryBus::mapHandler(uint16_t start, uint32_t size, Handler* handler)
+{
+    assert(start % pageSize == 0 && size % pageSize == 0 && start + size <= 0x10000 && handler != nullptr);
+    
+    for(uint32_t offset = 0; offset < size; offset += pageSize)
+    {
+        const uint8_t page = (start + offset) >> 8;
+        
+        readPages[page] = nullptr;
+        storagePages[page] = nullptr;
+        handlers[page] = handler;
+        writable[page] = false;
+    }
+    
+    updateAliases();
+}
+
+void MemoryBus::unmap(uint16_t start, uint32_t size)
+{
+    assert(start % pageSize == 0 && size % pageSize == 0 && start + size <= 0x10000);
+    
+    for(uint32_t offset = 0; offset < size; offset += pageSize)
+    {
+        const uint8_t page = (start + offset) >> 8;
+        
+        readPages[page] = emptyPage.data();
+        storagePages[page] = nullptr;
+        handlers[page] = nullptr;
+        writable[page] = false;
+    }
+    
+    updateAliases();
+}
+
+void MemoryBus::observeWrites(uint16_t start, uint32_t size, WriteObserver* observer)
+{
+    assert(start % pageSize == 0 && size % pageSize == 0 && start + size <= 0x10000);
+    
+    for(uint32_t offset = 0; offset < size; offset += pageSize)
+    {
+        const int storageAddress = getStorageAddress(start + offset);
+        assert(storageAddress >= 0);
+        
+        writeObservers[storageAddress >> 8] = observer;
+    }
+    
+    for(int page = 0; page < pageCount; ++page)
+    {
+        updateWritePage(page);
+    }
+}
+
+bool MemoryBus::load(uint16_t address, std::span<const uint8_t> data)
+{
+    if(address + data.size() > 0x10000)
+    {
+        return false;
+    }
+    
+    for(size_t index = 0; index < data.size(); ++index)
+    {
+        const uint16_t byteAddress = address + index;
+        
+        if(storagePages[byteAddress >> 8] == nullptr)
+        {
+            return false;
+        }
+        
+        storagePages[byteAddress >> 8][byteAddress & 0xFF] = data[index];
+    }
+    
+    return true;
+}
+
+void MemoryBus::watchPage(uint8_t page)
+{
+    forEachAlias(page << 8, [this](uint16_t aliasAddress)
+    {
+        watched[aliasAddress >> 8] = true;
+        updateWritePage(aliasAddress >> 8);
+    });
+}
+
+void MemoryBus::unwatchPage(uint8_t page)
+{
+    forEachAlias(page << 8, [this](uint16_t aliasAddress)
+    {
+        watched[aliasAddress >> 8] = false;
+        updateWritePage(aliasAddress >> 8);
+    });
+}
+
+uint8_t* MemoryBus::getStorage()
+{
+    return storage.data();
+}
+
+const uint8_t* MemoryBus::getStorage() const
+{
+    return storage.data();
+}
+
+const std::array<const uint8_t*, MemoryBus::pageCount>& MemoryBus::getReadPages() const
+{
+    return readPages;
+}
+
+void MemoryBus::mapStorage(uint16_t start, uint32_t size, bool canWrite)
+{
+    assert(start % pageSize == 0 && size % pageSize == 0 && start + size <= 0x10000);
+    
+    for(uint32_t offset = 0; offset < size; offset += pageSize)
+    {
+        const uint8_t page = (start + offset) >> 8;
+        
+        readPages[page] = storage.data() + (start + offset);
+        storagePages[page] = storage.data() + (start + offset);
+        handlers[page] = nullptr;
+        writable[page] = canWrite;
+    }
+    
+    updateAliases();
+}
+
+bool MemoryBus::writeSlow(uint16_t address, uint8_t value)
+{
+    const uint8_t page = address >> 8;
+    
+    if(handlers[page] != nullptr)
+    {
+        handlers[page]->write(address, value);
+        return false;
+    }
+    
+    //ROM, or nothing there at all
+    if(!writable[page])
+    {
+        return false;
+    }
+    
+    storagePages[page][address & 0xFF] = value;
+    
+    if(const int storageAddress = getStorageAddress(address); writeObservers[storageAddress >> 8] != nullptr)
+    {
+        writeObservers[storageAddress >> 8]->written(storageAddress);
+    }
+    
+    return watched[page];
+}
+
+void MemoryBus::updateWritePage(uint8_t page)
+{
+    const bool observed = storagePages[page] != nullptr && writeObservers[getStorageAddress(page << 8) >> 8] != nullptr;
+    writePages[page] = writable[page] && !watched[page] && !observed ? storagePages[page] : nullptr;
+}
+
+void MemoryBus::updateAliases()
+{
+    //Only pages over storage can share memory, handlers are given the address so each page is its own
+    for(int page = 0; page < pageCount; ++page)
+    {
+        nextAlias[page] = page;
+        
+        if(storagePages[page] == nullptr)
+        {
+            continue;
+        }
+        
+        for(int offset = 1; offset < pageCount; ++offset)
+        {
+            const uint8_t otherPage = page + offset;
+            
+            if(storagePages[otherPage] == storagePages[page])
+            {
+                nextAlias[page] = otherPage;
+                break;
+            }
+        }
+    }
+    
+    //A watch covers the memory, so carries over to anything newly mapped to it
+    for(int page = 0; page < pageCount; ++page)
+    {
+        if(watched[page])
+        {
+            forEachAlias(page << 8, [this](uint16_t aliasAddress)
+            {
+                watched[aliasAddress >> 8] = true;
+            });
+        }
+    }
+    
+    for(int page = 0; page < pageCount; ++page)
+    {
+        updateWritePage(page);
+    }
+}
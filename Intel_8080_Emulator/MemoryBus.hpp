@@ -0,0 +1,172 @@
+//
+//  MemoryBus.hpp
+//  Intel_8080_Emulator
+//
+
+#pragma once
+
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <span>
+
+//Maps the 64K address space onto memory a page of 256 bytes at a time
+//RAM and ROM pages are read through a pointer straight into storage, anything else is passed to a handler
+//Starts out as RAM all the way through, so a machine only has to map what is different
+class MemoryBus
+{
+public:
+    static constexpr int pageSize = 256;
+    static constexpr int pageCount = 256;
+    
+    //Anything on the bus that isn't plain memory, like memory mapped I/O
+    class Handler
+    {
+    public:
+        virtual ~Handler() = default;
+        
+        virtual uint8_t read(uint16_t address) = 0;
+        virtual void write(uint16_t address, uint8_t value) = 0;
+    };
+    
+    //Told about every write to RAM it is observing, through whichever page mapped to it the write came
+    class WriteObserver
+    {
+    public:
+        virtual ~WriteObserver() = default;
+        
+        virtual void written(uint16_t storageAddress) = 0;
+    };
+    
+    MemoryBus();
+    
+    //Pages point into the bus's own storage, so it can't be copied
+    MemoryBus(const MemoryBus&) = delete;
+    MemoryBus& operator=(const MemoryBus&) = delete;
+    
+    //Ranges have to start and end on page boundaries. RAM and ROM sit over the storage at the same address
+    void mapRAM(uint16_t start, uint32_t size);
+    void mapROM(uint16_t start, uint32_t size);
+    
+    //Maps the range to whatever is mapped from source, as it is now
+    void mapMirror(uint16_t start, uint32_t size, uint16_t source);
+    
+    void mapHandler(uint16_t start, uint32_t size, Handler* handler);
+    
+    //Nothing connected, reads give 0 and writes are dropped
+    void unmap(uint16_t start, uint32_t size);
+    
+    //Sends writes to the storage behind the range down the slow path, which tells the observer about them. Covers mirrors mapped before or after
+    void observeWrites(uint16_t start, uint32_t size, WriteObserver* observer);
+    
+    uint8_t read(uint16_t address) const;
+    
+    //Writes to ROM and unmapped pages are dropped. Returns true if the page is being watched
+    bool write(uint16_t address, uint8_t value);
+    
+    //Copies data into the storage behind the given addresses whether they are RAM or ROM, returns false if any of them are neither
+    bool load(uint16_t address, std::span<const uint8_t> data);
+    
+    //Sends every write to the page and any others mapped to the same memory down the slow path, which reports them
+    void watchPage(uint8_t page);
+    
+    //Lets writes to the page and the others mapped to the same memory go straight through again
+    void unwatchPage(uint8_t page);
+    bool isWatched(uint8_t page) const;
+    
+    //Only RAM pages can be written through the bus
+    bool isWritable(uint8_t page) const;
+    
+    //Calls function with the address itself and the matching address in each page mapped to the same memory
+    template<typename Function>
+    void forEachAlias(uint16_t address, Function function) const;
+    
+    uint8_t* getStorage();
+    const uint8_t* getStorage() const;
+    
+    //Where in storage the address ends up, or -1 if it isn't RAM or ROM
+    int getStorageAddress(uint16_t address) const;
+    
+    //Pointer to each page's memory, nullptr where it has a handler. For translated code to look up memory itself
+    const std::array<const uint8_t*, pageCount>& getReadPages() const;
+
+private:
+    void mapStorage(uint16_t start, uint32_t size, bool writable);
+    
+    bool writeSlow(uint16_t address, uint8_t value);
+    
+    //Direct write pointers are only kept for RAM pages that aren't watched
+    void updateWritePage(uint8_t page);
+    void updateAliases();
+    
+    std::array<const uint8_t*, pageCount> readPages{};
+    std::array<uint8_t*, pageCount> writePages{};
+    
+    //Memory behind RAM and ROM pages, whether or not they can be written directly
+    std::array<uint8_t*, pageCount> storagePages{};
+    std::array<Handler*, pageCount> handlers{};
+    
+    //Indexed by the page of storage rather than the page it is mapped to
+    std::array<WriteObserver*, pageCount> writeObservers{};
+    
+    std::bitset<pageCount> writable;
+    std::bitset<pageCount> watched;
+    
+    //Each page links to the next one mapped to the same memory, round in a loop back to itself
+    std::array<uint8_t, pageCount> nextAlias{};
+    
+    std::array<uint8_t, 65536> storage{};
+    
+    static const std::array<uint8_t, pageSize> emptyPage;
+};
+
+inline uint8_t MemoryBus::read(uint16_t address) const
+{
+    if(const uint8_t* page = readPages[address >> 8]; page != nullptr)
+    {
+        return page[address & 0xFF];
+    }
+    
+    return handlers[address >> 8]->read(address);
+}
+
+inline bool MemoryBus::write(uint16_t address, uint8_t value)
+{
+    if(uint8_t* page = writePages[address >> 8]; page != nullptr)
+    {
+        page[address & 0xFF] = value;
+        return false;
+    }
+    
+    return writeSlow(address, value);
+}
+
+inline int MemoryBus::getStorageAddress(uint16_t address) const
+{
+    const uint8_t* page = storagePages[address >> 8];
+    return page == nullptr ? -1 : int(page - storage.data()) + (address & 0xFF);
+}
+
+inline bool MemoryBus::isWatched(uint8_t page) const
+{
+    return watched[page];
+}
+
+inline bool MemoryBus::isWritable(uint8_t page) const
+{
+    return writable[page];
+}
+
+template<typename Function>
+void MemoryBus::forEachAlias(uint16_t address, Function function) const
+{
+    const uint8_t firstPage = address >> 8;
+    uint8_t page = firstPage;
+    
+    do
+    {
+        function(uint16_t(page << 8 | (address & 0xFF)));
+        page = nextAlias[page];
+    }
+    while(page != firstPage);
+}
@@ -0,0 +1,49 @@
+//
+//  NullMachine.hpp
+//  Intel_8080_Emulator
+//
+
+#pragma once
+
+#include "Intel_8080_Machine.hpp"
+
+#include <span>
+
+//The CPU with nothing connected, IN reads 0 and OUT does nothing, for running and benchmarking the CPU on its own
+//Memory is RAM all the way through
+class NullMachine : public Intel_8080_Machine<NullMachine>
+{
+    friend class Intel_8080_Machine<NullMachine>;
+
+public:
+    //Loads the program at the given address and starts running from there
+    bool loadProgram(std::span<const uint8_t> program, uint16_t address);
+    
+    using Intel_8080_Emulator::runFor;
+    using Intel_8080_Emulator::getCycleCount;
+    using Intel_8080_Emulator::getInstructionCount;
+    using Intel_8080_Emulator::setRecompilerEnabled;
+    using Intel_8080_Emulator::setProfile;
+    using Intel_8080_Emulator::setFusions;
+    using Intel_8080_Emulator::setSwitchDispatch;
+
+private:
+    uint8_t inputOperation(uint8_t port);
+    void outputOperation(uint8_t port, uint8_t value);
+};
+
+inline bool NullMachine::loadProgram(std::span<const uint8_t> program, uint16_t address)
+{
+    programCounter = address;
+    return loadMemory(address, program);
+}
+
+inline uint8_t NullMachine::inputOperation(uint8_t)
+{
+    return 0x0;
+}
+
+inline void NullMachine::outputOperation(uint8_t, uint8_t)
+{
+    
+}
@@ -0,0 +1,50 @@
+//
+//  OpcodeInfo.hpp
+//  Intel_8080_Emulator
+//
+
+#pragma once
+
+#include <cstdint>
+
+//What the recompilers need to know about an opcode without running it
+struct OpcodeInfo
+{
+    //Number of bytes the instruction takes up, including the opcode
+    static constexpr uint8_t getLength(uint8_t opcode)
+    {
+        //LXI, SHLD, LHLD, STA, LDA, JMP, CALL and the conditional jumps and calls, with the undocumented copies of JMP and CALL
+        if((opcode & 0xCF) == 0x01 || opcode == 0x22 || opcode == 0x2A || opcode == 0x32 || opcode == 0x3A || opcode == 0xC3 || opcode == 0xCB || (opcode & 0xCF) == 0xCD || (opcode & 0xC7) == 0xC2 || (opcode & 0xC7) == 0xC4)
+        {
+            return 3;
+        }
+        
+        //MVI, the immediate arithmetic ops, IN and OUT
+        if((opcode & 0xC7) == 0x06 || (opcode & 0xC7) == 0xC6 || opcode == 0xDB || opcode == 0xD3)
+        {
+            return 2;
+        }
+        
+        return 1;
+    }
+    
+    //Instructions that can move the program counter somewhere other than the next instruction
+    static constexpr bool isBranch(uint8_t opcode)
+    {
+        return opcode == 0xC3 || opcode == 0xCB || (opcode & 0xCF) == 0xCD || opcode == 0xC9 || opcode == 0xD9 || opcode == 0xE9 || (opcode & 0xC7) == 0xC2 || (opcode & 0xC7) == 0xC4 || (opcode & 0xC7) == 0xC0 || (opcode & 0xC7) == 0xC7;
+    }
+    
+    //Instructions the machine has to see happen one at a time, so are always left to the interpreter
+    static constexpr bool needsInterpreter(uint8_t opcode)
+    {
+        switch(opcode)
+        {
+            //IN, OUT, EI, DI and HLT
+            case 0xDB: case 0xD3: case 0xFB: case 0xF3: case 0x76:
+                return true;
+                
+            default:
+                return false;
+        }
+    }
+};
@@ -0,0 +1,58 @@
+//
+//  OpcodeProfile.cpp
+//  Intel_8080_Emulator
+//
+
+#include "OpcodeProfile.hpp"
+
+#include <iomanip>
+
+uint64_t OpcodeProfile::getCount(uint8_t firstOpcode, uint8_t secondOpcode) const
+{
+    return pairCounts[firstOpcode << 8 | secondOpcode];
+}
+
+uint64_t OpcodeProfile::getTotal() const
+{
+    return total;
+}
+
+void OpcodeProfile::save(std::ostream& output) const
+{
+    output << std::hex << std::uppercase << std::setfill('0');
+    
+    for(int pair = 0; pair < 65536; ++pair)
+    {
+        if(pairCounts[pair] != 0)
+        {
+            output << std::setw(2) << (pair >> 8) << " " << std::setw(2) << (pair & 0xFF) << " " << pairCounts[pair] << "\n";
+        }
+    }
+    
+    output << std::dec << std::nouppercase << std::setfill(' ');
+}
+
+bool OpcodeProfile::load(std::istream& input)
+{
+    pairCounts.fill(0);
+    total = 0;
+    
+    unsigned int firstOpcode;
+    unsigned int secondOpcode;
+    uint64_t count;
+    
+    while(input >> std::hex >> firstOpcode >> secondOpcode >> count)
+    {
+        if(firstOpcode > 0xFF || secondOpcode > 0xFF)
+        {
+            return false;
+        }
+        
+        pairCounts[firstOpcode << 8 | secondOpcode] += count;
+        total += count;
+    }
+    
+    input >> std::dec;
+    
+    return input.eof();
+}
@@ -0,0 +1,35 @@
+//
+//  OpcodeProfile.hpp
+//  Intel_8080_Emulator
+//
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+
+//How often each opcode ran straight after each other opcode, gathered from a run of a ROM to choose which instruction pairs to fuse
+class OpcodeProfile
+{
+public:
+    void record(uint8_t previousOpcode, uint8_t opcode);
+    
+    uint64_t getCount(uint8_t firstOpcode, uint8_t secondOpcode) const;
+    uint64_t getTotal() const;
+    
+    //One line per pair that ran, as the two opcodes and the count in hex
+    void save(std::ostream& output) const;
+    bool load(std::istream& input);
+
+private:
+    std::array<uint64_t, 65536> pairCounts{};
+    uint64_t total = 0;
+};
+
+inline void OpcodeProfile::record(uint8_t previousOpcode, uint8_t opcode)
+{
+    ++pairCounts[previousOpcode << 8 | opcode];
+    ++total;
+}
@@ -0,0 +1,72 @@
+//
+//  RecompiledProgram.cpp
+//  Intel_8080_Emulator
+//
+
+#include "RecompiledProgram.hpp"
+
+#include <vector>
+
+RecompiledProgram::RecompiledProgram(uint16_t start, uint16_t end, uint64_t checksum, std::span<const Block> programBlocks)  : romStart(start), romEnd(end), romChecksum(checksum)
+{
+    for(const Block& block : programBlocks)
+    {
+        blocks[block.address] = block.function;
+    }
+}
+
+uint64_t RecompiledProgram::calculateChecksum(const uint8_t* data, size_t size)
+{
+    //FNV-1a
+    uint64_t checksum = 0xCBF29CE484222325;
+    
+    for(size_t index = 0; index < size; ++index)
+    {
+        checksum = (checksum ^ data[index]) * 0x100000001B3;
+    }
+    
+    return checksum;
+}
+
+bool RecompiledProgram::matches(const MemoryBus& memoryBus) const
+{
+    std::vector<uint8_t> rom(romEnd - romStart);
+    
+    for(size_t index = 0; index < rom.size(); ++index)
+    {
+        rom[index] = memoryBus.read(romStart + index);
+    }
+    
+    return calculateChecksum(rom.data(), rom.size()) == romChecksum;
+}
+
+uint16_t RecompiledProgram::getROMStart() const
+{
+    return romStart;
+}
+
+uint16_t RecompiledProgram::getROMEnd() const
+{
+    return romEnd;
+}
+
+void RecompiledProgram::execute(Intel_8080_Emulator& cpu, uint64_t stopCycle) const
+{
+    BlockFunction block = blocks[cpu.programCounter];
+    
+    //Anywhere the disassembly didn't reach, like the targets of PCHL, is interpreted until it gets back to a known block
+    if(block == nullptr)
+    {
+        cpu.runCycle();
+        return;
+    }
+    
+    cpu.codeModified = false;
+    
+    //Blocks never hold instructions that halt or change interrupts, so can carry straight on from one to the next
+    do
+    {
+        block(cpu, stopCycle);
+    }
+    while(cpu.cycleCount < stopCycle && !cpu.codeModified && (block = blocks[cpu.programCounter]) != nullptr);
+}
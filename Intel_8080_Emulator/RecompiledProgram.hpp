@@ -0,0 +1,88 @@
+//
+//  RecompiledProgram.hpp
+//  Intel_8080_Emulator
+//
+
+#pragma once
+
+#include "Intel_8080_Emulator.hpp"
+
+#include <array>
+#include <cstdint>
+#include <span>
+
+//Basic blocks of a ROM translated ahead of time into C++ by StaticRecompiler, looked up by start address
+class RecompiledProgram
+{
+public:
+    using BlockFunction = void (*)(Intel_8080_Emulator& cpu, uint64_t stopCycle);
+    
+    struct Block
+    {
+        uint16_t address;
+        BlockFunction function;
+    };
+    
+    //The checksum is of the ROM the blocks were generated from, so they are never run against anything else
+    RecompiledProgram(uint16_t start, uint16_t end, uint64_t checksum, std::span<const Block> programBlocks);
+    
+    static uint64_t calculateChecksum(const uint8_t* data, size_t size);
+    
+    //Whether the ROM these blocks were generated from is still what the bus reads
+    bool matches(const MemoryBus& memoryBus) const;
+    
+    uint16_t getROMStart() const;
+    uint16_t getROMEnd() const;
+    
+    //Runs blocks from the program counter until stopCycle or an address without one, which is interpreted a single instruction at a time
+    void execute(Intel_8080_Emulator& cpu, uint64_t stopCycle) const;
+    
+    //Generated code reaches the emulator's state through these
+    static RegisterManager& getRegisters(Intel_8080_Emulator& cpu);
+    static uint8_t readMemory(const Intel_8080_Emulator& cpu, uint16_t address);
+    static void setProgramCounter(Intel_8080_Emulator& cpu, uint16_t address);
+    
+    //Runs an instruction through its interpreter handler
+    static void executeOpcode(Intel_8080_Emulator& cpu, uint16_t address, uint8_t opcode);
+    
+    //Counts the instruction's cycles, returns true if the block has to stop, either because that reached stopCycle or the instruction wrote over the ROM
+    static bool finishInstruction(Intel_8080_Emulator& cpu, uint8_t opcode, uint64_t stopCycle);
+
+private:
+    uint16_t romStart;
+    uint16_t romEnd;
+    uint64_t romChecksum;
+    
+    std::array<BlockFunction, 65536> blocks{};
+};
+
+inline RegisterManager& RecompiledProgram::getRegisters(Intel_8080_Emulator& cpu)
+{
+    return cpu.registers;
+}
+
+inline uint8_t RecompiledProgram::readMemory(const Intel_8080_Emulator& cpu, uint16_t address)
+{
+    return cpu.readMemory(address);
+}
+
+inline void RecompiledProgram::setProgramCounter(Intel_8080_Emulator& cpu, uint16_t address)
+{
+    cpu.programCounter = address;
+}
+
+inline void RecompiledProgram::executeOpcode(Intel_8080_Emulator& cpu, uint16_t address, uint8_t opcode)
+{
+    //Handlers read their operands from the program counter and move it on themselves
+    cpu.programCounter = address;
+    cpu.currentOpcode = opcode;
+    cpu.decodeAndExecute(opcode);
+}
+
+inline bool RecompiledProgram::finishInstruction(Intel_8080_Emulator& cpu, uint8_t opcode, uint64_t stopCycle)
+{
+    cpu.cycleCount += Intel_8080_Emulator::opCycles[opcode];
+    ++cpu.opCounter;
+    
+    return cpu.cycleCount >= stopCycle || cpu.codeModified;
+}
@@ -8,27 +8,37 @@
 #pragma once
 
 #include <array>
-#include <optional>
+#include <bit>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
 
 class RegisterManager
 {
+    //Pairs are stored in host byte order so they can be read as native 16 bit values.
+    //This is the offset of the high order register within each pair
+    static constexpr uint8_t highOrderOffset = std::endian::native == std::endian::little ? 1 : 0;
+    
+    //Translated code reads and writes the storage directly
+    friend class DynamicRecompiler;
+    
 public:
     RegisterManager();
     
-    enum class Register
+    //Values are the register's index in storage
+    enum class Register : uint8_t
     {
-        B,
-        C,
-        D,
-        E,
-        H,
-        L,
-        W,
-        Z,
-        A
+        B = 0 + highOrderOffset,
+        C = 1 - highOrderOffset,
+        D = 2 + highOrderOffset,
+        E = 3 - highOrderOffset,
+        H = 4 + highOrderOffset,
+        L = 5 - highOrderOffset,
+        A = 8
     };
     
-    enum class RegisterPair
+    //Values are the pair's index in storage
+    enum class RegisterPair : uint8_t
     {
         BC,
         DE,
@@ -43,16 +53,61 @@ public:
     void setRegisterPair(RegisterPair pair, uint8_t highOrderVal, uint8_t lowOrderVal);
     void setRegisterPair(RegisterPair pair, uint16_t val);
     
-    static std::optional<Register>  getRegFromEncodedValue(uint8_t value);
+    //The encoded value 110 refers to memory not a register so must not be passed in
+    static Register getRegFromEncodedValue(uint8_t value);
     static RegisterPair getPairFromEncodedValue(uint8_t value);
     
 private:
+    static constexpr std::array<Register, 8> encodedRegisters
+    {
+        Register::B,
+        Register::C,
+        Register::D,
+        Register::E,
+        Register::H,
+        Register::L,
+        Register::A,
+        Register::A
+    };
     
-    //Returns the first register in the pair
-    Register regFromPair(RegisterPair pair) const;
-    Register nextReg(Register reg) const;
-    
-    std::array<uint8_t, 9> registers;
-    
-    uint16_t stackPointer = 0;
+    //BC, DE, HL and SP as pairs followed by A
+    std::array<uint8_t, 9> registers{};
 };
+
+inline uint8_t RegisterManager::getRegisterValue(Register reg) const
+{
+    return registers[static_cast<uint8_t>(reg)];
+}
+
+inline void RegisterManager::setRegisterValue(Register reg, uint8_t newValue)
+{
+    registers[static_cast<uint8_t>(reg)] = newValue;
+}
+
+inline uint16_t RegisterManager::getValueFromRegisterPair(RegisterPair pair) const
+{
+    uint16_t val;
+    std::memcpy(&val, registers.data() + static_cast<uint8_t>(pair) * 2, sizeof(val));
+    return val;
+}
+
+inline void RegisterManager::setRegisterPair(RegisterPair pair, uint8_t highOrderVal, uint8_t lowOrderVal)
+{
+    setRegisterPair(pair, uint16_t((highOrderVal << 8) | lowOrderVal));
+}
+
+inline void RegisterManager::setRegisterPair(RegisterPair pair, uint16_t val)
+{
+    std::memcpy(registers.data() + static_cast<uint8_t>(pair) * 2, &val, sizeof(val));
+}
+
+inline RegisterManager::Register RegisterManager::getRegFromEncodedValue(uint8_t value)
+{
+    assert((value & 0x7) != 0x6);
+    return encodedRegisters[value & 0x7];
+}
+
+inline RegisterManager::RegisterPair RegisterManager::getPairFromEncodedValue(uint8_t value)
+{
+    return static_cast<RegisterPair>(value & 0x3);
+}
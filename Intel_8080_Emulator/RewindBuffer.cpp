@@ -0,0 +1,259 @@
+//
+//  RewindBuffer.cpp
+//  Intel_8080_Emulator
+//
+
+#include "RewindBuffer.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+namespace
+{
+    //Bookkeeping a stored frame costs on top of its bytes
+    constexpr size_t frameOverhead = sizeof(std::vector<uint8_t>);
+    
+    void appendVarint(std::vector<uint8_t>& data, uint64_t value)
+    {
+        while(value >= 0x80)
+        {
+            data.push_back(uint8_t(value) | 0x80);
+            value >>= 7;
+        }
+        
+        data.push_back(value);
+    }
+    
+    uint64_t takeVarint(const std::vector<uint8_t>& data, size_t& position)
+    {
+        uint64_t value = 0;
+        
+        for(int shift = 0; position < data.size(); shift += 7)
+        {
+            const uint8_t nextByte = data[position++];
+            value |= uint64_t(nextByte & 0x7F) << shift;
+            
+            if(!(nextByte & 0x80))
+            {
+                break;
+            }
+        }
+        
+        return value;
+    }
+}
+
+RewindBuffer::RewindBuffer(size_t budget, int interval)  : memoryBudget(budget), keyframeInterval(std::max(interval, 1))
+{
+    
+}
+
+void RewindBuffer::push(const Snapshot& snapshot)
+{
+    currentBytes.clear();
+    snapshot.write(currentBytes);
+    
+    if(groups.empty() || groups.back().deltas.size() + 1 >= keyframeInterval)
+    {
+        //Only the pages that differ from the keyframe before take up any more memory
+        const size_t keyframeBytes = snapshot.getMemoryUsed(groups.empty() ? nullptr : &groups.back().keyframe);
+        
+        Group& group = groups.emplace_back();
+        group.keyframe = snapshot;
+        group.bytes = keyframeBytes;
+        
+        memoryUsed += keyframeBytes;
+    }
+    else
+    {
+        Group& group = groups.back();
+        std::vector<uint8_t>& delta = group.deltas.emplace_back();
+        
+        encodeDelta(latestBytes, currentBytes, delta);
+        delta.shrink_to_fit();
+        
+        group.bytes += delta.size() + frameOverhead;
+        memoryUsed += delta.size() + frameOverhead;
+    }
+    
+    ++frameCount;
+    std::swap(latestBytes, currentBytes);
+    
+    //The latest group is always kept, however big it is
+    while(memoryUsed > memoryBudget && groups.size() > 1)
+    {
+        //Pages the next keyframe shared with the oldest are now only held by it
+        Group& next = groups[1];
+        const size_t sharedBytes = next.keyframe.getMemoryUsed() - next.keyframe.getMemoryUsed(&groups.front().keyframe);
+        
+        next.bytes += sharedBytes;
+        memoryUsed += sharedBytes;
+        
+        memoryUsed -= groups.front().bytes;
+        frameCount -= groups.front().deltas.size() + 1;
+        groups.pop_front();
+    }
+}
+
+bool RewindBuffer::getFrame(size_t framesBack, Snapshot& snapshot) const
+{
+    if(framesBack >= frameCount)
+    {
+        return false;
+    }
+    
+    //Counted from the latest, so work back through the groups from the end
+    size_t remaining = framesBack;
+    
+    for(auto group = groups.rbegin(); group != groups.rend(); ++group)
+    {
+        const size_t groupFrames = group->deltas.size() + 1;
+        
+        if(remaining >= groupFrames)
+        {
+            remaining -= groupFrames;
+            continue;
+        }
+        
+        const size_t deltaCount = groupFrames - 1 - remaining;
+        
+        if(deltaCount == 0)
+        {
+            snapshot = group->keyframe;
+            return true;
+        }
+        
+        std::vector<uint8_t> bytes;
+        rebuildBytes(*group, deltaCount, bytes);
+        
+        return snapshot.read(bytes);
+    }
+    
+    return false;
+}
+
+void RewindBuffer::dropLatest(size_t dropCount)
+{
+    dropCount = std::min(dropCount, frameCount);
+    
+    while(dropCount > 0)
+    {
+        Group& group = groups.back();
+        
+        if(group.deltas.empty())
+        {
+            memoryUsed -= group.bytes;
+            groups.pop_back();
+        }
+        else
+        {
+            const size_t deltaBytes = group.deltas.back().size() + frameOverhead;
+            group.bytes -= deltaBytes;
+            memoryUsed -= deltaBytes;
+            group.deltas.pop_back();
+        }
+        
+        --frameCount;
+        --dropCount;
+    }
+    
+    //Deltas carry on from whatever is now the latest frame
+    latestBytes.clear();
+    
+    if(!groups.empty())
+    {
+        rebuildBytes(groups.back(), groups.back().deltas.size(), latestBytes);
+    }
+}
+
+size_t RewindBuffer::getFrameCount() const
+{
+    return frameCount;
+}
+
+size_t RewindBuffer::getMemoryUsed() const
+{
+    return memoryUsed;
+}
+
+void RewindBuffer::rebuildBytes(const Group& group, size_t deltaCount, std::vector<uint8_t>& bytes) const
+{
+    group.keyframe.write(bytes);
+    
+    for(size_t delta = 0; delta < deltaCount; ++delta)
+    {
+        applyDelta(group.deltas[delta], bytes);
+    }
+}
+
+//Delta layout, as varints
+//    the length of the new layout
+//    then until it is covered, a run of bytes that are the same followed by a count of literal bytes, then the XOR of each
+void RewindBuffer::encodeDelta(const std::vector<uint8_t>& previous, const std::vector<uint8_t>& current, std::vector<uint8_t>& delta)
+{
+    appendVarint(delta, current.size());
+    
+    const auto previousByte = [&previous](size_t index)
+    {
+        return index < previous.size() ? previous[index] : uint8_t(0x0);
+    };
+    
+    size_t position = 0;
+    
+    while(position < current.size())
+    {
+        const size_t sameStart = position;
+        
+        while(position < current.size() && current[position] == previousByte(position))
+        {
+            ++position;
+        }
+        
+        if(position == current.size())
+        {
+            break;
+        }
+        
+        //A short run of the same bytes inside changed ones is cheaper kept as literals than as a new pair of counts
+        const size_t literalStart = position;
+        size_t sameCount = 0;
+        
+        while(position < current.size() && sameCount < 4)
+        {
+            sameCount = current[position] == previousByte(position) ? sameCount + 1 : 0;
+            ++position;
+        }
+        
+        const size_t literalEnd = position - sameCount;
+        position = literalEnd;
+        
+        appendVarint(delta, literalStart - sameStart);
+        appendVarint(delta, literalEnd - literalStart);
+        
+        for(size_t index = literalStart; index < literalEnd; ++index)
+        {
+            delta.push_back(current[index] ^ previousByte(index));
+        }
+    }
+}
+
+void RewindBuffer::applyDelta(const std::vector<uint8_t>& delta, std::vector<uint8_t>& bytes)
+{
+    size_t position = 0;
+    bytes.resize(takeVarint(delta, position), 0x0);
+    
+    size_t index = 0;
+    
+    while(position < delta.size())
+    {
+        index += takeVarint(delta, position);
+        const size_t literalCount = takeVarint(delta, position);
+        
+        assert(index + literalCount <= bytes.size() && position + literalCount <= delta.size());
+        
+        for(size_t literal = 0; literal < literalCount; ++literal)
+        {
+            bytes[index++] ^= delta[position++];
+        }
+    }
+}
@@ -0,0 +1,67 @@
+//
+//  RewindBuffer.hpp
+//  Intel_8080_Emulator
+//
+
+#pragma once
+
+#include "Snapshot.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+//The recent history of a machine, a snapshot per frame, for stepping back through it
+//Every keyframeInterval frames a whole snapshot is kept, sharing its pages with the keyframe before it
+//Frames in between are kept as the XOR of their file layout against the frame before, run length encoded, which is mostly runs of 0
+//Getting a frame back costs one keyframe plus at most keyframeInterval - 1 deltas
+class RewindBuffer
+{
+public:
+    //The oldest keyframe and the frames after it are dropped whenever the buffer goes over memoryBudget bytes
+    explicit RewindBuffer(size_t memoryBudget = 16 << 20, int keyframeInterval = 60);
+    
+    //Adds the state at the end of a frame, taken with snapshot()
+    void push(const Snapshot& snapshot);
+    
+    //Rebuilds the state the given number of frames before the latest, 0 being the latest
+    //Returns false if that frame isn't held any more
+    bool getFrame(size_t framesBack, Snapshot& snapshot) const;
+    
+    //Drops the latest frames, for carrying on from one stepped back to
+    void dropLatest(size_t frameCount);
+    
+    size_t getFrameCount() const;
+    
+    //Roughly what the frames held take up, pages shared between keyframes are only counted once
+    size_t getMemoryUsed() const;
+    
+private:
+    struct Group
+    {
+        Snapshot keyframe;
+        
+        //One for each frame after the keyframe
+        std::vector<std::vector<uint8_t>> deltas;
+        
+        size_t bytes = 0;
+    };
+    
+    //The layout of the given frame in the group, rebuilt from its keyframe
+    void rebuildBytes(const Group& group, size_t deltaCount, std::vector<uint8_t>& bytes) const;
+    
+    static void encodeDelta(const std::vector<uint8_t>& previous, const std::vector<uint8_t>& current, std::vector<uint8_t>& delta);
+    static void applyDelta(const std::vector<uint8_t>& delta, std::vector<uint8_t>& bytes);
+    
+    size_t memoryBudget;
+    size_t keyframeInterval;
+    
+    std::deque<Group> groups;
+    size_t frameCount = 0;
+    size_t memoryUsed = 0;
+    
+    //Layout of the latest frame, for working out the next delta
+    std::vector<uint8_t> latestBytes;
+    std::vector<uint8_t> currentBytes;
+};
@@ -0,0 +1,55 @@
+//
+//  SPSCQueue.hpp
+//  Intel_8080_Emulator
+//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+//Fixed size lock free queue for passing values from exactly one thread to exactly one other
+template<typename Type, size_t capacity>
+class SPSCQueue
+{
+public:
+    static_assert((capacity & (capacity - 1)) == 0, "Capacity must be a power of two");
+    
+    //Returns false if the queue is full and the value was dropped
+    bool push(const Type& value)
+    {
+        const size_t currentTail = tail.load(std::memory_order_relaxed);
+        
+        if(currentTail - head.load(std::memory_order_acquire) == capacity)
+        {
+            return false;
+        }
+        
+        values[currentTail & (capacity - 1)] = value;
+        tail.store(currentTail + 1, std::memory_order_release);
+        return true;
+    }
+    
+    //Returns false if there was nothing to pop
+    bool pop(Type& value)
+    {
+        const size_t currentHead = head.load(std::memory_order_relaxed);
+        
+        if(currentHead == tail.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+        
+        value = values[currentHead & (capacity - 1)];
+        head.store(currentHead + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    std::array<Type, capacity> values;
+    
+    //Each end is only written by one thread, so keep them on separate cache lines
+    alignas(64) std::atomic<size_t> head{0};
+    alignas(64) std::atomic<size_t> tail{0};
+};
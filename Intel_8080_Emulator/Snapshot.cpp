@@ -0,0 +1,194 @@
+//
+//  Snapshot.cpp
+//  Intel_8080_Emulator
+//
+
+#include "Snapshot.hpp"
+
+#include <algorithm>
+#include <iterator>
+
+namespace
+{
+    constexpr std::array<char, 8> snapshotMagic{'8', '0', '8', '0', 'S', 'N', 'A', 'P'};
+    
+    //Bigger than any machine's own state should ever be, so a damaged length can't ask for gigabytes
+    constexpr uint32_t maxMachineStateBytes = 1 << 20;
+    constexpr uint32_t maxEvents = 1 << 16;
+}
+
+//Layout, each value little endian
+//    8 bytes   magic "8080SNAP"
+//    4 bytes   format version
+//    8 bytes   cycle count
+//    8 bytes   instruction count
+//    2 bytes   each for PC, BC, DE, HL and SP
+//    1 byte    each for A, flags, interrupts enabled and halted
+//    4 bytes   number of scheduled events, then 8 bytes for the cycle and 1 for the id of each
+//    65536     memory
+//    4 bytes   length of the machine's own state, then the state
+void Snapshot::write(std::vector<uint8_t>& data) const
+{
+    data.reserve(data.size() + pages.size() * MemoryBus::pageSize + machineState.size() + 256);
+    data.insert(data.end(), snapshotMagic.begin(), snapshotMagic.end());
+    
+    appendValue(data, formatVersion, 4);
+    appendValue(data, cycleCount, 8);
+    appendValue(data, instructionCount, 8);
+    
+    for(uint16_t pair : {programCounter, bc, de, hl, stackPointer})
+    {
+        appendValue(data, pair, 2);
+    }
+    
+    for(uint8_t value : {accumulator, flags, uint8_t(interrupts), uint8_t(halted)})
+    {
+        appendValue(data, value, 1);
+    }
+    
+    appendValue(data, events.size(), 4);
+    
+    for(const Event& event : events)
+    {
+        appendValue(data, event.cycle, 8);
+        appendValue(data, event.eventId, 1);
+    }
+    
+    for(const std::shared_ptr<const Page>& page : pages)
+    {
+        if(page)
+        {
+            data.insert(data.end(), page->begin(), page->end());
+        }
+        else
+        {
+            data.insert(data.end(), MemoryBus::pageSize, 0x0);
+        }
+    }
+    
+    appendValue(data, machineState.size(), 4);
+    data.insert(data.end(), machineState.begin(), machineState.end());
+}
+
+void Snapshot::write(std::ostream& output) const
+{
+    std::vector<uint8_t> data;
+    write(data);
+    
+    output.write(reinterpret_cast<const char*>(data.data()), data.size());
+}
+
+bool Snapshot::read(std::span<const uint8_t> data)
+{
+    //Everything up to the memory, in the order of the layout above
+    constexpr std::array<int, 13> sizes{4, 8, 8, 2, 2, 2, 2, 2, 1, 1, 1, 1, 4};
+    constexpr size_t fixedBytes = snapshotMagic.size() + 4 + 8 + 8 + 2 * 5 + 4 + 4;
+    
+    if(data.size() < fixedBytes || !std::equal(snapshotMagic.begin(), snapshotMagic.end(), data.begin()))
+    {
+        return false;
+    }
+    
+    data = data.subspan(snapshotMagic.size());
+    
+    std::array<uint64_t, sizes.size()> values;
+    
+    for(size_t index = 0; index < sizes.size(); ++index)
+    {
+        values[index] = takeValue(data, sizes[index]);
+    }
+    
+    const uint64_t eventCount = values[12];
+    
+    if(values[0] != formatVersion || eventCount > maxEvents || data.size() < eventCount * 9 + pages.size() * MemoryBus::pageSize + 4)
+    {
+        return false;
+    }
+    
+    //Filled in separately so a file cut short leaves this one alone
+    Snapshot loaded;
+    
+    loaded.cycleCount = values[1];
+    loaded.instructionCount = values[2];
+    loaded.programCounter = values[3];
+    loaded.bc = values[4];
+    loaded.de = values[5];
+    loaded.hl = values[6];
+    loaded.stackPointer = values[7];
+    loaded.accumulator = values[8];
+    loaded.flags = values[9];
+    loaded.interrupts = values[10] != 0;
+    loaded.halted = values[11] != 0;
+    
+    loaded.events.resize(eventCount);
+    
+    for(Event& event : loaded.events)
+    {
+        event.cycle = takeValue(data, 8);
+        event.eventId = takeValue(data, 1);
+    }
+    
+    for(std::shared_ptr<const Page>& page : loaded.pages)
+    {
+        auto newPage = std::make_shared<Page>();
+        std::copy_n(data.begin(), newPage->size(), newPage->begin());
+        
+        data = data.subspan(newPage->size());
+        page = std::move(newPage);
+    }
+    
+    const uint64_t machineStateSize = takeValue(data, 4);
+    
+    if(machineStateSize > maxMachineStateBytes || data.size() < machineStateSize)
+    {
+        return false;
+    }
+    
+    loaded.machineState.assign(data.begin(), data.begin() + machineStateSize);
+    
+    *this = std::move(loaded);
+    return true;
+}
+
+bool Snapshot::read(std::istream& input)
+{
+    const std::vector<uint8_t> data(std::istreambuf_iterator<char>(input), {});
+    return read(data);
+}
+
+size_t Snapshot::getMemoryUsed(const Snapshot* sharingWith) const
+{
+    size_t bytes = sizeof(Snapshot) + events.capacity() * sizeof(Event) + machineState.capacity();
+    
+    for(size_t page = 0; page < pages.size(); ++page)
+    {
+        if(pages[page] && (sharingWith == nullptr || pages[page] != sharingWith->pages[page]))
+        {
+            bytes += sizeof(Page);
+        }
+    }
+    
+    return bytes;
+}
+
+void Snapshot::appendValue(std::vector<uint8_t>& data, uint64_t value, int bytes)
+{
+    for(int byte = 0; byte < bytes; ++byte)
+    {
+        data.push_back(value >> (byte * 8));
+    }
+}
+
+uint64_t Snapshot::takeValue(std::span<const uint8_t>& data, int bytes)
+{
+    uint64_t value = 0;
+    
+    for(int byte = 0; byte < bytes && byte < int(data.size()); ++byte)
+    {
+        value |= uint64_t(data[byte]) << (byte * 8);
+    }
+    
+    data = data.subspan(std::min<size_t>(bytes, data.size()));
+    
+    return value;
+}
@@ -0,0 +1,77 @@
+//
+//  Snapshot.hpp
+//  Intel_8080_Emulator
+//
+
+#pragma once
+
+#include "MemoryBus.hpp"
+
+#include <array>
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <span>
+#include <vector>
+
+//The state of a machine at one point, taken with snapshot() and put back with restore()
+//Memory is held as pages that are never changed once made, shared between every snapshot they are the same in
+//A new snapshot only copies the pages written since the last one taken or restored, so many branches from one state cost little more than one
+class Snapshot
+{
+    friend class Intel_8080_Emulator;
+    
+public:
+    using Page = std::array<uint8_t, MemoryBus::pageSize>;
+    
+    //Bumped whenever the file layout or the meaning of anything in it changes, including each machine's own state, files from any other version are refused
+    static constexpr uint32_t formatVersion = 1;
+    
+    //Little endian throughout, so files can move between hosts. The vector version appends to what is already there
+    void write(std::ostream& output) const;
+    void write(std::vector<uint8_t>& data) const;
+    
+    //Returns false if it isn't a snapshot file of this version, leaving the snapshot as it was. Reads the stream to the end
+    bool read(std::istream& input);
+    bool read(std::span<const uint8_t> data);
+    
+    //Roughly how much memory it takes up, not counting the pages it shares with the other snapshot if one is given
+    size_t getMemoryUsed(const Snapshot* sharingWith = nullptr) const;
+    
+    //Little endian helpers for machines saving their own state
+    static void appendValue(std::vector<uint8_t>& data, uint64_t value, int bytes);
+    
+    //Takes the value off the front of data, anything past the end reads as 0
+    static uint64_t takeValue(std::span<const uint8_t>& data, int bytes);
+    
+private:
+    struct Event
+    {
+        uint64_t cycle;
+        uint8_t eventId;
+    };
+    
+    //Everything behind the RAM and ROM pages, as it sits in the memory bus. Empty until a snapshot is taken or read
+    std::array<std::shared_ptr<const Page>, MemoryBus::pageCount> pages;
+    
+    uint64_t cycleCount = 0;
+    uint64_t instructionCount = 0;
+    
+    uint16_t programCounter = 0;
+    uint16_t bc = 0;
+    uint16_t de = 0;
+    uint16_t hl = 0;
+    uint16_t stackPointer = 0;
+    uint8_t accumulator = 0;
+    uint8_t flags = 0;
+    
+    bool interrupts = false;
+    bool halted = false;
+    
+    //Latest first, the same as the emulator keeps them
+    std::vector<Event> events;
+    
+    //Written and read by the machine
+    std::vector<uint8_t> machineState;
+};
@@ -6,16 +6,25 @@
 //
 
 #include "SpaceInvaders.hpp"
-#include <thread>
+
+#include <algorithm>
+#include <iterator>
+#include <vector>
 
 SpaceInvaders::SpaceInvaders()
 {
-    if(debugMode ? !loadTest() : !loadGame())
-    {
-        std::cout << "Warning game failed to load" << std::endl;
-        assert(false);
-        return;
-    }
+    //Address line 15 isn't connected, so the top half of memory mirrors the bottom. RAM mirrors again from 0x4000 up to there
+    memoryBus.mapROM(0x0, romSize);
+    memoryBus.mapRAM(0x2000, 0x2000);
+    memoryBus.mapMirror(0x4000, 0x2000, 0x2000);
+    memoryBus.mapMirror(0x6000, 0x2000, 0x2000);
+    memoryBus.mapMirror(0x8000, 0x8000, 0x0);
+    
+    memoryBus.observeWrites(videoMemoryStart, videoMemoryEnd - videoMemoryStart, this);
+    
+    //Timed from power on so every run interrupts on exactly the same cycles
+    scheduleEvent(midScreenCycle, MidScreen);
+    scheduleEvent(cyclesPerFrame, EndOfScreen);
 }
 
 SpaceInvaders::~SpaceInvaders()
@@ -23,67 +32,107 @@ SpaceInvaders::~SpaceInvaders()
     
 }
 
-void SpaceInvaders::run()
+void SpaceInvaders::runFrame()
+{
+    runFor(startFrame());
+}
+
+void SpaceInvaders::runFrame(const Inputs& frameInputs)
 {
-    // Create the main window
-    sf::RenderWindow mainWindow(sf::VideoMode(800, 600), "Space Invaders");
+    //Run the whole frame's worth of instructions in one batch
+    runFor(startFrame(frameInputs));
+}
 
-    lastHalfFrameTime = std::chrono::steady_clock::now();
-    onFirstHalf = true;
+uint64_t SpaceInvaders::startFrame()
+{
+    processKeyEvents();
     
-    while(mainWindow.isOpen())
-    {
-        const auto currentTime = std::chrono::steady_clock::now();
-        const double timeDifferenceMS = std::chrono::duration<double>(currentTime - lastHalfFrameTime).count() * 1000.0;
-        
-        if(timeDifferenceMS > halfFrameTimeMS)
-        {
-            uint8_t restartNum = onFirstHalf ? 2 : 2;
-            
-            performInterrupt(0xD7);
-            
-            lastHalfFrameTime = currentTime;
-            onFirstHalf = !onFirstHalf;
-        }
-        
-        runCycle();
-        
-        // Process events
-        sf::Event event;
-        while(mainWindow.pollEvent(event))
-        {
-            // Close window: exit
-            if(event.type == sf::Event::Closed)
-            {
-                mainWindow.close();
-            }
+    return startFrame(getInputsFromKeys());
+}
 
-            // Escape pressed: exit
-            if(event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::Escape)
-            {
-                mainWindow.close();
-            }
-        }
+uint64_t SpaceInvaders::startFrame(const Inputs& frameInputs)
+{
+    //Latched for the frame, so what the game reads only depends on what the frame was given
+    inputs = frameInputs;
+    
+    const uint64_t cycles = frameEndCycle - getCycleCount();
+    frameEndCycle += cyclesPerFrame;
+    
+    return cycles;
+}
 
-        // Clear screen
-        mainWindow.clear();
+const SpaceInvaders::Inputs& SpaceInvaders::getInputs() const
+{
+    return inputs;
+}
 
-        // Update the window
-        mainWindow.display();
+void SpaceInvaders::triggerKeyDown(int keycode, int, int)
+{
+    keyEvents.push({keycode, true});
+}
+
+void SpaceInvaders::triggerKeyUp(int keycode, int, int)
+{
+    keyEvents.push({keycode, false});
+}
+
+const uint8_t* SpaceInvaders::getVideoMemory() const
+{
+    return memoryBus.getStorage() + videoMemoryStart;
+}
+
+std::bitset<SpaceInvaders::videoRowCount> SpaceInvaders::takeDirtyVideoRows()
+{
+    const std::bitset<videoRowCount> rows = dirtyVideoRows;
+    dirtyVideoRows.reset();
+    return rows;
+}
+
+const uint8_t* SpaceInvaders::getROM() const
+{
+    return memoryBus.getStorage();
+}
+
+void SpaceInvaders::setSoundOutput(std::ostream* output)
+{
+    soundOutput = output;
+}
+
+uint64_t SpaceInvaders::getRAMHash() const
+{
+    uint64_t hash = 0xCBF29CE484222325;
+    
+    for(uint16_t address = romSize; address < videoMemoryEnd; ++address)
+    {
+        hash = (hash ^ memoryBus.getStorage()[address]) * 0x100000001B3;
     }
+    
+    return hash;
 }
 
-void SpaceInvaders::triggerKeyDown(int keycode, int x, int y)
+uint64_t SpaceInvaders::getROMHash() const
 {
-    if(std::find(currentlyDownKeys.cbegin(), currentlyDownKeys.cend(), keycode) == currentlyDownKeys.cend())
+    uint64_t hash = 0xCBF29CE484222325;
+    
+    for(uint16_t address = 0; address < romSize; ++address)
     {
-        currentlyDownKeys.push_back(keycode);
+        hash = (hash ^ memoryBus.getStorage()[address]) * 0x100000001B3;
     }
+    
+    return hash;
 }
 
-void SpaceInvaders::triggerKeyUp(int keycode, int x, int y)
+void SpaceInvaders::processKeyEvents()
 {
-    currentlyDownKeys.erase(std::remove(currentlyDownKeys.begin(), currentlyDownKeys.end(), keycode), currentlyDownKeys.end());
+    KeyEvent keyEvent;
+    
+    while(keyEvents.pop(keyEvent))
+    {
+        if(keyEvent.keycode >= 0 && keyEvent.keycode < int(downKeys.size()))
+        {
+            downKeys[keyEvent.keycode] = keyEvent.down;
+        }
+    }
 }
 
 uint8_t SpaceInvaders::inputOperation(uint8_t port)
@@ -91,27 +140,10 @@ uint8_t SpaceInvaders::inputOperation(uint8_t port)
     switch (port)
     {
         case 0x1:
-        {
-            uint8_t retVal = 0x8;
+            return inputs.port1;
             
-            //Space Key
-            if(checkKeyDown(32))
-            {
-                retVal |= 0x15;
-            }
-            
-            //Left Key
-            if(checkKeyDown(100))
-            {
-                retVal |= 0x20;
-            }
-            
-            //Right Key
-            if(checkKeyDown(102))
-            {
-                retVal |= 0x40;
-            }
-        }
+        case 0x2:
+            return inputs.port2;
             
         //Shift the data and read
         case 0x3:
@@ -139,24 +171,29 @@ void SpaceInvaders::outputOperation(uint8_t port, uint8_t value)
         //Discrete Sounds
         case 0x3:
         {
+            if(soundOutput == nullptr)
+            {
+                return;
+            }
+            
             if(value & 0x80)
             {
-                std::cout << "UFO SOUND" << std::endl;
+                *soundOutput << "UFO SOUND" << std::endl;
             }
             
             if(value & 0x40)
             {
-                std::cout << "SHOT SOUND" << std::endl;
+                *soundOutput << "SHOT SOUND" << std::endl;
             }
             
             if(value & 0x20)
             {
-                std::cout << "FLASH SOUND" << std::endl;
+                *soundOutput << "FLASH SOUND" << std::endl;
             }
             
             if(value & 0x10)
             {
-                std::cout << "DEATH SOUND" << std::endl;
+                *soundOutput << "DEATH SOUND" << std::endl;
             }
             return;
         }
@@ -173,15 +210,66 @@ void SpaceInvaders::outputOperation(uint8_t port, uint8_t value)
     }
 }
 
-bool SpaceInvaders::loadGame()
+void SpaceInvaders::handleEvent(uint8_t eventId, uint64_t dueCycle)
 {
-    //Memory load locations found at: https://www.emutalk.net/threads/space-invaders.38177/
+    switch(eventId)
+    {
+        case MidScreen:
+        {
+            performInterrupt(midScreenInterrupt);
+            scheduleEvent(dueCycle + cyclesPerFrame, MidScreen);
+            return;
+        }
+            
+        case EndOfScreen:
+        {
+            performInterrupt(endOfScreenInterrupt);
+            scheduleEvent(dueCycle + cyclesPerFrame, EndOfScreen);
+            return;
+        }
+            
+        default:
+            return;
+    }
+}
+
+void SpaceInvaders::saveMachineState(std::vector<uint8_t>& state) const
+{
+    //Part of the snapshot file layout, so changing what is saved here needs Snapshot::formatVersion bumping
+    Snapshot::appendValue(state, currentShiftOffset, 1);
+    Snapshot::appendValue(state, currentShiftVal, 2);
+    Snapshot::appendValue(state, frameEndCycle, 8);
     
-    std::filesystem::path gameFilesDir = "/Users/maxwalley/Documents/Personal_Projects/Intel_8080_Emulator/invaders";
+    //Only the inputs latched for the frame, the keys held down belong to whoever is playing, so rewinding doesn't press or release any
+    Snapshot::appendValue(state, inputs.port1, 1);
+    Snapshot::appendValue(state, inputs.port2, 1);
+}
+
+void SpaceInvaders::restoreMachineState(std::span<const uint8_t> state)
+{
+    currentShiftOffset = Snapshot::takeValue(state, 1);
+    currentShiftVal = Snapshot::takeValue(state, 2);
+    frameEndCycle = Snapshot::takeValue(state, 8);
+    
+    inputs.port1 = Snapshot::takeValue(state, 1);
+    inputs.port2 = Snapshot::takeValue(state, 1);
+    
+    //The whole screen could have changed
+    dirtyVideoRows.set();
+}
+
+void SpaceInvaders::written(uint16_t storageAddress)
+{
+    dirtyVideoRows[(storageAddress - videoMemoryStart) / videoRowBytes] = true;
+}
+
+bool SpaceInvaders::loadGame(const std::filesystem::path& gameFilesDir)
+{
+    //Memory load locations found at: https://www.emutalk.net/threads/space-invaders.38177/
     
     for(int fileIndex = 0; fileIndex < 4; ++fileIndex)
     {
-        std::string extensionName;
+        const char* extensionName = "";
         int16_t destinationMemoryLocation = 0x0;
         
         switch (fileIndex)
@@ -207,21 +295,24 @@ bool SpaceInvaders::loadGame()
                 break;
         }
         
-        std::filesystem::path childFileName = gameFilesDir / std::filesystem::path("invaders." + extensionName);
+        std::filesystem::path childFileName = gameFilesDir / std::filesystem::path(std::string("invaders.") + extensionName);
         
-        if(const std::filesystem::directory_entry& file{childFileName}; file.exists())
+        if(const std::filesystem::directory_entry file{childFileName}; file.exists())
         {
-            std::ifstream fileStream(file);
+            std::ifstream fileStream(file.path(), std::ios::binary);
             
             if(!fileStream.is_open())
             {
                 return false;
             }
             
-            fileStream.unsetf(std::ios_base::skipws);
+            const std::vector<uint8_t> fileData(std::istreambuf_iterator<char>(fileStream), {});
             
-            //Load program into memory
-            std::copy(std::istream_iterator<uint8_t>(fileStream), std::istream_iterator<uint8_t>(), memory.begin() + destinationMemoryLocation);
+            //Each chip is 2K, anything bigger would run into the next one
+            if(fileData.size() > 0x800 || !loadMemory(destinationMemoryLocation, fileData))
+            {
+                return false;
+            }
         }
         else
         {
@@ -231,35 +322,32 @@ bool SpaceInvaders::loadGame()
     return true;
 }
 
-bool SpaceInvaders::loadTest()
+bool SpaceInvaders::checkKeyDown(uint8_t keycode) const
 {
-    std::filesystem::path testFile = "/Users/maxwalley/Documents/Personal_Projects/Intel_8080_Emulator/cpudiag.bin";
-    
-    std::ifstream fileStream(testFile);
+    return downKeys[keycode];
+}
+
+SpaceInvaders::Inputs SpaceInvaders::getInputsFromKeys() const
+{
+    Inputs keyInputs;
     
-    if(!fileStream.is_open())
+    //Space Key
+    if(checkKeyDown(32))
     {
-        return false;
+        keyInputs.port1 |= 0x15;
     }
     
-    fileStream.unsetf(std::ios_base::skipws);
-    
-    //Load program into memory
-    std::copy(std::istream_iterator<uint8_t>(fileStream), std::istream_iterator<uint8_t>(), memory.begin() + 0x100);
-    
-    //std::cout << int(memory[368]) << std::endl;
-    
-    //Fix the stack pointer from 0x6ad to 0x7ad
-    // this 0x06 byte 112 in the code, which is
-    // byte 112 + 0x100 = 368 in memory
-    // memory[368] = 0x7;
+    //Left Key
+    if(checkKeyDown(100))
+    {
+        keyInputs.port1 |= 0x20;
+    }
     
-    programCounter = 0x100;
+    //Right Key
+    if(checkKeyDown(102))
+    {
+        keyInputs.port1 |= 0x40;
+    }
     
-    return true;
-}
-
-bool SpaceInvaders::checkKeyDown(uint8_t keycode) const
-{
-    return std::find(currentlyDownKeys.cbegin(), currentlyDownKeys.cend(), keycode) != currentlyDownKeys.cend();
+    return keyInputs;
 }
@@ -7,41 +7,137 @@
 
 #pragma once
 
-#include "Intel_8080_Emulator.hpp"
+#include "Intel_8080_Machine.hpp"
+#include "SPSCQueue.hpp"
 
+#include <bitset>
 #include <iostream>
 #include <filesystem>
 #include <fstream>
 
-#include <SFML/Audio.hpp>
-#include <SFML/Graphics.hpp>
-
-class SpaceInvaders  : public Intel_8080_Emulator
+//The Space Invaders cabinet hardware around the CPU, with no window or sound so it can run headless
+class SpaceInvaders  : public Intel_8080_Machine<SpaceInvaders>, private MemoryBus::WriteObserver
 {
+    friend class Intel_8080_Machine<SpaceInvaders>;
+    
 public:
+    //What the game reads from input ports 1 and 2, which stays the same for a whole frame
+    struct Inputs
+    {
+        //Bit 3 of port 1 always reads as set
+        uint8_t port1 = 0x8;
+        uint8_t port2 = 0x0;
+        
+        bool operator==(const Inputs&) const = default;
+    };
+    
     SpaceInvaders();
     ~SpaceInvaders() override;
     
-    void run();
+    //Loads invaders.h, .g, .f and .e from the given directory
+    bool loadGame(const std::filesystem::path& gameFilesDir);
+    
+    //Runs until the end of the current frame, both screen interrupts happen inside it
+    void runFrame();
+    
+    //Runs the frame with the given inputs instead of the keys, for playing back a recording
+    void runFrame(const Inputs& frameInputs);
+    
+    //Sets up the next frame like runFrame but leaves running it to the caller, which has to run the machine for the cycles returned
+    uint64_t startFrame();
+    uint64_t startFrame(const Inputs& frameInputs);
+    
+    //The inputs the last frame ran with
+    const Inputs& getInputs() const;
     
+    //Can be called from any one thread other than the one running frames
     void triggerKeyDown(int keycode, int x, int y);
     void triggerKeyUp(int keycode, int x, int y);
     
+    //Video memory is laid out as rows of 32 bytes
+    static constexpr uint16_t videoMemoryStart = 0x2400;
+    static constexpr uint16_t videoMemoryEnd = 0x4000;
+    static constexpr uint16_t videoRowBytes = 32;
+    static constexpr int videoRowCount = (videoMemoryEnd - videoMemoryStart) / videoRowBytes;
+    
+    const uint8_t* getVideoMemory() const;
+    
+    //Returns the video memory rows written to since the last call, and clears them
+    std::bitset<videoRowCount> takeDirtyVideoRows();
+    
+    //The game ROM as loaded, from address 0 up to romSize
+    const uint8_t* getROM() const;
+    static constexpr uint16_t romSize = 0x2000;
+    
+    //Where the sounds the game plays are written as text, std::cout to start with. Pass nullptr to drop them
+    void setSoundOutput(std::ostream* output);
+    
+    //FNV-1a hashes of the memory, for telling whether two runs ended up the same. RAM includes video memory
+    uint64_t getRAMHash() const;
+    uint64_t getROMHash() const;
+    
+    using Intel_8080_Emulator::snapshot;
+    using Intel_8080_Emulator::restore;
+    using Intel_8080_Emulator::getCycleCount;
+    using Intel_8080_Emulator::getInstructionCount;
+    using Intel_8080_Emulator::setRecompilerEnabled;
+    using Intel_8080_Emulator::setRecompiledProgram;
+    using Intel_8080_Emulator::setProfile;
+    using Intel_8080_Emulator::setFusions;
+    
+    //The 8080 runs at 2MHz and the screen at 60Hz
+    static constexpr double frameTimeMS = 1000.0 / 60.0;
+    static constexpr uint64_t cyclesPerFrame = 33333;
+
 private:
-    uint8_t inputOperation(uint8_t port) override;
-    void outputOperation(uint8_t port, uint8_t value) override;
+    uint8_t inputOperation(uint8_t port);
+    void outputOperation(uint8_t port, uint8_t value);
+    void handleEvent(uint8_t eventId, uint64_t dueCycle) override;
+    
+    void saveMachineState(std::vector<uint8_t>& state) const override;
+    void restoreMachineState(std::span<const uint8_t> state) override;
     
-    bool loadGame();
-    bool loadTest();
+    //Video memory is observed on the memory bus, whichever mirror it is written through
+    void written(uint16_t storageAddress) override;
     
     bool checkKeyDown(uint8_t keycode) const;
     
+    //The port values for the keys held down now
+    Inputs getInputsFromKeys() const;
+    
+    //Applies any key presses sent from other threads
+    void processKeyEvents();
+    
     uint8_t currentShiftOffset = 0x0;
     uint16_t currentShiftVal = 0x0;
     
-    std::vector<int> currentlyDownKeys;
+    struct KeyEvent
+    {
+        int keycode;
+        bool down;
+    };
+    
+    SPSCQueue<KeyEvent, 64> keyEvents;
+    
+    //Only touched by the thread running frames
+    std::bitset<256> downKeys;
+    Inputs inputs;
+    
+    //The video hardware interrupts once when the beam reaches the middle of the screen and again at the end
+    enum ScreenEvent : uint8_t
+    {
+        MidScreen,
+        EndOfScreen
+    };
+    
+    static constexpr uint64_t midScreenCycle = 16667;
+    
+    static constexpr uint8_t midScreenInterrupt = 0xCF;
+    static constexpr uint8_t endOfScreenInterrupt = 0xD7;
+    
+    uint64_t frameEndCycle = cyclesPerFrame;
+    
+    std::bitset<videoRowCount> dirtyVideoRows;
     
-    static constexpr double halfFrameTimeMS = 1000.0 / 60.0;
-    std::chrono::steady_clock::time_point lastHalfFrameTime;
-    bool onFirstHalf;
+    std::ostream* soundOutput = &std::cout;
 };
@@ -0,0 +1,177 @@
+//
+//  SpaceInvadersApp.cpp
+//  Intel_8080_Emulator
+//
+
+#include "SpaceInvadersApp.hpp"
+
+#include <algorithm>
+#include <thread>
+
+SpaceInvadersApp::SpaceInvadersApp(SpaceInvaders& machineToRun)  : machine(machineToRun)
+{
+    
+}
+
+void SpaceInvadersApp::run()
+{
+    // Create the main window
+    sf::RenderWindow mainWindow(sf::VideoMode(VideoRenderer::screenWidth * windowScale, VideoRenderer::screenHeight * windowScale), "Space Invaders");
+    
+    //Presentation is paced by the display now, emulation speed is kept separately on the other thread
+    mainWindow.setVerticalSyncEnabled(true);
+    
+    VideoRenderer renderer(windowScale);
+    
+    static_assert(VideoRenderer::rowCount == SpaceInvaders::videoRowCount);
+    
+    running = true;
+    std::thread emulationThread(&SpaceInvadersApp::emulationLoop, this);
+    
+    uint64_t lastFrameNumber = 0;
+    
+    while(mainWindow.isOpen())
+    {
+        // Process events
+        sf::Event event;
+        while(mainWindow.pollEvent(event))
+        {
+            // Close window: exit
+            if(event.type == sf::Event::Closed)
+            {
+                mainWindow.close();
+            }
+            
+            // Escape pressed: exit
+            if(event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::Escape)
+            {
+                mainWindow.close();
+            }
+            
+            if((event.type == sf::Event::KeyPressed || event.type == sf::Event::KeyReleased) && event.key.code == sf::Keyboard::BackSpace)
+            {
+                rewinding = event.type == sf::Event::KeyPressed;
+            }
+            
+            if(event.type == sf::Event::KeyPressed || event.type == sf::Event::KeyReleased)
+            {
+                int keycode = -1;
+                
+                switch(event.key.code)
+                {
+                    case sf::Keyboard::Space:
+                        keycode = 32;
+                        break;
+                        
+                    case sf::Keyboard::Left:
+                        keycode = 100;
+                        break;
+                        
+                    case sf::Keyboard::Right:
+                        keycode = 102;
+                        break;
+                        
+                    default:
+                        break;
+                }
+                
+                if(keycode != -1)
+                {
+                    event.type == sf::Event::KeyPressed ? machine.triggerKeyDown(keycode, 0, 0) : machine.triggerKeyUp(keycode, 0, 0);
+                }
+            }
+        }
+        
+        if(frames.fetch())
+        {
+            const Frame& frame = frames.getReadBuffer();
+            
+            //If any frames were skipped their dirty rows were never seen, so everything has to be redrawn
+            if(frame.number == lastFrameNumber + 1)
+            {
+                renderer.update(frame.videoMemory.data(), frame.dirtyRows);
+            }
+            else
+            {
+                renderer.update(frame.videoMemory.data(), std::bitset<SpaceInvaders::videoRowCount>().set());
+            }
+            
+            lastFrameNumber = frame.number;
+        }
+        
+        mainWindow.clear();
+        renderer.draw(mainWindow);
+        mainWindow.display();
+    }
+    
+    running = false;
+    emulationThread.join();
+}
+
+void SpaceInvadersApp::setRecording(InputMovie* movie)
+{
+    recording = movie;
+}
+
+void SpaceInvadersApp::emulationLoop()
+{
+    const auto frameDuration = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double, std::milli>(SpaceInvaders::frameTimeMS));
+    
+    lastFrameTime = std::chrono::steady_clock::now();
+    
+    while(running)
+    {
+        if(!rewinding)
+        {
+            machine.runFrame();
+            
+            if(recording != nullptr)
+            {
+                recording->addFrame(machine.getInputs());
+            }
+            
+            machine.snapshot(frameState);
+            rewindBuffer.push(frameState);
+        }
+        else if(rewindBuffer.getFrameCount() > 1)
+        {
+            //Stepping back drops the frame stepped back from, so letting go carries on from here
+            rewindBuffer.dropLatest(1);
+            rewindBuffer.getFrame(0, frameState);
+            machine.restore(frameState);
+            
+            if(recording != nullptr)
+            {
+                recording->truncate(recording->getFrameCount() - 1);
+            }
+        }
+        
+        publishFrame();
+        
+        //Then only check the clock once, waiting until the frame would have finished on the real hardware
+        lastFrameTime += frameDuration;
+        
+        const auto currentTime = std::chrono::steady_clock::now();
+        
+        if(lastFrameTime > currentTime)
+        {
+            std::this_thread::sleep_until(lastFrameTime);
+        }
+        else if(currentTime - lastFrameTime > frameDuration)
+        {
+            //Too far behind to catch up so don't try
+            lastFrameTime = currentTime;
+        }
+    }
+}
+
+void SpaceInvadersApp::publishFrame()
+{
+    Frame& frame = frames.getWriteBuffer();
+    
+    std::copy_n(machine.getVideoMemory(), frame.videoMemory.size(), frame.videoMemory.begin());
+    frame.dirtyRows = machine.takeDirtyVideoRows();
+    frame.number = ++frameCount;
+    
+    frames.publish();
+}
@@ -0,0 +1,65 @@
+//
+//  SpaceInvadersApp.hpp
+//  Intel_8080_Emulator
+//
+
+#pragma once
+
+#include "SpaceInvaders.hpp"
+#include "InputMovie.hpp"
+#include "RewindBuffer.hpp"
+#include "VideoRenderer.hpp"
+#include "TripleBuffer.hpp"
+
+#include <atomic>
+#include <chrono>
+
+#include <SFML/Audio.hpp>
+#include <SFML/Graphics.hpp>
+
+//Window, input and pacing for a SpaceInvaders machine, which is run on its own thread
+class SpaceInvadersApp
+{
+public:
+    explicit SpaceInvadersApp(SpaceInvaders& machineToRun);
+    
+    //Runs the emulation on its own thread while this one handles the window
+    void run();
+    
+    //Adds the inputs of every frame run to the movie, and takes them back off when rewinding. Pass nullptr to stop
+    //Has to be set before run, the movie is only safe to use again once run returns
+    void setRecording(InputMovie* movie);
+
+private:
+    void emulationLoop();
+    
+    //Copies the finished frame's video memory over to the window thread
+    void publishFrame();
+    
+    SpaceInvaders& machine;
+    
+    struct Frame
+    {
+        std::array<uint8_t, SpaceInvaders::videoMemoryEnd - SpaceInvaders::videoMemoryStart> videoMemory;
+        std::bitset<SpaceInvaders::videoRowCount> dirtyRows;
+        
+        //Lets the window thread tell when it has missed frames
+        uint64_t number = 0;
+    };
+    
+    TripleBuffer<Frame> frames;
+    uint64_t frameCount = 0;
+    
+    std::atomic<bool> running = false;
+    
+    //Holding backspace steps back through the frames kept here, a frame at a time
+    std::atomic<bool> rewinding = false;
+    RewindBuffer rewindBuffer;
+    Snapshot frameState;
+    
+    InputMovie* recording = nullptr;
+    
+    static constexpr float windowScale = 3.0f;
+    
+    std::chrono::steady_clock::time_point lastFrameTime;
+};
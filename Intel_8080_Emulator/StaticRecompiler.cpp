@@ -0,0 +1,349 @@
+//
+//  StaticRecompiler.cpp
+//  Intel_8080_Emulator
+//
+
+#include "StaticRecompiler.hpp"
+#include "RecompiledProgram.hpp"
+#include "OpcodeInfo.hpp"
+
+#include <cassert>
+#include <iomanip>
+#include <sstream>
+
+namespace
+{
+    //Names the generated code uses for each encoded register, 110 is memory so is never looked up
+    constexpr const char* registerNames[8] = {"B", "C", "D", "E", "H", "L", "M", "A"};
+    constexpr const char* pairNames[4] = {"BC", "DE", "HL", "SP"};
+    
+    //Upper case hex padded to the given number of digits, without a prefix
+    std::string toHex(uint64_t value, int digits)
+    {
+        std::stringstream stream;
+        stream << std::uppercase << std::hex << std::setfill('0') << std::setw(digits) << value;
+        return stream.str();
+    }
+    
+    std::string toAddress(uint16_t address)
+    {
+        return "0x" + toHex(address, 4);
+    }
+    
+    std::string toByte(uint8_t value)
+    {
+        return "0x" + toHex(value, 2);
+    }
+    
+    std::string getRegister(uint8_t encodedValue)
+    {
+        return std::string("Register::") + registerNames[encodedValue & 0x7];
+    }
+    
+    std::string getPair(uint8_t encodedValue)
+    {
+        return std::string("RegisterPair::") + pairNames[encodedValue & 0x3];
+    }
+    
+    std::string getBlockName(uint16_t address)
+    {
+        return "runBlock" + toHex(address, 4);
+    }
+}
+
+StaticRecompiler::StaticRecompiler(std::vector<uint8_t> romImage, uint16_t loadAddress)  : rom(std::move(romImage)), romStart(loadAddress)
+{
+    //The end of the ROM has to fit in 16 bits
+    assert(romStart + rom.size() <= 0xFFFF);
+    
+    for(uint16_t vector = 0x0; vector <= 0x38; vector += 0x8)
+    {
+        if(isInROM(vector, 1))
+        {
+            entryPoints.push_back(vector);
+        }
+    }
+}
+
+void StaticRecompiler::addEntryPoint(uint16_t address)
+{
+    entryPoints.push_back(address);
+}
+
+size_t StaticRecompiler::generate(std::ostream& output, const std::string& sourceName)
+{
+    findBlocks();
+    
+    const uint16_t romEnd = romStart + rom.size();
+    
+    output << "//Generated by static_recompiler from " << sourceName << ", do not edit\n\n"
+           << "#include \"RecompiledProgram.hpp\"\n\n"
+           << "namespace\n{\n"
+           << "    using Register = RegisterManager::Register;\n"
+           << "    using RegisterPair = RegisterManager::RegisterPair;\n";
+           
+    for(const auto& [startAddress, endAddress] : blocks)
+    {
+        writeBlock(output, startAddress, endAddress);
+    }
+    
+    output << "\n    const RecompiledProgram::Block blocks[]\n    {\n";
+    
+    for(const auto& [startAddress, endAddress] : blocks)
+    {
+        output << "        {" << toAddress(startAddress) << ", &" << getBlockName(startAddress) << "},\n";
+    }
+    
+    output << "    };\n}\n\n"
+           << "const RecompiledProgram& getRecompiledProgram()\n{\n"
+           << "    static const RecompiledProgram program(" << toAddress(romStart) << ", " << toAddress(romEnd) << ", 0x" << toHex(RecompiledProgram::calculateChecksum(rom.data(), rom.size()), 16) << ", blocks);\n"
+           << "    return program;\n}\n";
+           
+    return blocks.size();
+}
+
+void StaticRecompiler::findBlocks()
+{
+    blocks.clear();
+    
+    std::vector<uint16_t> pendingAddresses = entryPoints;
+    
+    while(!pendingAddresses.empty())
+    {
+        const uint16_t startAddress = pendingAddresses.back();
+        pendingAddresses.pop_back();
+        
+        if(blocks.contains(startAddress) || !isInROM(startAddress, 1))
+        {
+            continue;
+        }
+        
+        uint16_t address = startAddress;
+        
+        for(int instruction = 0; instruction < maxBlockInstructions; ++instruction)
+        {
+            const uint8_t opcode = readByte(address);
+            const uint8_t length = OpcodeInfo::getLength(opcode);
+            
+            if(!isInROM(address, length))
+            {
+                break;
+            }
+            
+            //Left for the interpreter to run on its own, with a new block starting after it
+            if(OpcodeInfo::needsInterpreter(opcode))
+            {
+                pendingAddresses.push_back(address + length);
+                break;
+            }
+            
+            const uint16_t nextAddress = address + length;
+            address = nextAddress;
+            
+            if(OpcodeInfo::isBranch(opcode))
+            {
+                const uint16_t target = length == 3 ? readAddress(address - 2) : 0;
+                
+                //JMP and the conditional jumps
+                if(opcode == 0xC3 || opcode == 0xCB || (opcode & 0xC7) == 0xC2)
+                {
+                    pendingAddresses.push_back(target);
+                }
+                
+                //CALL and the conditional calls return to the next instruction
+                if((opcode & 0xCF) == 0xCD || (opcode & 0xC7) == 0xC4)
+                {
+                    pendingAddresses.push_back(target);
+                }
+                
+                //RST
+                if((opcode & 0xC7) == 0xC7)
+                {
+                    pendingAddresses.push_back(opcode & 0x38);
+                }
+                
+                //Everything except JMP, RET and PCHL can carry on to the next instruction
+                if(opcode != 0xC3 && opcode != 0xCB && opcode != 0xC9 && opcode != 0xD9 && opcode != 0xE9)
+                {
+                    pendingAddresses.push_back(nextAddress);
+                }
+                
+                break;
+            }
+            
+            //Runs straight into a block that has already been found
+            if(blocks.contains(address))
+            {
+                break;
+            }
+            
+            //Long blocks are split, with the rest starting a new one
+            if(instruction == maxBlockInstructions - 1)
+            {
+                pendingAddresses.push_back(address);
+            }
+        }
+        
+        if(address != startAddress)
+        {
+            blocks[startAddress] = address;
+        }
+    }
+}
+
+void StaticRecompiler::writeBlock(std::ostream& output, uint16_t startAddress, uint16_t endAddress) const
+{
+    output << "\n    //" << toAddress(startAddress) << " - " << toAddress(endAddress - 1) << "\n"
+           << "    void " << getBlockName(startAddress) << "(Intel_8080_Emulator& cpu, uint64_t stopCycle)\n    {\n"
+           << "        [[maybe_unused]] RegisterManager& registers = RecompiledProgram::getRegisters(cpu);\n";
+           
+    for(uint16_t address = startAddress; address != endAddress; address += OpcodeInfo::getLength(readByte(address)))
+    {
+        const uint16_t nextAddress = address + OpcodeInfo::getLength(readByte(address));
+        
+        writeInstruction(output, address, nextAddress == endAddress);
+    }
+    
+    output << "    }\n";
+}
+
+void StaticRecompiler::writeInstruction(std::ostream& output, uint16_t address, bool lastInstruction) const
+{
+    const uint8_t opcode = readByte(address);
+    const uint16_t nextAddress = address + OpcodeInfo::getLength(opcode);
+    const uint8_t destination = (opcode >> 3) & 0x7;
+    const uint8_t source = opcode & 0x7;
+    
+    output << "\n        //" << toAddress(address) << " - " << Intel_8080_Emulator::getOpName(opcode) << "\n";
+    
+    //Code for the instructions simple enough to write out directly, everything else goes through its interpreter handler
+    std::string code;
+    
+    const uint16_t operand = OpcodeInfo::getLength(opcode) == 3 ? readAddress(address + 1) : 0;
+    
+    //NOP
+    if(opcode == 0x00)
+    {
+        code = "";
+    }
+    //MOV between registers or from memory
+    else if((opcode & 0xC0) == 0x40 && opcode != 0x76 && destination != 0x6)
+    {
+        const std::string value = source == 0x6 ? "RecompiledProgram::readMemory(cpu, registers.getValueFromRegisterPair(RegisterPair::HL))" : "registers.getRegisterValue(" + getRegister(source) + ")";
+        code = "registers.setRegisterValue(" + getRegister(destination) + ", " + value + ");\n";
+    }
+    //MVI to a register
+    else if((opcode & 0xC7) == 0x06 && destination != 0x6)
+    {
+        code = "registers.setRegisterValue(" + getRegister(destination) + ", " + toByte(readByte(address + 1)) + ");\n";
+    }
+    //LXI
+    else if((opcode & 0xCF) == 0x01)
+    {
+        code = "registers.setRegisterPair(" + getPair(opcode >> 4) + ", uint16_t(" + toAddress(operand) + "));\n";
+    }
+    //INX and DCX
+    else if((opcode & 0xCF) == 0x03 || (opcode & 0xCF) == 0x0B)
+    {
+        const std::string pair = getPair(opcode >> 4);
+        code = "registers.setRegisterPair(" + pair + ", uint16_t(registers.getValueFromRegisterPair(" + pair + ")" + ((opcode & 0x8) ? " - 1" : " + 1") + "));\n";
+    }
+    //LDAX B and LDAX D
+    else if(opcode == 0x0A || opcode == 0x1A)
+    {
+        code = "registers.setRegisterValue(Register::A, RecompiledProgram::readMemory(cpu, registers.getValueFromRegisterPair(" + getPair(opcode >> 4) + ")));\n";
+    }
+    //LDA, a constant address at the very top is left to the interpreter
+    else if(opcode == 0x3A && operand < 0xFFFF)
+    {
+        code = "registers.setRegisterValue(Register::A, RecompiledProgram::readMemory(cpu, " + toAddress(operand) + "));\n";
+    }
+    //LHLD
+    else if(opcode == 0x2A && operand < 0xFFFE)
+    {
+        code = "registers.setRegisterPair(RegisterPair::HL, RecompiledProgram::readMemory(cpu, " + toAddress(operand + 1) + "), RecompiledProgram::readMemory(cpu, " + toAddress(operand) + "));\n";
+    }
+    //XCHG
+    else if(opcode == 0xEB)
+    {
+        code = "{\n"
+               "    const uint16_t hl = registers.getValueFromRegisterPair(RegisterPair::HL);\n"
+               "    registers.setRegisterPair(RegisterPair::HL, registers.getValueFromRegisterPair(RegisterPair::DE));\n"
+               "    registers.setRegisterPair(RegisterPair::DE, hl);\n"
+               "}\n";
+    }
+    //SPHL
+    else if(opcode == 0xF9)
+    {
+        code = "registers.setRegisterPair(RegisterPair::SP, registers.getValueFromRegisterPair(RegisterPair::HL));\n";
+    }
+    //JMP
+    else if(opcode == 0xC3)
+    {
+        output << "        RecompiledProgram::setProgramCounter(cpu, " << toAddress(operand) << ");\n"
+               << "        RecompiledProgram::finishInstruction(cpu, " << toByte(opcode) << ", stopCycle);\n"
+               << "        return;\n";
+               
+        return;
+    }
+    else
+    {
+        //Handlers leave the program counter wherever the next instruction is, so there is nothing to set afterwards
+        output << "        RecompiledProgram::executeOpcode(cpu, " << toAddress(address) << ", " << toByte(opcode) << ");\n";
+        
+        if(OpcodeInfo::isBranch(opcode) || lastInstruction)
+        {
+            output << "        RecompiledProgram::finishInstruction(cpu, " << toByte(opcode) << ", stopCycle);\n"
+                   << "        return;\n";
+                   
+            return;
+        }
+        
+        output << "        if(RecompiledProgram::finishInstruction(cpu, " << toByte(opcode) << ", stopCycle))\n"
+               << "        {\n"
+               << "            return;\n"
+               << "        }\n";
+               
+        return;
+    }
+    
+    //Indents each line to sit inside the block function
+    for(size_t lineStart = 0; lineStart < code.size();)
+    {
+        const size_t lineEnd = code.find('\n', lineStart);
+        output << "        " << code.substr(lineStart, lineEnd + 1 - lineStart);
+        lineStart = lineEnd + 1;
+    }
+    
+    //The program counter isn't kept up to date between written out instructions, so it is set before leaving the block
+    if(lastInstruction)
+    {
+        output << "        RecompiledProgram::setProgramCounter(cpu, " << toAddress(nextAddress) << ");\n"
+               << "        RecompiledProgram::finishInstruction(cpu, " << toByte(opcode) << ", stopCycle);\n"
+               << "        return;\n";
+               
+        return;
+    }
+    
+    output << "        if(RecompiledProgram::finishInstruction(cpu, " << toByte(opcode) << ", stopCycle))\n"
+           << "        {\n"
+           << "            RecompiledProgram::setProgramCounter(cpu, " << toAddress(nextAddress) << ");\n"
+           << "            return;\n"
+           << "        }\n";
+}
+
+bool StaticRecompiler::isInROM(uint16_t address, uint8_t length) const
+{
+    return address >= romStart && address + length <= romStart + rom.size();
+}
+
+uint8_t StaticRecompiler::readByte(uint16_t address) const
+{
+    return rom[address - romStart];
+}
+
+uint16_t StaticRecompiler::readAddress(uint16_t address) const
+{
+    //Little endian, low byte first
+    return readByte(address) | (readByte(address + 1) << 8);
+}
@@ -0,0 +1,49 @@
+//
+//  StaticRecompiler.hpp
+//  Intel_8080_Emulator
+//
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+//Translates a ROM image into C++ ahead of time, for RecompiledProgram to run
+//Blocks are found by following every branch out from the entry points, so anything only reached through PCHL is left to the interpreter
+class StaticRecompiler
+{
+public:
+    StaticRecompiler(std::vector<uint8_t> romImage, uint16_t loadAddress);
+    
+    //The reset address and any RST vectors inside the ROM are always entry points
+    void addEntryPoint(uint16_t address);
+    
+    //Writes a source file defining getRecompiledProgram(), returns the number of blocks in it
+    size_t generate(std::ostream& output, const std::string& sourceName);
+
+private:
+    void findBlocks();
+    
+    void writeBlock(std::ostream& output, uint16_t startAddress, uint16_t endAddress) const;
+    
+    //Writes the code for a single instruction, the last one in a block also leaves it
+    void writeInstruction(std::ostream& output, uint16_t address, bool lastInstruction) const;
+    
+    bool isInROM(uint16_t address, uint8_t length) const;
+    uint8_t readByte(uint16_t address) const;
+    uint16_t readAddress(uint16_t address) const;
+    
+    std::vector<uint8_t> rom;
+    uint16_t romStart;
+    
+    std::vector<uint16_t> entryPoints;
+    
+    //Keeps each generated function a reasonable size for the compiler
+    static constexpr int maxBlockInstructions = 256;
+    
+    //Start address of each block to the address just past its last instruction
+    std::map<uint16_t, uint16_t> blocks;
+};
@@ -0,0 +1,96 @@
+//
+//  StaticRecompilerMain.cpp
+//  Intel_8080_Emulator
+//
+
+#include "StaticRecompiler.hpp"
+#include "SpaceInvaders.hpp"
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <string_view>
+
+//Translates a ROM into a C++ source file to build in with the emulator
+//Usage: static_recompiler <output file> <rom directory>
+//       static_recompiler <output file> --binary <file> <load address> [entry points...]
+int main(int argc, char const** argv)
+{
+    const bool binary = argc >= 5 && std::string_view(argv[2]) == "--binary";
+    
+    if(argc < 3 || (std::string_view(argv[2]) == "--binary" && !binary))
+    {
+        std::cout << "Usage: " << argv[0] << " <output file> <rom directory>" << std::endl
+                  << "       " << argv[0] << " <output file> --binary <file> <load address> [entry points...]" << std::endl;
+        return EXIT_FAILURE;
+    }
+    
+    std::vector<uint8_t> romImage;
+    uint16_t loadAddress = 0x0;
+    std::string sourceName;
+    std::vector<uint16_t> entryPoints;
+    
+    if(binary)
+    {
+        std::ifstream fileStream(argv[3], std::ios::binary);
+        
+        if(!fileStream.is_open())
+        {
+            std::cout << "Couldn't open " << argv[3] << std::endl;
+            return EXIT_FAILURE;
+        }
+        
+        romImage.assign(std::istreambuf_iterator<char>(fileStream), std::istreambuf_iterator<char>());
+        
+        //Addresses can be given in decimal or hex with a 0x prefix
+        loadAddress = std::stoul(argv[4], nullptr, 0);
+        sourceName = argv[3];
+        
+        for(int argIndex = 5; argIndex < argc; ++argIndex)
+        {
+            entryPoints.push_back(std::stoul(argv[argIndex], nullptr, 0));
+        }
+        
+        if(loadAddress + romImage.size() > 0xFFFF)
+        {
+            std::cout << "File doesn't fit in memory at that address" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+    else
+    {
+        SpaceInvaders machine;
+        
+        if(!machine.loadGame(argv[2]))
+        {
+            std::cout << "Warning game failed to load from " << argv[2] << std::endl;
+            return EXIT_FAILURE;
+        }
+        
+        romImage.assign(machine.getROM(), machine.getROM() + SpaceInvaders::romSize);
+        sourceName = argv[2];
+    }
+    
+    StaticRecompiler recompiler(std::move(romImage), loadAddress);
+    
+    for(const uint16_t address : entryPoints)
+    {
+        recompiler.addEntryPoint(address);
+    }
+    
+    std::ofstream output(argv[1]);
+    
+    if(!output.is_open())
+    {
+        std::cout << "Couldn't write to " << argv[1] << std::endl;
+        return EXIT_FAILURE;
+    }
+    
+    const size_t blockCount = recompiler.generate(output, sourceName);
+    
+    std::cout << "Wrote " << blockCount << " blocks to " << argv[1] << std::endl;
+    
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,170 @@
+//
+//  ThreadPool.cpp
+//  Intel_8080_Emulator
+//
+
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace
+{
+    //The worker the current thread is, so tasks it submits go on its own queue
+    thread_local const ThreadPool* currentPool = nullptr;
+    thread_local size_t currentWorker = 0;
+}
+
+ThreadPool::ThreadPool(size_t threadCount, bool pinThreads)
+{
+    threadCount = std::max(threadCount, size_t(1));
+    
+    //Every worker has to exist before any of them start looking through the others to steal
+    for(size_t index = 0; index < threadCount; ++index)
+    {
+        workers.push_back(std::make_unique<Worker>());
+    }
+    
+    const unsigned int coreCount = std::max(std::thread::hardware_concurrency(), 1u);
+    
+    for(size_t index = 0; index < threadCount; ++index)
+    {
+        workers[index]->thread = std::thread(&ThreadPool::workerLoop, this, index);
+
+#if defined(__linux__)
+        if(pinThreads)
+        {
+            cpu_set_t cores;
+            CPU_ZERO(&cores);
+            CPU_SET(index % coreCount, &cores);
+            pthread_setaffinity_np(workers[index]->thread.native_handle(), sizeof(cores), &cores);
+        }
+#endif
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    
+    taskQueued.notify_all();
+    
+    //Anything still queued is run first
+    for(const std::unique_ptr<Worker>& worker : workers)
+    {
+        worker->thread.join();
+    }
+}
+
+void ThreadPool::submit(Task task)
+{
+    ++unfinishedTasks;
+    
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        ++queuedTasks;
+    }
+    
+    Worker& worker = currentPool == this ? *workers[currentWorker] : *workers[nextWorker++ % workers.size()];
+    
+    {
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.tasks.push_back(std::move(task));
+    }
+    
+    taskQueued.notify_one();
+}
+
+void ThreadPool::wait()
+{
+    std::unique_lock<std::mutex> lock(sleepMutex);
+    
+    allDone.wait(lock, [this]()
+    {
+        return unfinishedTasks == 0;
+    });
+}
+
+size_t ThreadPool::getThreadCount() const
+{
+    return workers.size();
+}
+
+void ThreadPool::workerLoop(size_t index)
+{
+    currentPool = this;
+    currentWorker = index;
+    
+    while(true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            
+            taskQueued.wait(lock, [this]()
+            {
+                return queuedTasks > 0 || stopping;
+            });
+            
+            if(queuedTasks == 0)
+            {
+                return;
+            }
+            
+            //Claims one, which is already in a queue or just about to be
+            --queuedTasks;
+        }
+        
+        Task task;
+        
+        while(!takeTask(index, task))
+        {
+            std::this_thread::yield();
+        }
+        
+        task();
+        
+        if(--unfinishedTasks == 0)
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            allDone.notify_all();
+        }
+    }
+}
+
+bool ThreadPool::takeTask(size_t index, Task& task)
+{
+    {
+        Worker& own = *workers[index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        
+        if(!own.tasks.empty())
+        {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+    
+    //Starting from the next one along, so idle workers don't all pile onto the first
+    for(size_t offset = 1; offset < workers.size(); ++offset)
+    {
+        Worker& victim = *workers[(index + offset) % workers.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        
+        if(!victim.tasks.empty())
+        {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+    
+    return false;
+}
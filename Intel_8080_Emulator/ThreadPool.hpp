@@ -0,0 +1,65 @@
+//
+//  ThreadPool.hpp
+//  Intel_8080_Emulator
+//
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//Fixed set of worker threads, each with its own queue of tasks
+//Workers take their newest task first, and when they run out steal the oldest from the others
+//so work queued by a task stays on the thread that queued it unless another one is idle
+class ThreadPool
+{
+public:
+    using Task = std::function<void()>;
+    
+    //Pinning keeps each worker on its own core, only on Linux, elsewhere it is left to the OS
+    explicit ThreadPool(size_t threadCount = std::thread::hardware_concurrency(), bool pinThreads = false);
+    ~ThreadPool();
+    
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    
+    //From inside a task this queues on the same worker, from anywhere else the workers are taken in turn
+    void submit(Task task);
+    
+    //Blocks until every task submitted has run, including any they submitted themselves. Can't be called from a task
+    void wait();
+    
+    size_t getThreadCount() const;
+
+private:
+    struct Worker
+    {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+        std::thread thread;
+    };
+    
+    void workerLoop(size_t index);
+    
+    //Newest from the worker's own queue, otherwise the oldest from the first other one that has any
+    bool takeTask(size_t index, Task& task);
+    
+    std::vector<std::unique_ptr<Worker>> workers;
+    
+    //Queued is counted before a task goes in a queue and after it comes out, so sleeping workers never miss one
+    std::mutex sleepMutex;
+    std::condition_variable taskQueued;
+    std::condition_variable allDone;
+    size_t queuedTasks = 0;
+    std::atomic<size_t> unfinishedTasks = 0;
+    bool stopping = false;
+    
+    std::atomic<size_t> nextWorker = 0;
+};
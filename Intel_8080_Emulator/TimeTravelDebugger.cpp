@@ -0,0 +1,204 @@
+//
+//  TimeTravelDebugger.cpp
+//  Intel_8080_Emulator
+//
+
+#include "TimeTravelDebugger.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+TimeTravelDebugger::TimeTravelDebugger(Intel_8080_Emulator& emulatorToDebug, uint64_t interval)  : emulator(emulatorToDebug), checkpointInterval(std::max(interval, uint64_t(1)))
+{
+    emulator.snapshot(checkpoints.emplace_back());
+}
+
+void TimeTravelDebugger::setBreakpoint(uint16_t address, bool set)
+{
+    breakpoints[address] = set;
+}
+
+bool TimeTravelDebugger::hasBreakpoint(uint16_t address) const
+{
+    return breakpoints[address];
+}
+
+bool TimeTravelDebugger::step()
+{
+    //Checkpoints past here came from a run that could go differently this time
+    checkpoints.resize(std::min<size_t>(checkpoints.size(), position / checkpointInterval + 1));
+    
+    if(!emulator.step())
+    {
+        return false;
+    }
+    
+    if(++position % checkpointInterval == 0)
+    {
+        emulator.snapshot(checkpoints.emplace_back());
+    }
+    
+    return true;
+}
+
+bool TimeTravelDebugger::continueToBreakpoint(uint64_t maxSteps)
+{
+    for(uint64_t stepCount = 0; stepCount < maxSteps; ++stepCount)
+    {
+        if(!step())
+        {
+            return false;
+        }
+        
+        if(breakpoints[emulator.programCounter])
+        {
+            return true;
+        }
+    }
+    
+    return false;
+}
+
+bool TimeTravelDebugger::reverseStep()
+{
+    if(position == 0)
+    {
+        return false;
+    }
+    
+    seek(position - 1);
+    return true;
+}
+
+template<typename Function>
+bool TimeTravelDebugger::searchBack(Function function)
+{
+    const uint64_t endPosition = position;
+    
+    if(endPosition == 0)
+    {
+        return false;
+    }
+    
+    for(uint64_t checkpoint = (endPosition - 1) / checkpointInterval + 1; checkpoint-- > 0;)
+    {
+        const uint64_t stretchStart = checkpoint * checkpointInterval;
+        
+        emulator.restore(checkpoints[checkpoint]);
+        position = stretchStart;
+        
+        if(function(std::min(endPosition, stretchStart + checkpointInterval)))
+        {
+            return true;
+        }
+    }
+    
+    return false;
+}
+
+bool TimeTravelDebugger::reverseContinue()
+{
+    std::optional<uint64_t> found;
+    
+    searchBack([this, &found](uint64_t stretchEnd)
+    {
+        //The latest in the stretch is the one wanted, so it has to be run through to the end
+        for(; position < stretchEnd; ++position)
+        {
+            if(breakpoints[emulator.programCounter])
+            {
+                found = position;
+            }
+            
+            emulator.step();
+        }
+        
+        return found.has_value();
+    });
+    
+    seek(found.value_or(0));
+    return found.has_value();
+}
+
+std::optional<TimeTravelDebugger::Write> TimeTravelDebugger::findLastWrite(uint16_t address)
+{
+    if(!emulator.watchWrites(address))
+    {
+        return std::nullopt;
+    }
+    
+    const uint64_t startPosition = position;
+    std::optional<Write> found;
+    
+    searchBack([this, &found](uint64_t stretchEnd)
+    {
+        while(position < stretchEnd)
+        {
+            const Write write{position, emulator.programCounter, emulator.getCycleCount()};
+            
+            emulator.watchedAddressWritten = false;
+            emulator.step();
+            ++position;
+            
+            if(emulator.watchedAddressWritten)
+            {
+                found = write;
+            }
+        }
+        
+        return found.has_value();
+    });
+    
+    emulator.stopWatchingWrites();
+    seek(startPosition);
+    
+    return found;
+}
+
+uint64_t TimeTravelDebugger::getPosition() const
+{
+    return position;
+}
+
+uint16_t TimeTravelDebugger::getProgramCounter() const
+{
+    return emulator.programCounter;
+}
+
+const RegisterManager& TimeTravelDebugger::getRegisters() const
+{
+    return emulator.registers;
+}
+
+uint8_t TimeTravelDebugger::getFlags() const
+{
+    return emulator.alu.createStatusByte();
+}
+
+uint8_t TimeTravelDebugger::readMemory(uint16_t address) const
+{
+    return emulator.readMemory(address);
+}
+
+size_t TimeTravelDebugger::getCheckpointCount() const
+{
+    return checkpoints.size();
+}
+
+void TimeTravelDebugger::seek(uint64_t target)
+{
+    if(target < position)
+    {
+        const uint64_t checkpoint = target / checkpointInterval;
+        assert(checkpoint < checkpoints.size());
+        
+        emulator.restore(checkpoints[checkpoint]);
+        position = checkpoint * checkpointInterval;
+    }
+    
+    //Everything up to the target has run before, so none of it can be halted for good
+    for(; position < target; ++position)
+    {
+        emulator.step();
+    }
+}
@@ -0,0 +1,80 @@
+//
+//  TimeTravelDebugger.hpp
+//  Intel_8080_Emulator
+//
+
+#pragma once
+
+#include "Intel_8080_Emulator.hpp"
+
+#include <bitset>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+//Steps a machine backwards as well as forwards, by restoring the nearest checkpoint before where it is going and running forwards from there
+//Everything has to run through the debugger while it is attached, and the machine has to do the same thing each time it runs from the same state,
+//so nothing from outside like key presses can change in between
+//A checkpoint is taken every checkpointInterval steps. Shorter intervals use more memory but have less to run again for every step back
+class TimeTravelDebugger
+{
+public:
+    struct Write
+    {
+        //Position before the step that wrote, and where that step's instruction was
+        uint64_t position;
+        uint16_t programCounter;
+        uint64_t cycle;
+    };
+    
+    //Everything before the machine's current state is out of reach
+    explicit TimeTravelDebugger(Intel_8080_Emulator& emulatorToDebug, uint64_t checkpointInterval = 100000);
+    
+    void setBreakpoint(uint16_t address, bool set = true);
+    bool hasBreakpoint(uint16_t address) const;
+    
+    //Runs one instruction, returns false if the CPU is halted with nothing left to wake it
+    bool step();
+    
+    //Steps until the program counter lands on a breakpoint, or maxSteps have run. Returns true if it stopped on a breakpoint
+    bool continueToBreakpoint(uint64_t maxSteps = UINT64_MAX);
+    
+    //Goes back to before the last step, returns false if already at the start
+    bool reverseStep();
+    
+    //Goes back to the last time the program counter was on a breakpoint, or the start if it never was
+    //Returns true if it found one
+    bool reverseContinue();
+    
+    //The last step before now that wrote the byte at the address, through it or anything mirroring it. Writes dropped by ROM don't count
+    //Writes by an interrupt are put down to the step it came after
+    std::optional<Write> findLastWrite(uint16_t address);
+    
+    //Number of steps from where the debugger was attached to now
+    uint64_t getPosition() const;
+    
+    uint16_t getProgramCounter() const;
+    const RegisterManager& getRegisters() const;
+    uint8_t getFlags() const;
+    uint8_t readMemory(uint16_t address) const;
+    
+    size_t getCheckpointCount() const;
+
+private:
+    //Restores the last checkpoint before the target if it is behind, then steps forwards to it
+    void seek(uint64_t target);
+    
+    //Goes back through the stretches between checkpoints before now, latest first, until function returns true and returns whether it did
+    //Each stretch starts restored to its checkpoint, and function is given where it ends to run through it itself
+    template<typename Function>
+    bool searchBack(Function function);
+    
+    Intel_8080_Emulator& emulator;
+    const uint64_t checkpointInterval;
+    
+    //Checkpoint n is the state at position n * checkpointInterval
+    std::vector<Snapshot> checkpoints;
+    uint64_t position = 0;
+    
+    std::bitset<65536> breakpoints;
+};
@@ -0,0 +1,167 @@
+//
+//  TraceDecodeMain.cpp
+//  Intel_8080_Emulator
+//
+
+#include "Intel_8080_Emulator.hpp"
+#include "OpcodeInfo.hpp"
+#include "TraceFile.hpp"
+
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string_view>
+
+namespace
+{
+    void printRecord(const TraceRecord& record)
+    {
+        std::cout << std::uppercase << std::setfill('0') << std::dec << record.cycle << std::hex
+                  << " PC:" << std::setw(4) << record.programCounter
+                  << " " << std::setw(2) << int(record.opcode);
+                  
+        for(int operand = 0; operand < 2; ++operand)
+        {
+            if(operand < OpcodeInfo::getLength(record.opcode) - 1)
+            {
+                std::cout << " " << std::setw(2) << int(record.operands[operand]);
+            }
+            else
+            {
+                std::cout << "   ";
+            }
+        }
+        
+        std::cout << " A:" << std::setw(2) << int(record.accumulator)
+                  << " F:" << std::setw(2) << int(record.flags)
+                  << " BC:" << std::setw(4) << record.bc
+                  << " DE:" << std::setw(4) << record.de
+                  << " HL:" << std::setw(4) << record.hl
+                  << " SP:" << std::setw(4) << record.stackPointer
+                  << " " << Intel_8080_Emulator::getOpName(record.opcode) << std::dec << std::setfill(' ') << "\n";
+    }
+    
+    //Anything left over means the file was cut short or damaged
+    bool readToEnd(const TraceReader& reader, std::ifstream& fileStream)
+    {
+        return reader.isValid() && fileStream.peek() == std::ifstream::traits_type::eof();
+    }
+    
+    int decodeTrace(std::ifstream& fileStream, TraceReader& reader)
+    {
+        TraceRecord record;
+        uint64_t recordCount = 0;
+        
+        while(reader.read(record))
+        {
+            printRecord(record);
+            ++recordCount;
+        }
+        
+        if(readToEnd(reader, fileStream))
+        {
+            std::cout << recordCount << " instructions" << std::endl;
+            return EXIT_SUCCESS;
+        }
+        
+        std::cout << "Trace stops being readable after " << recordCount << " instructions" << std::endl;
+        return EXIT_FAILURE;
+    }
+    
+    //Prints the first record the two traces disagree on, they match only if they are the same length as well
+    int compareTraces(std::ifstream& fileStream, TraceReader& reader, std::ifstream& otherStream, TraceReader& otherReader)
+    {
+        TraceRecord record;
+        TraceRecord otherRecord;
+        uint64_t recordCount = 0;
+        
+        while(true)
+        {
+            const bool hasRecord = reader.read(record);
+            const bool otherHasRecord = otherReader.read(otherRecord);
+            
+            if(!hasRecord || !otherHasRecord)
+            {
+                if(hasRecord != otherHasRecord)
+                {
+                    std::cout << "One trace ends after " << recordCount << " instructions, the other carries on with" << std::endl;
+                    printRecord(hasRecord ? record : otherRecord);
+                    return EXIT_FAILURE;
+                }
+                
+                break;
+            }
+            
+            if(record != otherRecord)
+            {
+                std::cout << "Instruction " << recordCount << " is different" << std::endl;
+                printRecord(record);
+                printRecord(otherRecord);
+                return EXIT_FAILURE;
+            }
+            
+            ++recordCount;
+        }
+        
+        if(!readToEnd(reader, fileStream) || !readToEnd(otherReader, otherStream))
+        {
+            std::cout << "Traces stop being readable after " << recordCount << " instructions" << std::endl;
+            return EXIT_FAILURE;
+        }
+        
+        std::cout << "All " << recordCount << " instructions are the same" << std::endl;
+        return EXIT_SUCCESS;
+    }
+}
+
+//Prints a trace file written by cpm_test or a machine's instrumentation, one instruction per line
+//With --compare, checks it against another trace instead, stopping at the first instruction they disagree on
+//Usage: trace_decode <trace file> [--compare <trace file>]
+int main(int argc, char const** argv)
+{
+    if(argc != 2 && !(argc == 4 && std::string_view(argv[2]) == "--compare"))
+    {
+        std::cout << "Usage: " << argv[0] << " <trace file> [--compare <trace file>]" << std::endl;
+        return EXIT_FAILURE;
+    }
+    
+    std::ifstream fileStream(argv[1], std::ios::binary);
+    
+    if(!fileStream.is_open())
+    {
+        std::cout << "Couldn't open " << argv[1] << std::endl;
+        return EXIT_FAILURE;
+    }
+    
+    TraceReader reader(fileStream);
+    
+    if(!reader.isValid())
+    {
+        std::cout << argv[1] << " isn't a trace file" << std::endl;
+        return EXIT_FAILURE;
+    }
+    
+    if(argc == 2)
+    {
+        return decodeTrace(fileStream, reader);
+    }
+    
+    std::ifstream otherStream(argv[3], std::ios::binary);
+    
+    if(!otherStream.is_open())
+    {
+        std::cout << "Couldn't open " << argv[3] << std::endl;
+        return EXIT_FAILURE;
+    }
+    
+    TraceReader otherReader(otherStream);
+    
+    if(!otherReader.isValid())
+    {
+        std::cout << argv[3] << " isn't a trace file" << std::endl;
+        return EXIT_FAILURE;
+    }
+    
+    return compareTraces(fileStream, reader, otherStream, otherReader);
+}
@@ -0,0 +1,241 @@
+//
+//  TraceFile.cpp
+//  Intel_8080_Emulator
+//
+
+#include "TraceFile.hpp"
+#include "OpcodeInfo.hpp"
+
+#include <algorithm>
+
+namespace
+{
+    constexpr std::array<char, 8> traceMagic{'8', '0', '8', '0', 'T', 'R', 'C', '1'};
+    
+    //Bits of the byte at the start of each record
+    enum ChangeBit : uint8_t
+    {
+        stackPointerChanged = 0x01,
+        bcChanged = 0x02,
+        deChanged = 0x04,
+        hlChanged = 0x08,
+        accumulatorChanged = 0x10,
+        flagsChanged = 0x20,
+        
+        //Anywhere other than straight after the last instruction
+        programCounterJumped = 0x40
+    };
+    
+    //Where the instruction after the given one would be if it didn't jump
+    uint16_t getNextAddress(const TraceRecord& record)
+    {
+        return record.programCounter + OpcodeInfo::getLength(record.opcode);
+    }
+}
+
+TraceWriter::TraceWriter(std::ostream& outputStream)  : output(outputStream)
+{
+    output.write(traceMagic.data(), traceMagic.size());
+    buffer.reserve(bufferBytes);
+}
+
+TraceWriter::~TraceWriter()
+{
+    flush();
+}
+
+void TraceWriter::write(const TraceRecord& record)
+{
+    uint8_t changes = 0;
+    
+    changes |= record.stackPointer != previous.stackPointer ? stackPointerChanged : 0;
+    changes |= record.bc != previous.bc ? bcChanged : 0;
+    changes |= record.de != previous.de ? deChanged : 0;
+    changes |= record.hl != previous.hl ? hlChanged : 0;
+    changes |= record.accumulator != previous.accumulator ? accumulatorChanged : 0;
+    changes |= record.flags != previous.flags ? flagsChanged : 0;
+    changes |= record.programCounter != getNextAddress(previous) ? programCounterJumped : 0;
+    
+    buffer.push_back(changes);
+    writeVarint(record.cycle - previous.cycle);
+    
+    if(changes & programCounterJumped)
+    {
+        writeDelta(record.programCounter, previous.programCounter);
+    }
+    
+    if(changes & stackPointerChanged)
+    {
+        writeDelta(record.stackPointer, previous.stackPointer);
+    }
+    
+    if(changes & bcChanged)
+    {
+        writeDelta(record.bc, previous.bc);
+    }
+    
+    if(changes & deChanged)
+    {
+        writeDelta(record.de, previous.de);
+    }
+    
+    if(changes & hlChanged)
+    {
+        writeDelta(record.hl, previous.hl);
+    }
+    
+    if(changes & accumulatorChanged)
+    {
+        buffer.push_back(record.accumulator);
+    }
+    
+    if(changes & flagsChanged)
+    {
+        buffer.push_back(record.flags);
+    }
+    
+    buffer.push_back(record.opcode);
+    
+    const int operandCount = OpcodeInfo::getLength(record.opcode) - 1;
+    buffer.insert(buffer.end(), record.operands.begin(), record.operands.begin() + operandCount);
+    
+    previous = record;
+    
+    if(buffer.size() >= bufferBytes)
+    {
+        flush();
+    }
+}
+
+void TraceWriter::flush()
+{
+    output.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+    buffer.clear();
+}
+
+void TraceWriter::writeVarint(uint64_t value)
+{
+    //7 bits at a time, lowest first, with the top bit set on every byte but the last
+    while(value >= 0x80)
+    {
+        buffer.push_back(uint8_t(value) | 0x80);
+        value >>= 7;
+    }
+    
+    buffer.push_back(value);
+}
+
+void TraceWriter::writeDelta(uint16_t value, uint16_t previousValue)
+{
+    //Zigzag so small steps either way stay small
+    const int16_t delta = int16_t(value - previousValue);
+    writeVarint(uint16_t(delta << 1) ^ uint16_t(delta >> 15));
+}
+
+TraceReader::TraceReader(std::istream& inputStream)  : input(inputStream)
+{
+    std::array<char, traceMagic.size()> magic;
+    input.read(magic.data(), magic.size());
+    
+    valid = input.gcount() == std::streamsize(magic.size()) && magic == traceMagic;
+}
+
+bool TraceReader::isValid() const
+{
+    return valid;
+}
+
+bool TraceReader::read(TraceRecord& record)
+{
+    uint8_t changes;
+    uint64_t cycleDelta;
+    
+    //Running out at the start of a record is the end of the file, anywhere else it has been cut short
+    if(!valid || !readByte(changes))
+    {
+        return false;
+    }
+    
+    if(!readVarint(cycleDelta))
+    {
+        valid = false;
+        return false;
+    }
+    
+    record = previous;
+    record.cycle += cycleDelta;
+    record.programCounter = changes & programCounterJumped ? previous.programCounter : getNextAddress(previous);
+    
+    const bool registersRead = (!(changes & programCounterJumped) || readDelta(record.programCounter))
+                               && (!(changes & stackPointerChanged) || readDelta(record.stackPointer))
+                               && (!(changes & bcChanged) || readDelta(record.bc))
+                               && (!(changes & deChanged) || readDelta(record.de))
+                               && (!(changes & hlChanged) || readDelta(record.hl))
+                               && (!(changes & accumulatorChanged) || readByte(record.accumulator))
+                               && (!(changes & flagsChanged) || readByte(record.flags));
+    
+    if(!registersRead || !readByte(record.opcode))
+    {
+        valid = false;
+        return false;
+    }
+    
+    record.operands = {0, 0};
+    
+    for(int operand = 0; operand < OpcodeInfo::getLength(record.opcode) - 1; ++operand)
+    {
+        if(!readByte(record.operands[operand]))
+        {
+            valid = false;
+            return false;
+        }
+    }
+    
+    previous = record;
+    return true;
+}
+
+bool TraceReader::readByte(uint8_t& value)
+{
+    const int nextByte = input.get();
+    value = nextByte;
+    
+    return nextByte != std::istream::traits_type::eof();
+}
+
+bool TraceReader::readVarint(uint64_t& value)
+{
+    value = 0;
+    
+    for(int shift = 0; shift < 64; shift += 7)
+    {
+        uint8_t nextByte;
+        
+        if(!readByte(nextByte))
+        {
+            return false;
+        }
+        
+        value |= uint64_t(nextByte & 0x7F) << shift;
+        
+        if(!(nextByte & 0x80))
+        {
+            return true;
+        }
+    }
+    
+    return false;
+}
+
+bool TraceReader::readDelta(uint16_t& value)
+{
+    uint64_t encoded;
+    
+    if(!readVarint(encoded))
+    {
+        return false;
+    }
+    
+    value += uint16_t(encoded >> 1) ^ uint16_t(-int(encoded & 0x1));
+    return true;
+}
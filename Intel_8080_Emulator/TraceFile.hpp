@@ -0,0 +1,84 @@
+//
+//  TraceFile.hpp
+//  Intel_8080_Emulator
+//
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <vector>
+
+//State of the CPU as an instruction starts, before it has run
+struct TraceRecord
+{
+    //Cycle the instruction started on
+    uint64_t cycle;
+    
+    uint16_t programCounter;
+    uint16_t stackPointer;
+    uint16_t bc;
+    uint16_t de;
+    uint16_t hl;
+    uint8_t accumulator;
+    uint8_t flags;
+    
+    uint8_t opcode;
+    
+    //The bytes after the opcode. Only the ones the instruction uses are kept in trace files, the rest read back as 0
+    std::array<uint8_t, 2> operands;
+    
+    bool operator==(const TraceRecord&) const = default;
+};
+
+//Trace files are a header then each record stored as what changed since the one before
+//A record is a byte saying which registers changed and whether the program counter jumped, the cycles since the last one as a varint,
+//the new program counter and registers that changed as zigzag varint deltas, then the opcode and its operands
+class TraceWriter
+{
+public:
+    //Writes the header straight away
+    explicit TraceWriter(std::ostream& output);
+    
+    //Writes whatever is still buffered
+    ~TraceWriter();
+    
+    void write(const TraceRecord& record);
+    void flush();
+    
+private:
+    void writeVarint(uint64_t value);
+    void writeDelta(uint16_t value, uint16_t previousValue);
+    
+    static constexpr size_t bufferBytes = 65536;
+    
+    std::ostream& output;
+    std::vector<uint8_t> buffer;
+    
+    //Everything starts out as 0, the first record is stored against that
+    TraceRecord previous{};
+};
+
+class TraceReader
+{
+public:
+    //Reads the header, check isValid before reading records
+    explicit TraceReader(std::istream& input);
+    
+    bool isValid() const;
+    
+    //Returns false at the end of the file, or if the rest of it can't be read
+    bool read(TraceRecord& record);
+    
+private:
+    bool readByte(uint8_t& value);
+    bool readVarint(uint64_t& value);
+    bool readDelta(uint16_t& value);
+    
+    std::istream& input;
+    bool valid = false;
+    
+    TraceRecord previous{};
+};
@@ -0,0 +1,56 @@
+//
+//  TripleBuffer.hpp
+//  Intel_8080_Emulator
+//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+//Lets one thread keep producing values while another reads the latest one, without either waiting on the other
+template<typename Type>
+class TripleBuffer
+{
+public:
+    //Producer side, fill in the write buffer then publish it
+    Type& getWriteBuffer()
+    {
+        return buffers[writeIndex];
+    }
+    
+    void publish()
+    {
+        //Hand the finished buffer over and take back whichever one was waiting, possibly never read
+        writeIndex = middleIndex.exchange(writeIndex | newDataBit, std::memory_order_acq_rel) & indexMask;
+    }
+    
+    //Consumer side, returns true if a newer buffer has been published since the last call
+    bool fetch()
+    {
+        if(!(middleIndex.load(std::memory_order_relaxed) & newDataBit))
+        {
+            return false;
+        }
+        
+        readIndex = middleIndex.exchange(readIndex, std::memory_order_acq_rel) & indexMask;
+        return true;
+    }
+    
+    const Type& getReadBuffer() const
+    {
+        return buffers[readIndex];
+    }
+
+private:
+    static constexpr uint8_t indexMask = 0x3;
+    static constexpr uint8_t newDataBit = 0x4;
+    
+    std::array<Type, 3> buffers;
+    
+    //Each side's index is kept on its own cache line
+    alignas(64) std::atomic<uint8_t> middleIndex{1};
+    alignas(64) uint8_t writeIndex = 0;
+    alignas(64) uint8_t readIndex = 2;
+};
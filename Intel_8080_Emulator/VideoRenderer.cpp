@@ -0,0 +1,143 @@
+//
+//  VideoRenderer.cpp
+//  Intel_8080_Emulator
+//
+
+#include "VideoRenderer.hpp"
+
+#include <bit>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+constexpr uint32_t VideoRenderer::packPixel(uint8_t red, uint8_t green, uint8_t blue)
+{
+    //Textures take bytes in RGBA order, always fully opaque
+    if constexpr(std::endian::native == std::endian::little)
+    {
+        return 0xFF000000 | (blue << 16) | (green << 8) | red;
+    }
+    else
+    {
+        return (red << 24) | (green << 16) | (blue << 8) | 0xFF;
+    }
+}
+
+VideoRenderer::VideoRenderer(float scale)  : palette(createPalette(false)), greenBasePalette(createPalette(true)), pixels(rowCount * rowPixels, packPixel(0, 0, 0))
+{
+    texture.create(rowPixels, rowCount);
+    texture.update(reinterpret_cast<const sf::Uint8*>(pixels.data()));
+    
+    //Rows run bottom to top on the monitor, so turn the texture anticlockwise and move it back on screen
+    sprite.setTexture(texture);
+    sprite.setRotation(-90.0f);
+    sprite.setScale(scale, scale);
+    sprite.setPosition(0.0f, screenHeight * scale);
+}
+
+void VideoRenderer::update(const uint8_t* videoMemory, const std::bitset<rowCount>& dirtyRows)
+{
+    unsigned int row = 0;
+    
+    while(row < rowCount)
+    {
+        if(!dirtyRows[row])
+        {
+            ++row;
+            continue;
+        }
+        
+        //Upload each run of changed rows in one go
+        const unsigned int firstRow = row;
+        
+        for(; row < rowCount && dirtyRows[row]; ++row)
+        {
+            unpackRow(videoMemory + row * rowBytes, getPalette(row), pixels.data() + row * rowPixels);
+        }
+        
+        texture.update(reinterpret_cast<const sf::Uint8*>(pixels.data() + firstRow * rowPixels), rowPixels, row - firstRow, 0, firstRow);
+    }
+}
+
+void VideoRenderer::draw(sf::RenderWindow& window) const
+{
+    window.draw(sprite);
+}
+
+void VideoRenderer::unpackRow(const uint8_t* rowData, const uint32_t* palette, uint32_t* output)
+{
+    constexpr uint32_t black = packPixel(0, 0, 0);
+
+#if defined(__AVX2__)
+    //Broadcast each byte to eight lanes and keep the palette colour in the lanes whose bit is set
+    const __m256i bitMasks = _mm256_setr_epi32(0x1, 0x2, 0x4, 0x8, 0x10, 0x20, 0x40, 0x80);
+    const __m256i blackPixels = _mm256_set1_epi32(black);
+    
+    for(unsigned int byte = 0; byte < rowBytes; ++byte)
+    {
+        const __m256i setBits = _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32(rowData[byte]), bitMasks), bitMasks);
+        const __m256i colours = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(palette + byte * 8));
+        
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + byte * 8), _mm256_or_si256(_mm256_and_si256(setBits, colours), blackPixels));
+    }
+#elif defined(__SSE2__)
+    //Same as above but four lanes at a time, so each byte is done in two halves
+    const __m128i lowBitMasks = _mm_setr_epi32(0x1, 0x2, 0x4, 0x8);
+    const __m128i highBitMasks = _mm_setr_epi32(0x10, 0x20, 0x40, 0x80);
+    const __m128i blackPixels = _mm_set1_epi32(black);
+    
+    for(unsigned int byte = 0; byte < rowBytes; ++byte)
+    {
+        const __m128i value = _mm_set1_epi32(rowData[byte]);
+        const __m128i lowSetBits = _mm_cmpeq_epi32(_mm_and_si128(value, lowBitMasks), lowBitMasks);
+        const __m128i highSetBits = _mm_cmpeq_epi32(_mm_and_si128(value, highBitMasks), highBitMasks);
+        
+        const __m128i lowColours = _mm_loadu_si128(reinterpret_cast<const __m128i*>(palette + byte * 8));
+        const __m128i highColours = _mm_loadu_si128(reinterpret_cast<const __m128i*>(palette + byte * 8 + 4));
+        
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output + byte * 8), _mm_or_si128(_mm_and_si128(lowSetBits, lowColours), blackPixels));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output + byte * 8 + 4), _mm_or_si128(_mm_and_si128(highSetBits, highColours), blackPixels));
+    }
+#else
+    for(unsigned int byte = 0; byte < rowBytes; ++byte)
+    {
+        for(unsigned int bit = 0; bit < 8; ++bit)
+        {
+            const uint32_t mask = -uint32_t((rowData[byte] >> bit) & 0x1);
+            output[byte * 8 + bit] = (palette[byte * 8 + bit] & mask) | black;
+        }
+    }
+#endif
+}
+
+VideoRenderer::Palette VideoRenderer::createPalette(bool greenBase)
+{
+    Palette newPalette;
+    
+    for(unsigned int pixel = 0; pixel < rowPixels; ++pixel)
+    {
+        //Pixels count up from the bottom of the screen
+        const unsigned int screenY = screenHeight - 1 - pixel;
+        
+        if(screenY >= 32 && screenY < 64)
+        {
+            newPalette[pixel] = packPixel(0xFF, 0x20, 0x20);
+        }
+        else if(screenY >= 184 && (screenY < 240 || greenBase))
+        {
+            newPalette[pixel] = packPixel(0x20, 0xFF, 0x20);
+        }
+        else
+        {
+            newPalette[pixel] = packPixel(0xFF, 0xFF, 0xFF);
+        }
+    }
+    
+    return newPalette;
+}
+
+const uint32_t* VideoRenderer::getPalette(unsigned int row) const
+{
+    return row >= greenBaseFirstRow && row < greenBaseEndRow ? greenBasePalette.data() : palette.data();
+}
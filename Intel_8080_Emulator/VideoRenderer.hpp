@@ -0,0 +1,62 @@
+//
+//  VideoRenderer.hpp
+//  Intel_8080_Emulator
+//
+
+#pragma once
+
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <vector>
+
+#include <SFML/Graphics.hpp>
+
+//Turns Space Invaders video memory into a texture, only redrawing the rows that have changed
+class VideoRenderer
+{
+public:
+    //Video memory is 224 rows of 256 single bit pixels, the monitor is mounted on its side so these rows become the screen's columns
+    static constexpr unsigned int rowCount = 224;
+    static constexpr unsigned int rowPixels = 256;
+    static constexpr unsigned int rowBytes = rowPixels / 8;
+    
+    static constexpr unsigned int screenWidth = rowCount;
+    static constexpr unsigned int screenHeight = rowPixels;
+    
+    explicit VideoRenderer(float scale);
+    
+    //The sprite points at the texture so copies would draw the wrong one
+    VideoRenderer(const VideoRenderer&) = delete;
+    VideoRenderer& operator=(const VideoRenderer&) = delete;
+    
+    //Unpacks the given rows of video memory and uploads them to the texture
+    void update(const uint8_t* videoMemory, const std::bitset<rowCount>& dirtyRows);
+    
+    void draw(sf::RenderWindow& window) const;
+
+private:
+    //Expands one row of video memory into RGBA pixels, each set bit taking its colour from the palette
+    static void unpackRow(const uint8_t* rowData, const uint32_t* palette, uint32_t* output);
+    
+    //Packs a colour into a pixel with the same byte order as the texture expects
+    static constexpr uint32_t packPixel(uint8_t red, uint8_t green, uint8_t blue);
+    
+    //Colours for each pixel along a row, taken from the cellophane overlay on the cabinet
+    using Palette = std::array<uint32_t, rowPixels>;
+    static Palette createPalette(bool greenBase);
+    
+    const uint32_t* getPalette(unsigned int row) const;
+    
+    //The bottom of the screen is only green under the player's reserve ships
+    static constexpr unsigned int greenBaseFirstRow = 16;
+    static constexpr unsigned int greenBaseEndRow = 134;
+    
+    Palette palette;
+    Palette greenBasePalette;
+    
+    std::vector<uint32_t> pixels;
+    
+    sf::Texture texture;
+    sf::Sprite sprite;
+};
@@ -20,12 +20,59 @@
 // Here is a small helper for you! Have a look.
 #include "ResourcePath.hpp"
 
-#include "SpaceInvaders.hpp"
+#include "SpaceInvadersApp.hpp"
 
-int main(int, char const**)
+#include <fstream>
+#include <string>
+#include <string_view>
+
+int main(int argc, char const** argv)
 {
+    //The ROM directory can be given on the command line, otherwise it is looked for next to the executable
+    //Usage: space_invaders_app [rom directory] [--record <file>]
+    std::filesystem::path gameFilesDir = "invaders";
+    std::string recordFile;
+    
+    for(int argIndex = 1; argIndex < argc; ++argIndex)
+    {
+        if(std::string_view(argv[argIndex]) == "--record" && argIndex + 1 < argc)
+        {
+            recordFile = argv[++argIndex];
+        }
+        else
+        {
+            gameFilesDir = argv[argIndex];
+        }
+    }
+    
     SpaceInvaders emulator;
-    emulator.run();
+    
+    if(!emulator.loadGame(gameFilesDir))
+    {
+        std::cout << "Warning game failed to load from " << gameFilesDir << std::endl;
+        return EXIT_FAILURE;
+    }
+    
+    InputMovie recording;
+    recording.setROMHash(emulator.getROMHash());
+    
+    SpaceInvadersApp app(emulator);
+    
+    if(!recordFile.empty())
+    {
+        app.setRecording(&recording);
+    }
+    
+    app.run();
+    
+    //Written once the game is closed, space_invaders_headless --replay plays it back
+    if(!recordFile.empty())
+    {
+        recording.setRAMHash(emulator.getRAMHash());
+        
+        std::ofstream movieStream(recordFile, std::ios::binary);
+        recording.write(movieStream);
+    }
     
     // Set the Icon
     /*sf::Image icon;
@@ -0,0 +1,207 @@
+//
+//  BatchRunnerTest.cpp
+//  Intel_8080_Emulator
+//
+
+#include "BatchRunner.hpp"
+#include "ThreadPool.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+namespace
+{
+    constexpr size_t threadCount = 4;
+    constexpr size_t instanceCount = 8;
+    
+    //Every task has to run exactly once by the time wait returns, including ones queued by other tasks, and the pool can be used again after
+    bool runsEveryTaskOnce()
+    {
+        constexpr size_t taskCount = 1000;
+        constexpr size_t childCount = 16;
+        
+        ThreadPool pool(threadCount);
+        std::vector<std::atomic<int>> runs(taskCount + taskCount * childCount);
+        
+        for(int round = 1; round <= 2; ++round)
+        {
+            for(size_t task = 0; task < taskCount; ++task)
+            {
+                pool.submit([&pool, &runs, task]
+                {
+                    ++runs[task];
+                    
+                    for(size_t child = 0; child < childCount; ++child)
+                    {
+                        pool.submit([&runs, index = taskCount + task * childCount + child]
+                        {
+                            ++runs[index];
+                        });
+                    }
+                });
+            }
+            
+            pool.wait();
+            
+            for(size_t index = 0; index < runs.size(); ++index)
+            {
+                if(runs[index] != round)
+                {
+                    std::cout << "Task " << index << " had run " << runs[index] << " times after " << round << " rounds" << std::endl;
+                    return false;
+                }
+            }
+        }
+        
+        if(pool.getThreadCount() != threadCount)
+        {
+            std::cout << "Pool started " << pool.getThreadCount() << " threads instead of " << threadCount << std::endl;
+            return false;
+        }
+        
+        return true;
+    }
+    
+    bool addInstances(BatchRunner& runner, const char* romDirectory)
+    {
+        for(size_t instance = 0; instance < instanceCount; ++instance)
+        {
+            auto machine = std::make_unique<SpaceInvaders>();
+            
+            if(!machine->loadGame(romDirectory))
+            {
+                std::cout << "Test ROM failed to load from " << romDirectory << std::endl;
+                return false;
+            }
+            
+            machine->setSoundOutput(nullptr);
+            runner.addInstance(std::move(machine));
+        }
+        
+        return true;
+    }
+    
+    uint64_t hashScreen(const SpaceInvaders& machine)
+    {
+        uint64_t screenHash = 0xCBF29CE484222325;
+        
+        for(int byte = 0; byte < SpaceInvaders::videoMemoryEnd - SpaceInvaders::videoMemoryStart; ++byte)
+        {
+            screenHash = (screenHash ^ machine.getVideoMemory()[byte]) * 0x100000001B3;
+        }
+        
+        return screenHash;
+    }
+    
+    //With nothing pressed the test ROM always draws the same screen after 600 frames, the same one space_invaders_headless checks for
+    bool drawsKnownScreen(const char* romDirectory, bool lockstep)
+    {
+        constexpr uint64_t frameCount = 600;
+        
+        BatchRunner runner(threadCount, false);
+        runner.setLockstepEnabled(lockstep);
+        
+        if(!addInstances(runner, romDirectory))
+        {
+            return false;
+        }
+        
+        runner.runFrames(frameCount);
+        
+        bool passed = runner.getFramesRun() == frameCount * instanceCount;
+        
+        for(size_t instance = 0; instance < instanceCount; ++instance)
+        {
+            passed &= hashScreen(runner.getInstance(instance)) == 0x40e8a4a2f90db88;
+        }
+        
+        if(!passed)
+        {
+            std::cout << "Batch" << (lockstep ? " in lockstep" : "") << " ran " << runner.getFramesRun() << " frames, or drew the wrong screen" << std::endl;
+        }
+        
+        return passed;
+    }
+    
+    //Every machine has to be asked for each of its frames' inputs once, in order, and run with what it was given
+    //Machines given the same inputs end up the same, and ones given different inputs don't
+    bool runsOwnInputs(const char* romDirectory, bool lockstep)
+    {
+        constexpr uint64_t frameCount = 100;
+        
+        BatchRunner runner(threadCount, false);
+        runner.setLockstepEnabled(lockstep);
+        
+        if(!addInstances(runner, romDirectory))
+        {
+            return false;
+        }
+        
+        //Each machine's frames only ever run on one thread at once, so each can keep its own count without locking
+        std::vector<uint64_t> framesAsked(instanceCount);
+        std::atomic<bool> askedInOrder = true;
+        
+        const auto inputsFor = [](size_t instance, uint64_t frame)
+        {
+            SpaceInvaders::Inputs inputs;
+            inputs.port1 |= (instance % 2) << 4;
+            inputs.port2 = frame & 0x3;
+            return inputs;
+        };
+        
+        runner.runFrames(frameCount, [&](size_t instance, uint64_t frame)
+        {
+            if(framesAsked[instance]++ != frame)
+            {
+                askedInOrder = false;
+            }
+            
+            return inputsFor(instance, frame);
+        });
+        
+        bool passed = askedInOrder;
+        
+        for(size_t instance = 0; instance < instanceCount; ++instance)
+        {
+            const SpaceInvaders& machine = runner.getInstance(instance);
+            
+            passed &= framesAsked[instance] == frameCount && machine.getInputs() == inputsFor(instance, frameCount - 1);
+            passed &= machine.getRAMHash() == runner.getInstance(instance % 2).getRAMHash();
+        }
+        
+        passed &= runner.getInstance(0).getRAMHash() != runner.getInstance(1).getRAMHash();
+        
+        if(!passed)
+        {
+            std::cout << "Batch" << (lockstep ? " in lockstep" : "") << " ran machines with the wrong inputs" << std::endl;
+        }
+        
+        return passed;
+    }
+}
+
+//Runs tasks through the thread pool, and the test ROM through the batch runner with and without lockstep,
+//checking every task runs once and every machine runs its own frames with its own inputs
+//Usage: batch_runner_test <rom directory>
+int main(int argc, char const** argv)
+{
+    if(argc != 2)
+    {
+        std::cout << "Usage: " << argv[0] << " <rom directory>" << std::endl;
+        return EXIT_FAILURE;
+    }
+    
+    bool passed = runsEveryTaskOnce();
+    
+    for(const bool lockstep : {false, true})
+    {
+        passed &= drawsKnownScreen(argv[1], lockstep);
+        passed &= runsOwnInputs(argv[1], lockstep);
+    }
+    
+    std::cout << (passed ? "Batch runs every machine correctly" : "Batch doesn't run every machine correctly") << std::endl;
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
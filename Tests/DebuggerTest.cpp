@@ -0,0 +1,244 @@
+//
+//  DebuggerTest.cpp
+//  Intel_8080_Emulator
+//
+
+#include "TestMachine.hpp"
+#include "TimeTravelDebugger.hpp"
+
+#include <array>
+#include <cstdlib>
+#include <iostream>
+#include <optional>
+#include <vector>
+
+namespace
+{
+    //Counts up in B, storing each count at 0x2000 and into the ROM at 0x1000, which keeps nothing
+    //0100: LXI SP,3000 ; MVI B,00 ; 0105: INR B ; MOV A,B ; 0107: STA 2000 ; STA 1000 ; JMP 0105
+    const std::vector<uint8_t> countingLoop = {0x31, 0x00, 0x30, 0x06, 0x00, 0x04, 0x78, 0x32, 0x00, 0x20, 0x32, 0x00, 0x10, 0xC3, 0x05, 0x01};
+    
+    //Each time round the loop is five steps and 46 cycles, after the 17 cycles of the first two
+    constexpr std::array<uint16_t, 5> loopProgramCounters = {0x105, 0x106, 0x107, 0x10A, 0x10D};
+    constexpr std::array<uint64_t, 5> loopCycles = {0, 5, 10, 23, 36};
+    
+    //Checkpoints that don't line up with the loop, so stepping back has to run forwards from part way round
+    constexpr uint64_t checkpointInterval = 7;
+    
+    void loadCountingLoop(TestMachine& machine)
+    {
+        machine.mapROM(0x1000, 0x100);
+        machine.mapMirror(0x8000, 0x100, 0x2000);
+        machine.loadProgram(countingLoop, 0x100, 0x100);
+    }
+    
+    //Checks the machine is as the counting loop leaves it after the given number of steps
+    bool isAt(const TimeTravelDebugger& debugger, const TestMachine& machine, uint64_t position)
+    {
+        uint16_t programCounter = position == 0 ? 0x100 : 0x103;
+        uint64_t cycles = position == 0 ? 0 : 10;
+        uint8_t count = 0;
+        uint8_t accumulator = 0;
+        uint8_t stored = 0;
+        
+        if(position >= 2)
+        {
+            const uint64_t loop = (position - 2) / loopProgramCounters.size();
+            const size_t step = (position - 2) % loopProgramCounters.size();
+            
+            programCounter = loopProgramCounters[step];
+            cycles = 17 + loop * 46 + loopCycles[step];
+            count = loop + (step >= 1);
+            accumulator = loop + (step >= 2);
+            stored = loop + (step >= 3);
+        }
+        
+        const RegisterManager& registers = debugger.getRegisters();
+        
+        if(debugger.getPosition() != position || debugger.getProgramCounter() != programCounter || machine.getCycleCount() != cycles
+           || registers.getRegisterValue(RegisterManager::Register::B) != count || registers.getRegisterValue(RegisterManager::Register::A) != accumulator
+           || debugger.readMemory(0x2000) != stored || debugger.readMemory(0x1000) != 0x0)
+        {
+            std::cout << "Debugger at " << debugger.getPosition() << " wasn't in the state the loop is in after " << position << " steps" << std::endl;
+            return false;
+        }
+        
+        return true;
+    }
+    
+    //Steps forwards, then back a step at a time to the start and forwards again, checking each step is where the loop would be
+    bool stepsBackExactly()
+    {
+        constexpr uint64_t stepCount = 104;
+        
+        TestMachine machine;
+        loadCountingLoop(machine);
+        TimeTravelDebugger debugger(machine, checkpointInterval);
+        
+        for(uint64_t step = 0; step < stepCount; ++step)
+        {
+            debugger.step();
+        }
+        
+        bool passed = isAt(debugger, machine, stepCount);
+        
+        for(uint64_t position = stepCount; position-- > 0;)
+        {
+            passed &= debugger.reverseStep() && isAt(debugger, machine, position);
+        }
+        
+        if(debugger.reverseStep())
+        {
+            std::cout << "Stepped back from the start" << std::endl;
+            passed = false;
+        }
+        
+        for(uint64_t position = 1; position <= stepCount; ++position)
+        {
+            passed &= debugger.step() && isAt(debugger, machine, position);
+        }
+        
+        if(debugger.getCheckpointCount() != stepCount / checkpointInterval + 1)
+        {
+            std::cout << "Kept " << debugger.getCheckpointCount() << " checkpoints after " << stepCount << " steps" << std::endl;
+            passed = false;
+        }
+        
+        return passed;
+    }
+    
+    //The STA 2000 is at 0x0107, which the loop is on after 4 steps and every 5 after
+    bool stopsOnBreakpoints()
+    {
+        TestMachine machine;
+        loadCountingLoop(machine);
+        TimeTravelDebugger debugger(machine, checkpointInterval);
+        debugger.setBreakpoint(0x107);
+        
+        bool passed = debugger.continueToBreakpoint() && isAt(debugger, machine, 4);
+        passed &= debugger.continueToBreakpoint() && isAt(debugger, machine, 9);
+        
+        //Not far enough to reach the next
+        passed &= !debugger.continueToBreakpoint(4) && isAt(debugger, machine, 13);
+        
+        for(int step = 0; step < 91; ++step)
+        {
+            debugger.step();
+        }
+        
+        //Already on one, so it goes back to the one before
+        passed &= debugger.reverseContinue() && isAt(debugger, machine, 99);
+        
+        //With none before, it goes back to the start
+        debugger.setBreakpoint(0x107, false);
+        passed &= !debugger.reverseContinue() && isAt(debugger, machine, 0);
+        
+        return passed;
+    }
+    
+    //An event stepped over has to be due again after stepping back before it, and run again when stepped over again
+    bool stepsBackOverEvents()
+    {
+        TestMachine machine;
+        loadCountingLoop(machine);
+        machine.scheduleEvent(300, 7);
+        TimeTravelDebugger debugger(machine, checkpointInterval);
+        
+        while(machine.getHandledEvents().empty())
+        {
+            debugger.step();
+        }
+        
+        const uint64_t eventPosition = debugger.getPosition();
+        
+        for(int step = 0; step < 3; ++step)
+        {
+            debugger.reverseStep();
+        }
+        
+        const bool notRunBack = machine.getHandledEvents().size() == 1;
+        
+        for(int step = 0; step < 3; ++step)
+        {
+            debugger.step();
+        }
+        
+        if(!notRunBack || machine.getHandledEvents() != std::vector<uint8_t>{7, 7} || !isAt(debugger, machine, eventPosition))
+        {
+            std::cout << "Event ran " << machine.getHandledEvents().size() << " times stepping back and forwards over it" << std::endl;
+            return false;
+        }
+        
+        return true;
+    }
+    
+    //From 104 steps in, the last STA 2000 was the step from 99, 17 + 19 * 46 + 10 cycles in
+    //Looking has to leave the machine where it was, and leave the pages watched only if they were before
+    bool findsLastWrites()
+    {
+        TestMachine machine;
+        loadCountingLoop(machine);
+        TimeTravelDebugger debugger(machine, checkpointInterval);
+        
+        //Nothing has run yet
+        bool passed = !debugger.findLastWrite(0x2000).has_value();
+        
+        for(int step = 0; step < 104; ++step)
+        {
+            debugger.step();
+        }
+        
+        const bool codePageWatched = machine.isPageWatched(0x01);
+        const bool dataPageWatched = machine.isPageWatched(0x20);
+        
+        //Written through the mirror is the same as written to what it mirrors
+        for(const uint16_t address : {0x2000, 0x8000})
+        {
+            const std::optional<TimeTravelDebugger::Write> write = debugger.findLastWrite(address);
+            
+            if(!write || write->position != 99 || write->programCounter != 0x107 || write->cycle != 901)
+            {
+                std::cout << "Found the wrong last write to 0x" << std::hex << address << std::dec << std::endl;
+                passed = false;
+            }
+        }
+        
+        //The stack is never written, and the ROM drops every write
+        for(const uint16_t address : {0x2FFF, 0x1000})
+        {
+            if(debugger.findLastWrite(address).has_value())
+            {
+                std::cout << "Found a write to 0x" << std::hex << address << std::dec << " that never happened" << std::endl;
+                passed = false;
+            }
+        }
+        
+        if(!isAt(debugger, machine, 104))
+        {
+            std::cout << "Finding writes moved the machine" << std::endl;
+            passed = false;
+        }
+        
+        if(machine.isPageWatched(0x01) != codePageWatched || machine.isPageWatched(0x20) != dataPageWatched)
+        {
+            std::cout << "Finding writes left pages watched differently" << std::endl;
+            passed = false;
+        }
+        
+        return passed;
+    }
+}
+
+//Steps a counting loop backwards and forwards, to breakpoints, over an event, and finds the last writes to memory,
+//checking each lands in the state the loop is in at that step
+//Usage: debugger_test
+int main()
+{
+    bool passed = stepsBackExactly();
+    passed &= stopsOnBreakpoints();
+    passed &= stepsBackOverEvents();
+    passed &= findsLastWrites();
+    
+    std::cout << (passed ? "Debugger steps back exactly" : "Debugger doesn't step back exactly") << std::endl;
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,112 @@
+//
+//  DecodeCacheTest.cpp
+//  Intel_8080_Emulator
+//
+
+#include "TestMachine.hpp"
+
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+    //Counts reads, so a test can check nothing was read from it
+    class CountingHandler : public MemoryBus::Handler
+    {
+    public:
+        uint8_t read(uint16_t) override
+        {
+            ++reads;
+            return 0x0;
+        }
+        
+        void write(uint16_t, uint8_t) override
+        {
+            
+        }
+        
+        int reads = 0;
+    };
+    
+    //Runs the program from 0x0100 until it halts, and checks what it left from 0x2000
+    bool leaves(const char* name, TestMachine& machine, std::span<const uint8_t> program, std::span<const uint8_t> expected)
+    {
+        machine.loadProgram(program, 0x100, 0x100);
+        machine.runFor(10000);
+        
+        for(size_t index = 0; index < expected.size(); ++index)
+        {
+            if(machine.readMemory(0x2000 + index) != expected[index])
+            {
+                std::cout << name << " left " << int(machine.readMemory(0x2000 + index)) << " at 0x" << std::hex << 0x2000 + index << std::dec
+                          << " instead of " << int(expected[index]) << std::endl;
+                return false;
+            }
+        }
+        
+        return true;
+    }
+    
+    //Writing an instruction's operand has to throw away what was decoded from the instruction, whichever of its bytes it was
+    bool seesNewOperands()
+    {
+        //Stores one more than the MVI's operand back into it, three times round
+        //0100: MVI C,03 ; 0102: MVI A,00 ; INR A ; STA 0103 ; DCR C ; JNZ 0102 ; STA 2000 ; HLT
+        const std::vector<uint8_t> byteOperand = {0x0E, 0x03, 0x3E, 0x00, 0x3C, 0x32, 0x03, 0x01, 0x0D, 0xC2, 0x02, 0x01, 0x32, 0x00, 0x20, 0x76};
+        const uint8_t byteExpected[] = {0x03};
+        
+        //Writes the high byte of the LXI's operand after it has run once
+        //0100: MVI C,02 ; 0102: LXI H,1111 ; SHLD 2000 ; MVI A,22 ; STA 0104 ; DCR C ; JNZ 0102 ; HLT
+        const std::vector<uint8_t> wordOperand = {0x0E, 0x02, 0x21, 0x11, 0x11, 0x22, 0x00, 0x20, 0x3E, 0x22, 0x32, 0x04, 0x01, 0x0D, 0xC2, 0x02,
+                                                  0x01, 0x76};
+        const uint8_t wordExpected[] = {0x11, 0x22};
+        
+        //The same as the first, but writing the operand through a mirror of the page it is decoded from
+        std::vector<uint8_t> throughMirror = byteOperand;
+        throughMirror[7] = 0x81;
+        
+        TestMachine byteMachine;
+        TestMachine wordMachine;
+        TestMachine mirrorMachine;
+        mirrorMachine.mapMirror(0x8000, 0x1000, 0x0);
+        
+        bool passed = leaves("Writing an operand", byteMachine, byteOperand, byteExpected);
+        passed &= leaves("Writing the high byte of an operand", wordMachine, wordOperand, wordExpected);
+        passed &= leaves("Writing an operand through a mirror", mirrorMachine, throughMirror, byteExpected);
+        return passed;
+    }
+    
+    //Decoding reads only the instruction's own bytes, so one at the end of a page never reads from the handler on the next
+    bool readsOnlyOwnBytes()
+    {
+        //10FC: MVI A,05 ; NOP ; HLT
+        const std::vector<uint8_t> program = {0x3E, 0x05, 0x00, 0x76};
+        
+        CountingHandler handler;
+        
+        TestMachine machine;
+        machine.mapHandler(0x1100, 0x100, &handler);
+        machine.loadProgram(program, 0x10FC, 0x10FC);
+        machine.runFor(100);
+        
+        if(handler.reads != 0)
+        {
+            std::cout << "Decoding read " << handler.reads << " bytes past the end of the instructions" << std::endl;
+            return false;
+        }
+        
+        return true;
+    }
+}
+
+//Writes over instructions that have already been decoded, directly and through a mirror, and checks decoding reads nothing it doesn't need
+//Usage: decode_cache_test
+int main()
+{
+    bool passed = seesNewOperands();
+    passed &= readsOnlyOwnBytes();
+    
+    std::cout << (passed ? "Decoded instructions are kept up to date" : "Decoded instructions aren't kept up to date") << std::endl;
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,118 @@
+//
+//  FlagsTest.cpp
+//  Intel_8080_Emulator
+//
+
+#include "TestMachine.hpp"
+
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+    struct FlagsCase
+    {
+        const char* name;
+        std::vector<uint8_t> code;
+        uint8_t accumulator;
+        //As PUSH PSW writes it, S Z 0 AC 0 P 1 CY
+        uint8_t statusByte;
+    };
+    
+    const std::vector<FlagsCase> cases = {
+        {"MVI A,0F ; ADI 01", {0x3E, 0x0F, 0xC6, 0x01}, 0x10, 0x12},
+        {"MVI A,FF ; ADI 01", {0x3E, 0xFF, 0xC6, 0x01}, 0x00, 0x57},
+        {"MVI A,80 ; ORI 00", {0x3E, 0x80, 0xF6, 0x00}, 0x80, 0x82},
+        //AC after a subtraction is a borrow out of bit 3, as the ALU has always worked it out, where the 8080 sets it without a borrow
+        {"MVI A,05 ; SUI 06", {0x3E, 0x05, 0xD6, 0x06}, 0xFF, 0x97},
+        {"MVI A,01 ; DCR A", {0x3E, 0x01, 0x3D}, 0x00, 0x46},
+        {"MVI A,7F ; INR A", {0x3E, 0x7F, 0x3C}, 0x80, 0x92},
+        {"STC ; MVI A,01 ; ACI 01", {0x37, 0x3E, 0x01, 0xCE, 0x01}, 0x03, 0x06},
+        {"STC ; MVI A,00 ; SBI 00", {0x37, 0x3E, 0x00, 0xDE, 0x00}, 0xFF, 0x97},
+        {"MVI A,9B ; DAA", {0x3E, 0x9B, 0x27}, 0x01, 0x13},
+        {"MVI A,44 ; CPI 44", {0x3E, 0x44, 0xFE, 0x44}, 0x44, 0x46},
+        {"XRA A ; STC ; CMC", {0xAF, 0x37, 0x3F}, 0x00, 0x46},
+        {"XRA A ; MVI A,80 ; RAL", {0xAF, 0x3E, 0x80, 0x17}, 0x00, 0x47},
+        //Bits 3 and 5 always read back as 0 and bit 1 as 1, whatever was popped into the flags
+        {"LXI B,12FF ; PUSH B ; POP PSW", {0x01, 0xFF, 0x12, 0xC5, 0xF1}, 0x12, 0xD7},
+        {"LXI B,3400 ; PUSH B ; POP PSW", {0x01, 0x00, 0x34, 0xC5, 0xF1}, 0x34, 0x02}
+    };
+    
+    //Runs the case then PUSH PSW, which has to write the flags worked out by hand
+    //0100: LXI SP,3000 ; <code> ; PUSH PSW ; HLT
+    bool pushesStatusByte(const FlagsCase& flagsCase)
+    {
+        std::vector<uint8_t> program = {0x31, 0x00, 0x30};
+        program.insert(program.end(), flagsCase.code.begin(), flagsCase.code.end());
+        program.insert(program.end(), {0xF5, 0x76});
+        
+        TestMachine machine;
+        machine.loadProgram(program, 0x100, 0x100);
+        machine.runFor(200);
+        
+        const uint8_t statusByte = machine.readMemory(0x2FFE);
+        const uint8_t accumulator = machine.readMemory(0x2FFF);
+        
+        if(statusByte != flagsCase.statusByte || accumulator != flagsCase.accumulator)
+        {
+            std::cout << flagsCase.name << " pushed A " << std::hex << int(accumulator) << " and flags " << int(statusByte) << " instead of "
+                      << int(flagsCase.accumulator) << " and " << int(flagsCase.statusByte) << std::dec << std::endl;
+            return false;
+        }
+        
+        return true;
+    }
+    
+    //Runs the case then each conditional jump, which has to be taken just when the flag it tests is as the status byte says
+    //0100: LXI SP,3000 ; <code> ; J<condition> 0200 ; HLT ... 0200: HLT
+    bool jumpsOnFlags(const FlagsCase& flagsCase)
+    {
+        //Condition codes in order, NZ Z NC C PO PE P M, and the flag each one tests
+        const uint8_t conditionFlags[] = {0x40, 0x01, 0x04, 0x80};
+        bool passed = true;
+        
+        for(uint8_t condition = 0; condition < 8; ++condition)
+        {
+            std::vector<uint8_t> program = {0x31, 0x00, 0x30};
+            program.insert(program.end(), flagsCase.code.begin(), flagsCase.code.end());
+            program.insert(program.end(), {uint8_t(0xC2 | condition << 3), 0x00, 0x02, 0x76});
+            
+            const uint8_t target[] = {0x76};
+            
+            TestMachine machine;
+            machine.loadMemory(0x200, target);
+            machine.loadProgram(program, 0x100, 0x100);
+            machine.runFor(200);
+            
+            const bool flagSet = flagsCase.statusByte & conditionFlags[condition / 2];
+            const bool expectedTaken = condition % 2 == 1 ? flagSet : !flagSet;
+            const bool taken = machine.getProgramCounter() >= 0x200;
+            
+            if(taken != expectedTaken)
+            {
+                std::cout << flagsCase.name << (taken ? " took" : " didn't take") << " jump with condition " << int(condition) << std::endl;
+                passed = false;
+            }
+        }
+        
+        return passed;
+    }
+}
+
+//Checks the flags that PUSH PSW writes and conditional jumps read after each kind of instruction that sets them
+//Built for lazy and eager flags, so both are checked against known answers rather than only each other
+//Usage: flags_test
+int main()
+{
+    bool passed = true;
+    
+    for(const FlagsCase& flagsCase : cases)
+    {
+        passed &= pushesStatusByte(flagsCase);
+        passed &= jumpsOnFlags(flagsCase);
+    }
+    
+    std::cout << (passed ? "Flags match" : "Flags don't match") << std::endl;
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
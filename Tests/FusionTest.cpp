@@ -0,0 +1,165 @@
+//
+//  FusionTest.cpp
+//  Intel_8080_Emulator
+//
+
+#include "OpcodeProfile.hpp"
+#include "TestMachine.hpp"
+
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+    struct FusionCase
+    {
+        const char* name;
+        std::vector<uint8_t> program;
+        
+        //Running for exactly as many cycles as the instructions up to the stopping point take has to stop there
+        uint64_t cycles;
+        uint16_t programCounter;
+        uint64_t instructions;
+        
+        //What the program has written from 0x2000
+        std::vector<uint8_t> written;
+    };
+    
+    const std::vector<FusionCase> cases = {
+        //Sums the four bytes after the HLT, with MOV r,M then INX H and DCR then JNZ fused
+        //0100: LXI H,0111 ; MVI C,04 ; XRA A ; 0106: MOV B,M ; INX H ; ADD B ; DCR C ; JNZ 0106 ; STA 2000 ; HLT ; 01 02 03 04
+        {"Summing a table", {0x21, 0x11, 0x01, 0x0E, 0x04, 0xAF, 0x46, 0x23, 0x80, 0x0D, 0xC2, 0x06, 0x01, 0x32, 0x00, 0x20, 0x76,
+                             0x01, 0x02, 0x03, 0x04},
+            158, 0x110, 24, {0x0A}},
+        
+        //Copies the four bytes after the HLT to 0x2000, with LDAX, MOV M,A, INX H, INX D fused
+        //0100: LXI D,0111 ; LXI H,2000 ; MVI B,04 ; 0108: LDAX D ; MOV M,A ; INX H ; INX D ; DCR B ; JNZ 0108 ; HLT ; 11 22 33 44
+        {"Copying a block", {0x11, 0x11, 0x01, 0x21, 0x00, 0x20, 0x06, 0x04, 0x1A, 0x77, 0x23, 0x13, 0x05, 0xC2, 0x08, 0x01, 0x76,
+                             0x11, 0x22, 0x33, 0x44},
+            183, 0x110, 27, {0x11, 0x22, 0x33, 0x44}},
+        
+        //Stops the copy after the first MOV M,A, in the middle of the fused sequence
+        {"Stopping part way through a copy", {0x11, 0x11, 0x01, 0x21, 0x00, 0x20, 0x06, 0x04, 0x1A, 0x77, 0x23, 0x13, 0x05, 0xC2, 0x08, 0x01, 0x76,
+                                              0x11, 0x22, 0x33, 0x44},
+            41, 0x10A, 5, {0x11, 0x00}},
+        
+        //Stops between the DCR and the JNZ
+        //0100: MVI B,03 ; 0102: DCR B ; JNZ 0102 ; HLT
+        {"Stopping before a jump", {0x06, 0x03, 0x05, 0xC2, 0x02, 0x01, 0x76}, 12, 0x103, 2, {}},
+        
+        //0100: LXI SP,3000 ; LXI B,1234 ; PUSH B ; POP D ; XCHG ; SHLD 2000 ; HLT
+        {"Pushing and popping", {0x31, 0x00, 0x30, 0x01, 0x34, 0x12, 0xC5, 0xD1, 0xEB, 0x22, 0x00, 0x20, 0x76}, 61, 0x10C, 6, {0x34, 0x12}},
+        
+        //The copy starts by writing over its own MOV M,A with the 0x31 at 0x0100, so after the first time round the fused sequence
+        //has to stop at the LDAX, and the LXI SP,1323 the 0x31 makes is run instead. The loop ends with HL 010D and DE 0101
+        //0100: LXI SP,2800 ; LXI D,0100 ; LXI H,010C ; MVI B,08 ; 010B: LDAX D ; MOV M,A ; INX H ; INX D ; DCR B ; JNZ 010B
+        //0113: SHLD 2000 ; XCHG ; SHLD 2002 ; HLT
+        {"Copying over itself", {0x31, 0x00, 0x28, 0x11, 0x00, 0x01, 0x21, 0x0C, 0x01, 0x06, 0x08, 0x1A, 0x77, 0x23, 0x13, 0x05,
+                                 0xC2, 0x0B, 0x01, 0x22, 0x00, 0x20, 0xEB, 0x22, 0x02, 0x20, 0x76},
+            336, 0x11A, 41, {0x0D, 0x01, 0x01, 0x01}}
+    };
+    
+    bool runsCase(const FusionCase& fusionCase, const OpcodeProfile* profile)
+    {
+        TestMachine machine;
+        machine.loadProgram(fusionCase.program, 0x100, 0x100);
+        machine.setFusions(profile, 0.0);
+        machine.runFor(fusionCase.cycles);
+        
+        bool passed = machine.getCycleCount() == fusionCase.cycles && machine.getProgramCounter() == fusionCase.programCounter && machine.getInstructionCount() == fusionCase.instructions;
+        
+        for(size_t index = 0; index < fusionCase.written.size(); ++index)
+        {
+            passed &= machine.readMemory(0x2000 + index) == fusionCase.written[index];
+        }
+        
+        if(!passed)
+        {
+            std::cout << fusionCase.name << (profile != nullptr ? " fused" : "") << " stopped at 0x" << std::hex << machine.getProgramCounter() << std::dec
+                      << " after " << machine.getCycleCount() << " cycles and " << machine.getInstructionCount() << " instructions, or wrote the wrong thing" << std::endl;
+        }
+        
+        return passed;
+    }
+    
+    //PUSH B then POP D with the stack at the given address, which has to leave DE holding what the stack reads back as
+    //0100: LXI SP,<stackPointer> ; LXI B,1234 ; PUSH B ; POP D ; XCHG ; SHLD 2000 ; HLT
+    bool popsWhatStackHolds(const OpcodeProfile& profile, uint16_t stackPointer, uint16_t expected)
+    {
+        const std::vector<uint8_t> program = {0x31, uint8_t(stackPointer), uint8_t(stackPointer >> 8), 0x01, 0x34, 0x12, 0xC5, 0xD1, 0xEB, 0x22, 0x00, 0x20, 0x76};
+        
+        //The ROM keeps what it was loaded with whatever is pushed onto it
+        const uint8_t rom[] = {0x11, 0x22};
+        
+        TestMachine fused;
+        fused.mapROM(0x1000, 0x100);
+        fused.loadMemory(0x1000, rom);
+        fused.loadProgram(program, 0x100, 0x100);
+        fused.setFusions(&profile, 0.0);
+        fused.runFor(200);
+        
+        const uint16_t popped = fused.readMemory(0x2001) << 8 | fused.readMemory(0x2000);
+        
+        if(popped != expected)
+        {
+            std::cout << "PUSH then POP with the stack at " << std::hex << stackPointer << " popped " << popped << " instead of " << expected << std::dec << std::endl;
+            return false;
+        }
+        
+        return true;
+    }
+}
+
+//Runs a program for each fused sequence, stopping in the middle of some and writing over one part way through,
+//and checks each stops where it should with the cycles, instructions and memory it should have, fused or not
+//Usage: fusion_test
+int main()
+{
+    //A profile where every pair ran, so everything that can be fused is
+    OpcodeProfile profile;
+    
+    for(int previousOpcode = 0; previousOpcode < 256; ++previousOpcode)
+    {
+        for(int opcode = 0; opcode < 256; ++opcode)
+        {
+            profile.record(previousOpcode, opcode);
+        }
+    }
+    
+    bool passed = true;
+    
+    if(TestMachine().setFusions(&profile, 0.0) != 4)
+    {
+        std::cout << "Not every sequence was fused" << std::endl;
+        passed = false;
+    }
+    
+    //Only sequences that make up enough of the profile are fused
+    OpcodeProfile loopProfile;
+    loopProfile.record(0x1A, 0x77);
+    
+    for(int count = 0; count < 1000; ++count)
+    {
+        loopProfile.record(0x05, 0xC2);
+    }
+    
+    if(TestMachine().setFusions(&loopProfile, 0.01) != 1)
+    {
+        std::cout << "Fused sequences that were too rare" << std::endl;
+        passed = false;
+    }
+    
+    for(const FusionCase& fusionCase : cases)
+    {
+        passed &= runsCase(fusionCase, nullptr);
+        passed &= runsCase(fusionCase, &profile);
+    }
+    
+    //The fused pop only skips reading the stack back when the push has actually gone there
+    passed &= popsWhatStackHolds(profile, 0x3000, 0x1234);
+    passed &= popsWhatStackHolds(profile, 0x1002, 0x2211);
+    
+    std::cout << (passed ? "Fused handlers run correctly" : "Fused handlers don't run correctly") << std::endl;
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
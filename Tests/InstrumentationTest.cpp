@@ -0,0 +1,145 @@
+//
+//  InstrumentationTest.cpp
+//  Intel_8080_Emulator
+//
+
+#include "CpmMachine.hpp"
+#include "OpcodeProfile.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+namespace
+{
+    template<typename Instrumentation>
+    class InstrumentedMachine : public CpmMachine<Instrumentation>
+    {
+    public:
+        using CpmMachine<Instrumentation>::CpmMachine;
+        using Intel_8080_Emulator::setSwitchDispatch;
+        using Intel_8080_Emulator::setFusions;
+    };
+    
+    //Then CP/M's warm boot runs OUT 01 and HLT, 10 instructions in all
+    //0100: MVI B,03 ; 0102: DCR B ; JNZ 0102 ; JMP 0000
+    const std::vector<uint8_t> program = {0x06, 0x03, 0x05, 0xC2, 0x02, 0x01, 0xC3, 0x00, 0x00};
+    constexpr uint64_t instructionCount = 10;
+    
+    //The last four instructions, as the CPU was when each started
+    const std::vector<TraceRecord> lastRecords = {
+        {42, 0x0103, 0x0000, 0x0000, 0x0000, 0x0000, 0x00, 0x46, 0xC2, {0x02, 0x01}},
+        {52, 0x0106, 0x0000, 0x0000, 0x0000, 0x0000, 0x00, 0x46, 0xC3, {0x00, 0x00}},
+        {62, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x00, 0x46, 0xD3, {0x01, 0x00}},
+        {72, 0x0002, 0x0000, 0x0000, 0x0000, 0x0000, 0x00, 0x46, 0x76, {0x00, 0x00}}
+    };
+    
+    template<typename Instrumentation>
+    void runProgram(InstrumentedMachine<Instrumentation>& machine)
+    {
+        machine.loadProgram(program);
+        machine.run(1000);
+    }
+    
+    bool countsOpcodes()
+    {
+        std::ostringstream console;
+        InstrumentedMachine<CountingInstrumentation> machine(console);
+        runProgram(machine);
+        
+        const CountingInstrumentation& counts = machine.getInstrumentation();
+        
+        if(counts.getTotal() != instructionCount || counts.getCount(0x05) != 3 || counts.getCount(0xC2) != 3 || counts.getCount(0x06) != 1
+           || counts.getCount(0xC3) != 1 || counts.getCount(0xD3) != 1 || counts.getCount(0x76) != 1)
+        {
+            std::cout << "Counted " << counts.getTotal() << " instructions, or counted them against the wrong opcodes" << std::endl;
+            return false;
+        }
+        
+        return true;
+    }
+    
+    //A ring smaller than the program keeps only the last records, oldest first, but still counts them all
+    bool keepsLastRecords()
+    {
+        std::ostringstream console;
+        InstrumentedMachine<TraceRingInstrumentation<4>> machine(console);
+        runProgram(machine);
+        
+        const TraceRingInstrumentation<4>& ring = machine.getInstrumentation();
+        
+        if(ring.getRecordCount() != instructionCount || ring.getRecords() != lastRecords)
+        {
+            std::cout << "Ring kept the wrong records out of " << ring.getRecordCount() << std::endl;
+            return false;
+        }
+        
+        return true;
+    }
+    
+    //Everything written to a full trace reads back the same as a ring big enough to hold it all kept
+    bool traceReadsBack()
+    {
+        std::ostringstream console;
+        std::stringstream traceStream;
+        
+        {
+            InstrumentedMachine<FullTraceInstrumentation> machine(console);
+            machine.getInstrumentation().setOutput(&traceStream);
+            runProgram(machine);
+        }
+        
+        InstrumentedMachine<TraceRingInstrumentation<16>> ringMachine(console);
+        runProgram(ringMachine);
+        
+        TraceReader reader(traceStream);
+        std::vector<TraceRecord> records;
+        
+        for(TraceRecord record; reader.isValid() && reader.read(record);)
+        {
+            records.push_back(record);
+        }
+        
+        if(records != ringMachine.getInstrumentation().getRecords() || !std::equal(lastRecords.begin(), lastRecords.end(), records.end() - lastRecords.size()))
+        {
+            std::cout << "Trace read back " << records.size() << " records differently" << std::endl;
+            return false;
+        }
+        
+        return true;
+    }
+    
+    //Anything that runs instructions without the table would go unseen, so instrumented machines can't turn it on
+    bool refusesOtherDispatch()
+    {
+        OpcodeProfile profile;
+        profile.record(0x05, 0xC2);
+        
+        std::ostringstream console;
+        InstrumentedMachine<NoInstrumentation> plain(console);
+        InstrumentedMachine<CountingInstrumentation> counted(console);
+        
+        if(!plain.setSwitchDispatch(true) || plain.setFusions(&profile, 0.5) != 1 || counted.setSwitchDispatch(true) || counted.setFusions(&profile, 0.5) != 0)
+        {
+            std::cout << "Instrumented machine ran instructions some other way" << std::endl;
+            return false;
+        }
+        
+        return true;
+    }
+}
+
+//Runs a short program with each instrumentation policy and checks what each recorded
+//Usage: instrumentation_test
+int main()
+{
+    bool passed = countsOpcodes();
+    passed &= keepsLastRecords();
+    passed &= traceReadsBack();
+    passed &= refusesOtherDispatch();
+    
+    std::cout << (passed ? "Instrumentation records every instruction" : "Instrumentation doesn't record every instruction") << std::endl;
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,285 @@
+//
+//  LockstepTest.cpp
+//  Intel_8080_Emulator
+//
+
+#include "CpmMachine.hpp"
+#include "LockstepInterpreter.hpp"
+#include "TestMachine.hpp"
+
+#include <array>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <vector>
+
+namespace
+{
+    constexpr int machineCount = LockstepInterpreter::laneCount;
+    
+    struct LockstepCase
+    {
+        const char* name;
+        
+        //The program each lane runs from 0x0100, which has to leave its answer at 0x2000 and halt
+        std::function<std::vector<uint8_t>(int lane)> program;
+        
+        //What it leaves, given whether the bottom of memory is ROM
+        std::function<uint8_t(int lane, bool bottomIsROM)> expected;
+    };
+    
+    const std::vector<LockstepCase> cases = {
+        //The same code in every lane, which leaves the loop after the lane's own count from 0x3000
+        //0100: LDA 3000 ; MOV C,A ; 0104: INR B ; DCR C ; JNZ 0104 ; MOV A,B ; STA 2000 ; HLT
+        {"Looping different numbers of times",
+            [](int)
+            {
+                return std::vector<uint8_t>{0x3A, 0x00, 0x30, 0x4F, 0x04, 0x0D, 0xC2, 0x04, 0x01, 0x78, 0x32, 0x00, 0x20, 0x76};
+            },
+            [](int lane, bool)
+            {
+                return uint8_t(lane + 1);
+            }},
+        
+        //0100: MVI A,<lane * 5> ; STA 2000 ; HLT
+        {"Different immediates at the same address",
+            [](int lane)
+            {
+                return std::vector<uint8_t>{0x3E, uint8_t(lane * 5), 0x32, 0x00, 0x20, 0x76};
+            },
+            [](int lane, bool)
+            {
+                return uint8_t(lane * 5);
+            }},
+        
+        //0100: MVI A,<lane> ; STA 2000 ; HLT, or XRA A ; ADI <lane> ; STA 2000 ; HLT in odd lanes
+        {"Different instructions at the same address",
+            [](int lane)
+            {
+                return lane % 2 == 0 ? std::vector<uint8_t>{0x3E, uint8_t(lane), 0x32, 0x00, 0x20, 0x76}
+                                     : std::vector<uint8_t>{0xAF, 0xC6, uint8_t(lane), 0x32, 0x00, 0x20, 0x76};
+            },
+            [](int lane, bool)
+            {
+                return uint8_t(lane);
+            }},
+        
+        //Writes the lane's count from 0x3000 over the MVI's operand, which ROM drops
+        //0100: LDA 3000 ; STA 0107 ; 0106: MVI A,00 ; STA 2000 ; HLT
+        {"Writing over their own code",
+            [](int)
+            {
+                return std::vector<uint8_t>{0x3A, 0x00, 0x30, 0x32, 0x07, 0x01, 0x3E, 0x00, 0x32, 0x00, 0x20, 0x76};
+            },
+            [](int lane, bool bottomIsROM)
+            {
+                return bottomIsROM ? uint8_t(0) : uint8_t(lane + 1);
+            }},
+        
+        //IN goes through each machine's own interpreter, which gives three times the port
+        //0100: IN <lane> ; STA 2000 ; HLT
+        {"Reading input",
+            [](int lane)
+            {
+                return std::vector<uint8_t>{0xDB, uint8_t(lane), 0x32, 0x00, 0x20, 0x76};
+            },
+            [](int lane, bool)
+            {
+                return uint8_t(lane * 3);
+            }}
+    };
+    
+    std::vector<Intel_8080_Emulator*> getPointers(const std::vector<std::unique_ptr<TestMachine>>& machines)
+    {
+        std::vector<Intel_8080_Emulator*> pointers;
+        
+        for(const std::unique_ptr<TestMachine>& machine : machines)
+        {
+            pointers.push_back(machine.get());
+        }
+        
+        return pointers;
+    }
+    
+    //Runs every lane until it halts and checks what each left. With the bottom of memory as ROM, lanes loaded with the same code
+    //share what is decoded from it and ones with different code mustn't
+    bool runsCase(const LockstepCase& lockstepCase, bool bottomIsROM)
+    {
+        std::vector<std::unique_ptr<TestMachine>> machines;
+        
+        for(int lane = 0; lane < machineCount; ++lane)
+        {
+            TestMachine& machine = *machines.emplace_back(std::make_unique<TestMachine>());
+            
+            if(bottomIsROM)
+            {
+                machine.mapROM(0x0000, 0x1000);
+            }
+            
+            const uint8_t count[] = {uint8_t(lane + 1)};
+            machine.loadMemory(0x3000, count);
+            machine.loadProgram(lockstepCase.program(lane), 0x100, 0x100);
+        }
+        
+        LockstepInterpreter interpreter(getPointers(machines));
+        std::array<uint64_t, machineCount> cycles;
+        cycles.fill(10000);
+        interpreter.runFor(cycles);
+        
+        bool passed = true;
+        uint64_t instructionCount = 0;
+        
+        for(int lane = 0; lane < machineCount; ++lane)
+        {
+            const uint8_t expected = lockstepCase.expected(lane, bottomIsROM);
+            instructionCount += machines[lane]->getInstructionCount();
+            
+            if(machines[lane]->readMemory(0x2000) != expected)
+            {
+                std::cout << lockstepCase.name << (bottomIsROM ? " from ROM" : "") << " left " << int(machines[lane]->readMemory(0x2000))
+                          << " in lane " << lane << " instead of " << int(expected) << std::endl;
+                passed = false;
+            }
+        }
+        
+        //Lanes at the same address have to be run together, not one after another
+        if(interpreter.getInstructionCount() != instructionCount || interpreter.getStepCount() >= instructionCount)
+        {
+            std::cout << lockstepCase.name << (bottomIsROM ? " from ROM" : "") << " ran " << instructionCount << " instructions in "
+                      << interpreter.getStepCount() << " steps" << std::endl;
+            passed = false;
+        }
+        
+        return passed;
+    }
+    
+    //Each lane is given an RST 1 after some runs, at different times to the others, and has an event due at its own cycle
+    //Lanes that aren't multiples of 4 are interrupted 3 times, the rest never
+    bool takesInterruptsAndEvents()
+    {
+        //0008: PUSH PSW ; LDA 2000 ; INR A ; STA 2000 ; POP PSW ; EI ; RET
+        const uint8_t handler[] = {0xF5, 0x3A, 0x00, 0x20, 0x3C, 0x32, 0x00, 0x20, 0xF1, 0xFB, 0xC9};
+        
+        //0100: LXI SP,3000 ; EI ; 0104: JMP 0104
+        const std::vector<uint8_t> program = {0x31, 0x00, 0x30, 0xFB, 0xC3, 0x04, 0x01};
+        
+        constexpr int runCount = 10;
+        
+        std::vector<std::unique_ptr<TestMachine>> machines;
+        
+        for(int lane = 0; lane < machineCount; ++lane)
+        {
+            TestMachine& machine = *machines.emplace_back(std::make_unique<TestMachine>());
+            machine.loadMemory(0x8, handler);
+            machine.loadProgram(program, 0x100, 0x100);
+            machine.scheduleEvent(100 + lane * 10, lane);
+        }
+        
+        LockstepInterpreter interpreter(getPointers(machines));
+        std::array<uint64_t, machineCount> cycles;
+        
+        for(int lane = 0; lane < machineCount; ++lane)
+        {
+            cycles[lane] = 100 + lane;
+        }
+        
+        for(int run = 0; run < runCount; ++run)
+        {
+            interpreter.runFor(cycles);
+            
+            for(int lane = 0; lane < machineCount; ++lane)
+            {
+                if(run < runCount - 1 && lane % 4 != 0 && (run + lane) % 3 == 0)
+                {
+                    machines[lane]->performInterrupt(0xCF);
+                }
+            }
+        }
+        
+        bool passed = true;
+        
+        for(int lane = 0; lane < machineCount; ++lane)
+        {
+            const int expected = lane % 4 != 0 ? 3 : 0;
+            
+            if(machines[lane]->readMemory(0x2000) != expected || machines[lane]->getHandledEvents() != std::vector<uint8_t>{uint8_t(lane)})
+            {
+                std::cout << "Lane " << lane << " ran its interrupt handler " << int(machines[lane]->readMemory(0x2000)) << " times instead of " << expected
+                          << ", or ran the wrong events" << std::endl;
+                passed = false;
+            }
+            
+            if(machines[lane]->getCycleCount() < uint64_t(runCount * (100 + lane)))
+            {
+                std::cout << "Lane " << lane << " ran for " << machines[lane]->getCycleCount() << " cycles, fewer than it was asked to" << std::endl;
+                passed = false;
+            }
+        }
+        
+        return passed;
+    }
+    
+    //cpudiag checks every instruction did what it should, and prints through OUT, so every lane has to print that it passed
+    //The lanes are each run a little first so they start out of step
+    bool passesCpudiag(std::span<const uint8_t> cpudiag)
+    {
+        std::array<std::ostringstream, machineCount> consoles;
+        std::vector<std::unique_ptr<CpmMachine<>>> machines;
+        std::vector<Intel_8080_Emulator*> pointers;
+        
+        for(int lane = 0; lane < machineCount; ++lane)
+        {
+            CpmMachine<>& machine = *machines.emplace_back(std::make_unique<CpmMachine<>>(consoles[lane]));
+            machine.loadProgram(cpudiag);
+            machine.run(lane * 37);
+            pointers.push_back(&machine);
+        }
+        
+        LockstepInterpreter interpreter(pointers);
+        std::array<uint64_t, machineCount> cycles;
+        cycles.fill(1000000);
+        interpreter.runFor(cycles);
+        
+        bool passed = true;
+        
+        for(int lane = 0; lane < machineCount; ++lane)
+        {
+            if(consoles[lane].str().find("CPU IS OPERATIONAL") == std::string::npos)
+            {
+                std::cout << "cpudiag failed in lane " << lane << ": " << consoles[lane].str() << std::endl;
+                passed = false;
+            }
+        }
+        
+        return passed;
+    }
+}
+
+//Runs programs with known answers on every lane of the lockstep interpreter, the same code and different code at the same address,
+//from RAM and from ROM, with input, interrupts and events, and then cpudiag
+//Usage: lockstep_test <cpudiag.bin>
+int main(int argc, char const** argv)
+{
+    if(argc != 2)
+    {
+        std::cout << "Usage: " << argv[0] << " <cpudiag.bin>" << std::endl;
+        return EXIT_FAILURE;
+    }
+    
+    const std::vector<uint8_t> cpudiag = readFile(argv[1]);
+    bool passed = !cpudiag.empty();
+    
+    for(const LockstepCase& lockstepCase : cases)
+    {
+        passed &= runsCase(lockstepCase, false);
+        passed &= runsCase(lockstepCase, true);
+    }
+    
+    passed &= takesInterruptsAndEvents();
+    passed &= passesCpudiag(cpudiag);
+    
+    std::cout << (passed ? "Lockstep interpreter runs every lane correctly" : "Lockstep interpreter doesn't run every lane correctly") << std::endl;
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,88 @@
+//
+//  MakeTestROM.cpp
+//  Intel_8080_Emulator
+//
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <initializer_list>
+#include <iostream>
+#include <string>
+
+namespace
+{
+    constexpr size_t romSize = 0x2000;
+    constexpr size_t romFileSize = 0x800;
+    
+    void place(std::array<uint8_t, romSize>& rom, uint16_t address, std::initializer_list<uint8_t> code)
+    {
+        std::copy(code.begin(), code.end(), rom.begin() + address);
+    }
+    
+    //A small program for the Space Invaders hardware that uses both interrupts, the inputs and the shift register,
+    //and keeps a loop running between interrupts, so the tests don't need the real ROM
+    std::array<uint8_t, romSize> makeROM()
+    {
+        std::array<uint8_t, romSize> rom{};
+        
+        //LXI SP,2400 ; EI ; LXI H,0100 ; PCHL
+        //The loop is only ever reached through PCHL, so translating the ROM ahead of time can't find it and it has to be interpreted
+        place(rom, 0x0000, {0x31, 0x00, 0x24, 0xFB, 0x21, 0x00, 0x01, 0xE9});
+        
+        //RST 1 and RST 2, the middle and end of the screen
+        place(rom, 0x0008, {0xC3, 0x40, 0x00});
+        place(rom, 0x0010, {0xC3, 0x80, 0x00});
+        
+        //Counts frames at 2000, mixes both input ports into 2002 and keeps a decimal adjusted copy at 2003
+        //PUSH PSW ; PUSH B ; PUSH H ; LHLD 2000 ; INX H ; SHLD 2000 ; IN 1 ; MOV B,A ; IN 2 ; XRA B ; LXI H,2002 ; ADD M ; MOV M,A ; DAA ; STA 2003 ; POP H ; POP B ; POP PSW ; EI ; RET
+        place(rom, 0x0040, {0xF5, 0xC5, 0xE5, 0x2A, 0x00, 0x20, 0x23, 0x22, 0x00, 0x20, 0xDB, 0x01, 0x47, 0xDB, 0x02, 0xA8,
+                            0x21, 0x02, 0x20, 0x86, 0x77, 0x27, 0x32, 0x03, 0x20, 0xE1, 0xC1, 0xF1, 0xFB, 0xC9});
+        
+        //Shifts the input mix against a constant by the frame count and draws the result somewhere in video memory picked by the frame count
+        //PUSH PSW ; PUSH D ; PUSH H ; LDA 2002 ; OUT 4 ; MVI A,A5 ; OUT 4 ; LDA 2000 ; ANI 7 ; OUT 2 ; IN 3 ; MOV D,A ; LHLD 2000 ; MOV A,H ; ANI 1B ; ORI 24 ; MOV H,A ; MOV M,D ; POP H ; POP D ; POP PSW ; EI ; RET
+        place(rom, 0x0080, {0xF5, 0xD5, 0xE5, 0x3A, 0x02, 0x20, 0xD3, 0x04, 0x3E, 0xA5, 0xD3, 0x04, 0x3A, 0x00, 0x20, 0xE6,
+                            0x07, 0xD3, 0x02, 0xDB, 0x03, 0x57, 0x2A, 0x00, 0x20, 0x7C, 0xE6, 0x1B, 0xF6, 0x24, 0x67, 0x72,
+                            0xE1, 0xD1, 0xF1, 0xFB, 0xC9});
+        
+        //Adds a falling count to each byte of 2100-213F forever
+        //LXI H,2100 ; MVI B,40 ; loop: MOV A,M ; ADD B ; MOV M,A ; INX H ; DCR B ; JNZ loop ; JMP 0100
+        place(rom, 0x0100, {0x21, 0x00, 0x21, 0x06, 0x40, 0x7E, 0x80, 0x77, 0x23, 0x05, 0xC2, 0x05, 0x01, 0xC3, 0x00, 0x01});
+        
+        return rom;
+    }
+}
+
+//Writes the test program as invaders.h to invaders.e in the given directory
+//Usage: make_test_rom <directory>
+int main(int argc, char const** argv)
+{
+    if(argc != 2)
+    {
+        std::cout << "Usage: " << argv[0] << " <directory>" << std::endl;
+        return EXIT_FAILURE;
+    }
+    
+    const std::filesystem::path directory = argv[1];
+    std::filesystem::create_directories(directory);
+    
+    const std::array<uint8_t, romSize> rom = makeROM();
+    const std::string extensions = "hgfe";
+    
+    for(size_t fileIndex = 0; fileIndex < extensions.size(); ++fileIndex)
+    {
+        std::ofstream fileStream(directory / ("invaders." + extensions.substr(fileIndex, 1)), std::ios::binary);
+        fileStream.write(reinterpret_cast<const char*>(rom.data() + fileIndex * romFileSize), romFileSize);
+        
+        if(!fileStream)
+        {
+            std::cout << "Couldn't write to " << directory << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+    
+    return EXIT_SUCCESS;
+}
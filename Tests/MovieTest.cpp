@@ -0,0 +1,153 @@
+//
+//  MovieTest.cpp
+//  Intel_8080_Emulator
+//
+
+#include "InputMovie.hpp"
+#include "SpaceInvaders.hpp"
+
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+
+namespace
+{
+    constexpr uint64_t frameCount = 5000;
+    
+    //Plays the movie from power on, with the given frame's inputs changed if there is one, and returns the RAM hash at the end
+    uint64_t play(const char* romDirectory, const InputMovie& movie, bool recompiled, uint64_t changedFrame = UINT64_MAX)
+    {
+        SpaceInvaders machine;
+        machine.loadGame(romDirectory);
+        machine.setSoundOutput(nullptr);
+        machine.setRecompilerEnabled(recompiled);
+        
+        for(uint64_t frame = 0; frame < movie.getFrameCount(); ++frame)
+        {
+            SpaceInvaders::Inputs frameInputs = movie.getFrame(frame);
+            
+            if(frame == changedFrame)
+            {
+                frameInputs.port1 ^= 0x20;
+            }
+            
+            machine.runFrame(frameInputs);
+        }
+        
+        return machine.getRAMHash();
+    }
+}
+
+//Records the test ROM played with random inputs, then plays it back from the file, interpreted and recompiled
+//Usage: movie_test <rom directory>
+int main(int argc, char const** argv)
+{
+    if(argc != 2)
+    {
+        std::cout << "Usage: " << argv[0] << " <rom directory>" << std::endl;
+        return EXIT_FAILURE;
+    }
+    
+    SpaceInvaders recorder;
+    
+    if(!recorder.loadGame(argv[1]))
+    {
+        std::cout << "Warning game failed to load from " << argv[1] << std::endl;
+        return EXIT_FAILURE;
+    }
+    
+    recorder.setSoundOutput(nullptr);
+    
+    InputMovie recording;
+    recording.setROMHash(recorder.getROMHash());
+    std::mt19937 random(5);
+    
+    for(uint64_t frame = 0; frame < frameCount; ++frame)
+    {
+        SpaceInvaders::Inputs frameInputs;
+        
+        if(random() % 10 == 0)
+        {
+            frameInputs.port1 = random();
+            frameInputs.port2 = random();
+        }
+        
+        recorder.runFrame(frameInputs);
+        recording.addFrame(recorder.getInputs());
+    }
+    
+    recording.setRAMHash(recorder.getRAMHash());
+    
+    std::ostringstream fileStream;
+    recording.write(fileStream);
+    const std::string file = fileStream.str();
+    
+    InputMovie movie;
+    std::istringstream readStream(file);
+    bool passed = true;
+    
+    if(!movie.read(readStream) || movie.getFrameCount() != frameCount || movie.getROMHash() != recording.getROMHash())
+    {
+        std::cout << "Couldn't read back the movie" << std::endl;
+        return EXIT_FAILURE;
+    }
+    
+    if(play(argv[1], movie, false) != movie.getRAMHash())
+    {
+        std::cout << "Interpreted replay doesn't match the recording" << std::endl;
+        passed = false;
+    }
+    
+    if(SpaceInvaders().setRecompilerEnabled(true) && play(argv[1], movie, true) != movie.getRAMHash())
+    {
+        std::cout << "Recompiled replay doesn't match the recording" << std::endl;
+        passed = false;
+    }
+    
+    //The hash has to catch a single frame played differently
+    if(play(argv[1], movie, false, frameCount / 2) == movie.getRAMHash())
+    {
+        std::cout << "Changing a frame's inputs didn't change the replay" << std::endl;
+        passed = false;
+    }
+    
+    //Files cut short are refused, and leave the movie as it was
+    for(const size_t length : {size_t(0), size_t(10), size_t(36), file.size() - 1})
+    {
+        InputMovie cutShort;
+        cutShort.addFrame(SpaceInvaders::Inputs());
+        std::istringstream cutStream(file.substr(0, length));
+        
+        if(cutShort.read(cutStream) || cutShort.getFrameCount() != 1)
+        {
+            std::cout << "Read a movie cut short at " << length << " bytes" << std::endl;
+            passed = false;
+        }
+    }
+    
+    //Stepping back while recording takes the frames off the end, and carrying on from the state there has to replay the same
+    InputMovie rewound = movie;
+    rewound.truncate(frameCount / 2);
+    
+    SpaceInvaders machine;
+    machine.loadGame(argv[1]);
+    machine.setSoundOutput(nullptr);
+    
+    for(uint64_t frame = 0; frame < rewound.getFrameCount(); ++frame)
+    {
+        machine.runFrame(rewound.getFrame(frame));
+    }
+    
+    rewound.setRAMHash(machine.getRAMHash());
+    
+    if(rewound.getFrameCount() != frameCount / 2 || play(argv[1], rewound, false) != rewound.getRAMHash())
+    {
+        std::cout << "Truncated movie doesn't replay" << std::endl;
+        passed = false;
+    }
+    
+    std::cout << (passed ? "Movies replay exactly" : "Movies don't replay exactly") << std::endl;
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,115 @@
+//
+//  OpcodeTableTest.cpp
+//  Intel_8080_Emulator
+//
+
+#include "TestMachine.hpp"
+
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+    //Sets every register and some flags, then runs the opcode at 0x010F with 0x1234 after it
+    //0100: LXI SP,3000 ; LXI B,2010 ; LXI D,2020 ; LXI H,2030 ; MVI A,5A ; ADD A ; <opcode> 34 12
+    constexpr int setupSteps = 6;
+    constexpr uint16_t opcodeAddress = 0x10F;
+    
+    void loadOpcode(TestMachine& machine, uint8_t opcode)
+    {
+        const std::vector<uint8_t> program = {0x31, 0x00, 0x30, 0x01, 0x10, 0x20, 0x11, 0x20, 0x20, 0x21, 0x30, 0x20, 0x3E, 0x5A, 0x87,
+                                              opcode, 0x34, 0x12};
+        
+        //Somewhere for RET to go back to
+        const uint8_t stack[] = {0x78, 0x56};
+        
+        machine.loadMemory(0x3000, stack);
+        machine.loadProgram(program, 0x100, 0x100);
+        
+        for(int step = 0; step < setupSteps; ++step)
+        {
+            machine.step();
+        }
+    }
+    
+    //Each opcode's handler in the table has to do exactly what walking the switches finds for it
+    bool tableMatchesSwitches()
+    {
+        bool passed = true;
+        
+        for(int opcode = 0; opcode < 256; ++opcode)
+        {
+            TestMachine table;
+            TestMachine switches;
+            switches.setSwitchDispatch(true);
+            
+            for(TestMachine* machine : {&table, &switches})
+            {
+                loadOpcode(*machine, opcode);
+                machine->step();
+            }
+            
+            if(table.getState() != switches.getState())
+            {
+                std::cout << "Opcode 0x" << std::hex << opcode << std::dec << " runs differently through the table" << std::endl;
+                passed = false;
+            }
+        }
+        
+        return passed;
+    }
+    
+    //The undocumented opcodes have to run as the documented ones they copy, taking as long and going to the same place
+    bool runsAsCopy(uint8_t opcode, uint16_t expectedProgramCounter, uint64_t expectedCycles, bool dispatchBySwitch)
+    {
+        TestMachine machine;
+        machine.setSwitchDispatch(dispatchBySwitch);
+        loadOpcode(machine, opcode);
+        
+        const uint64_t startCycle = machine.getCycleCount();
+        machine.step();
+        
+        const uint64_t cycles = machine.getCycleCount() - startCycle;
+        
+        if(machine.getProgramCounter() != expectedProgramCounter || cycles != expectedCycles)
+        {
+            std::cout << "Opcode 0x" << std::hex << int(opcode) << " went to 0x" << machine.getProgramCounter() << std::dec << " in " << cycles
+                      << " cycles" << (dispatchBySwitch ? " through the switches" : "") << std::endl;
+            return false;
+        }
+        
+        return true;
+    }
+}
+
+//Checks every opcode's handler against the switches it replaced, and that the undocumented opcodes run as what they copy
+//Usage: opcode_table_test
+int main()
+{
+    bool passed = tableMatchesSwitches();
+    
+    for(const bool dispatchBySwitch : {false, true})
+    {
+        //NOP
+        for(const uint8_t opcode : {0x08, 0x10, 0x18, 0x20, 0x28, 0x30, 0x38})
+        {
+            passed &= runsAsCopy(opcode, opcodeAddress + 1, 4, dispatchBySwitch);
+        }
+        
+        //JMP
+        passed &= runsAsCopy(0xCB, 0x1234, 10, dispatchBySwitch);
+        
+        //CALL
+        for(const uint8_t opcode : {0xDD, 0xED, 0xFD})
+        {
+            passed &= runsAsCopy(opcode, 0x1234, 17, dispatchBySwitch);
+        }
+        
+        //RET
+        passed &= runsAsCopy(0xD9, 0x5678, 10, dispatchBySwitch);
+    }
+    
+    std::cout << (passed ? "Handler table runs every opcode" : "Handler table doesn't run every opcode") << std::endl;
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,190 @@
+//
+//  RecompilerTest.cpp
+//  Intel_8080_Emulator
+//
+
+#include "CpmMachine.hpp"
+#include "TestMachine.hpp"
+
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+namespace
+{
+    class RecompiledCpmMachine : public CpmMachine<>
+    {
+    public:
+        using CpmMachine::CpmMachine;
+        using Intel_8080_Emulator::setRecompilerEnabled;
+    };
+    
+    //cpudiag only prints that it passed if every instruction it checks did what it should, and its BDOS calls go out through OUT
+    bool passesCpudiag(std::span<const uint8_t> cpudiag)
+    {
+        std::ostringstream console;
+        RecompiledCpmMachine machine(console);
+        machine.setRecompilerEnabled(true);
+        
+        if(!machine.loadProgram(cpudiag) || !machine.run(100000000) || console.str().find("CPU IS OPERATIONAL") == std::string::npos)
+        {
+            std::cout << "cpudiag failed through the recompiler: " << console.str() << std::endl;
+            return false;
+        }
+        
+        return true;
+    }
+    
+    //Runs the program from 0x0100 until it halts, with or without the recompiler, and checks what it left at 0x2000
+    bool leaves(const char* name, std::span<const uint8_t> program, uint8_t expected)
+    {
+        bool passed = true;
+        
+        for(const bool recompiled : {false, true})
+        {
+            TestMachine machine;
+            machine.loadProgram(program, 0x100, 0x100);
+            machine.setRecompilerEnabled(recompiled);
+            machine.runFor(10000);
+            
+            if(machine.readMemory(0x2000) != expected)
+            {
+                std::cout << name << " left " << int(machine.readMemory(0x2000)) << " instead of " << int(expected) << (recompiled ? " with the recompiler" : "") << std::endl;
+                passed = false;
+            }
+        }
+        
+        return passed;
+    }
+    
+    //A block that writes over code it runs later on has to run what it wrote, not what it was translated from
+    bool seesOwnWrites()
+    {
+        //Turns the NOP at 0x0106 into INR B just before reaching it
+        //0100: MVI A,04 ; STA 0106 ; NOP ; NOP ; MOV A,B ; STA 2000 ; HLT
+        const std::vector<uint8_t> patchesAhead = {0x3E, 0x04, 0x32, 0x06, 0x01, 0x00, 0x00, 0x78, 0x32, 0x00, 0x20, 0x76};
+        
+        //Flips the NOP at 0x010E between NOP and INR B every time round the loop, so B is incremented on 5 of the 10
+        //0100: MVI C,0A ; 0102: LDA 0130 ; XRI 04 ; STA 0130 ; STA 010E ; NOP ; NOP ; DCR C ; JNZ 0102 ; MOV A,B ; STA 2000 ; HLT
+        std::vector<uint8_t> flipsInLoop = {0x0E, 0x0A, 0x3A, 0x30, 0x01, 0xEE, 0x04, 0x32, 0x30, 0x01, 0x32, 0x0E, 0x01, 0x00, 0x00, 0x0D,
+                                            0xC2, 0x02, 0x01, 0x78, 0x32, 0x00, 0x20, 0x76};
+        flipsInLoop.resize(0x31);
+        
+        bool passed = leaves("Writing ahead in the block", patchesAhead, 1);
+        passed &= leaves("Flipping code in a loop", flipsInLoop, 5);
+        return passed;
+    }
+    
+    //Code replaced from outside has to be translated again, and only pages code was translated from are watched
+    bool seesReplacedCode()
+    {
+        //0100: MVI A,11 ; STA 2000 ; 0105: JMP 0105
+        const std::vector<uint8_t> program = {0x3E, 0x11, 0x32, 0x00, 0x20, 0xC3, 0x05, 0x01};
+        const uint8_t replacedOperand[] = {0x22};
+        
+        TestMachine machine;
+        machine.loadProgram(program, 0x100, 0x100);
+        machine.setRecompilerEnabled(true);
+        machine.runFor(1000);
+        
+        bool passed = machine.readMemory(0x2000) == 0x11;
+        
+        if(!machine.isPageWatched(0x01) || machine.isPageWatched(0x20))
+        {
+            std::cout << "Recompiler watched the wrong pages" << std::endl;
+            passed = false;
+        }
+        
+        machine.loadProgram(replacedOperand, 0x101, 0x100);
+        machine.runFor(1000);
+        
+        if(!passed || machine.readMemory(0x2000) != 0x22)
+        {
+            std::cout << "Recompiler ran code that had been replaced" << std::endl;
+            return false;
+        }
+        
+        return true;
+    }
+    
+    //IN goes back to the machine, which gives three times the port
+    bool readsInput()
+    {
+        //0100: IN 05 ; MOV B,A ; IN 07 ; ADD B ; STA 2000 ; HLT
+        const std::vector<uint8_t> program = {0xDB, 0x05, 0x47, 0xDB, 0x07, 0x80, 0x32, 0x00, 0x20, 0x76};
+        
+        return leaves("Reading input", program, 36);
+    }
+    
+    //Translated code has to stop where runFor asks, so interrupts come in between its instructions and the handler runs every time
+    bool takesInterrupts()
+    {
+        //0008: INR D ; MOV A,D ; STA 2000 ; EI ; RET
+        const uint8_t handler[] = {0x14, 0x7A, 0x32, 0x00, 0x20, 0xFB, 0xC9};
+        
+        //0100: LXI SP,3000 ; EI ; 0104: INR B ; JMP 0104
+        const std::vector<uint8_t> program = {0x31, 0x00, 0x30, 0xFB, 0x04, 0xC3, 0x04, 0x01};
+        
+        constexpr int interruptCount = 10;
+        constexpr uint64_t runCycles = 1000;
+        
+        TestMachine machine;
+        machine.loadMemory(0x8, handler);
+        machine.loadProgram(program, 0x100, 0x100);
+        machine.setRecompilerEnabled(true);
+        
+        for(int interrupt = 0; interrupt <= interruptCount; ++interrupt)
+        {
+            //Stopping can only wait for the instruction that was running to finish
+            const uint64_t cyclesRun = machine.runFor(runCycles);
+            
+            if(cyclesRun < runCycles || cyclesRun > runCycles + 17)
+            {
+                std::cout << "Recompiled code ran for " << cyclesRun << " cycles when asked for " << runCycles << std::endl;
+                return false;
+            }
+            
+            if(interrupt < interruptCount)
+            {
+                machine.performInterrupt(0xCF);
+            }
+        }
+        
+        if(machine.readMemory(0x2000) != interruptCount)
+        {
+            std::cout << "Interrupt handler ran " << int(machine.readMemory(0x2000)) << " times instead of " << interruptCount << std::endl;
+            return false;
+        }
+        
+        return true;
+    }
+}
+
+//Runs cpudiag, code that rewrites itself, input and interrupts through the recompiler, checking each gives the answer it should
+//Usage: recompiler_test <cpudiag.bin>
+int main(int argc, char const** argv)
+{
+    if(argc != 2)
+    {
+        std::cout << "Usage: " << argv[0] << " <cpudiag.bin>" << std::endl;
+        return EXIT_FAILURE;
+    }
+    
+    if(!TestMachine().setRecompilerEnabled(true))
+    {
+        std::cout << "Recompiler isn't available on this host" << std::endl;
+        return testSkipped;
+    }
+    
+    const std::vector<uint8_t> cpudiag = readFile(argv[1]);
+    
+    bool passed = passesCpudiag(cpudiag);
+    passed &= seesOwnWrites();
+    passed &= seesReplacedCode();
+    passed &= readsInput();
+    passed &= takesInterrupts();
+    
+    std::cout << (passed ? "Recompiled code runs correctly" : "Recompiled code doesn't run correctly") << std::endl;
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,160 @@
+//
+//  RewindTest.cpp
+//  Intel_8080_Emulator
+//
+
+#include "RewindBuffer.hpp"
+#include "SpaceInvaders.hpp"
+
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace
+{
+    std::vector<uint8_t> getBytes(const Snapshot& snapshot)
+    {
+        std::vector<uint8_t> data;
+        snapshot.write(data);
+        return data;
+    }
+    
+    //Runs frames into the buffer, stepping back a random number of frames now and again and carrying on from there like the app does
+    //Every frame still held has to come back exactly as it was pushed, and the buffer has to keep to its budget
+    bool framesComeBack(const char* romDirectory, size_t memoryBudget)
+    {
+        SpaceInvaders machine;
+        machine.loadGame(romDirectory);
+        machine.setSoundOutput(nullptr);
+        
+        RewindBuffer rewindBuffer(memoryBudget, 60);
+        std::vector<std::vector<uint8_t>> pushedFrames;
+        std::mt19937 random(1);
+        Snapshot frameState;
+        
+        for(int frame = 0; frame < 3000; ++frame)
+        {
+            SpaceInvaders::Inputs frameInputs;
+            frameInputs.port1 |= random() & 0x70;
+            machine.runFrame(frameInputs);
+            
+            machine.snapshot(frameState);
+            rewindBuffer.push(frameState);
+            pushedFrames.push_back(getBytes(frameState));
+            
+            //Past the budget, the buffer can still go over while it only holds the latest keyframe's frames
+            if(rewindBuffer.getMemoryUsed() > memoryBudget && rewindBuffer.getFrameCount() > 60)
+            {
+                std::cout << "Buffer went over its budget at frame " << frame << std::endl;
+                return false;
+            }
+            
+            if(frame % 97 == 96)
+            {
+                const size_t framesBack = random() % std::min<size_t>(rewindBuffer.getFrameCount(), 150);
+                rewindBuffer.dropLatest(framesBack);
+                pushedFrames.resize(pushedFrames.size() - framesBack);
+                
+                if(!rewindBuffer.getFrame(0, frameState) || getBytes(frameState) != pushedFrames.back())
+                {
+                    std::cout << "Stepping back " << framesBack << " frames at frame " << frame << " didn't give the frame pushed" << std::endl;
+                    return false;
+                }
+                
+                machine.restore(frameState);
+            }
+        }
+        
+        for(size_t framesBack = 0; framesBack < rewindBuffer.getFrameCount(); ++framesBack)
+        {
+            if(!rewindBuffer.getFrame(framesBack, frameState) || getBytes(frameState) != pushedFrames[pushedFrames.size() - 1 - framesBack])
+            {
+                std::cout << "Frame " << framesBack << " back isn't the frame pushed" << std::endl;
+                return false;
+            }
+        }
+        
+        if(rewindBuffer.getFrame(rewindBuffer.getFrameCount(), frameState))
+        {
+            std::cout << "Got back a frame older than the buffer holds" << std::endl;
+            return false;
+        }
+        
+        return true;
+    }
+    
+    //Keys belong to the player, so stepping back to a frame they were held down in mustn't hold them down again
+    bool keysAreLeftAlone(const char* romDirectory)
+    {
+        constexpr int spaceKey = 32;
+        constexpr uint8_t spaceInputs = 0x15;
+        
+        SpaceInvaders machine;
+        machine.loadGame(romDirectory);
+        machine.setSoundOutput(nullptr);
+        
+        //Key presses are picked up at the start of the next frame, so each is run through a frame before stepping back
+        machine.triggerKeyDown(spaceKey, 0, 0);
+        machine.runFrame();
+        
+        Snapshot heldDown;
+        machine.snapshot(heldDown);
+        
+        machine.triggerKeyUp(spaceKey, 0, 0);
+        machine.runFrame();
+        machine.restore(heldDown);
+        machine.runFrame();
+        
+        if(machine.getInputs().port1 & spaceInputs)
+        {
+            std::cout << "Stepping back held down a key that had been let go" << std::endl;
+            return false;
+        }
+        
+        Snapshot letGo;
+        machine.snapshot(letGo);
+        
+        machine.triggerKeyDown(spaceKey, 0, 0);
+        machine.runFrame();
+        machine.restore(letGo);
+        machine.runFrame();
+        
+        if((machine.getInputs().port1 & spaceInputs) != spaceInputs)
+        {
+            std::cout << "Stepping back let go of a key that was held down" << std::endl;
+            return false;
+        }
+        
+        return true;
+    }
+}
+
+//Steps back and forth through a rewind buffer of the test ROM, within and over its memory budget
+//Usage: rewind_test <rom directory>
+int main(int argc, char const** argv)
+{
+    if(argc != 2)
+    {
+        std::cout << "Usage: " << argv[0] << " <rom directory>" << std::endl;
+        return EXIT_FAILURE;
+    }
+    
+    if(!SpaceInvaders().loadGame(argv[1]))
+    {
+        std::cout << "Warning game failed to load from " << argv[1] << std::endl;
+        return EXIT_FAILURE;
+    }
+    
+    bool passed = true;
+    
+    for(const size_t memoryBudget : {size_t(16 << 20), size_t(200000)})
+    {
+        passed &= framesComeBack(argv[1], memoryBudget);
+    }
+    
+    passed &= keysAreLeftAlone(argv[1]);
+    
+    std::cout << (passed ? "Rewinding gives back every frame" : "Rewinding doesn't give back every frame") << std::endl;
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,279 @@
+//
+//  SnapshotTest.cpp
+//  Intel_8080_Emulator
+//
+
+#include "TestMachine.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+    //Sets every register and the carry, enables interrupts and halts. The RST 2 handler pushes everything, then halts again
+    //0010: PUSH PSW ; PUSH B ; PUSH D ; PUSH H ; HLT
+    //0100: LXI SP,3000 ; LXI B,1122 ; LXI D,3344 ; LXI H,5566 ; MVI A,77 ; STC ; 010F: EI ; HLT
+    void loadStateProgram(TestMachine& machine)
+    {
+        const uint8_t handler[] = {0xF5, 0xC5, 0xD5, 0xE5, 0x76};
+        const std::vector<uint8_t> program = {0x31, 0x00, 0x30, 0x01, 0x22, 0x11, 0x11, 0x44, 0x33, 0x21, 0x66, 0x55, 0x3E, 0x77, 0x37, 0xFB, 0x76};
+        
+        machine.loadMemory(0x10, handler);
+        machine.loadProgram(program, 0x100, 0x100);
+    }
+    
+    //Takes one snapshot before EI and one once halted with an event due, and checks restoring them puts back exactly the state each was taken in,
+    //whatever state the machine was in before
+    bool restoresEveryPart()
+    {
+        TestMachine original;
+        loadStateProgram(original);
+        
+        for(int step = 0; step < 6; ++step)
+        {
+            original.step();
+        }
+        
+        Snapshot beforeInterrupts;
+        original.snapshot(beforeInterrupts);
+        
+        original.scheduleEvent(200, 7);
+        original.step();
+        original.step();
+        
+        Snapshot halted;
+        original.snapshot(halted);
+        
+        TestMachine machine;
+        machine.restore(halted);
+        
+        //Halted, so nothing runs until the event is due
+        machine.runFor(100);
+        bool passed = machine.getInstructionCount() == 8 && machine.getHandledEvents().empty();
+        
+        machine.runFor(100);
+        passed &= machine.getHandledEvents() == std::vector<uint8_t>{7};
+        
+        //Interrupts are enabled, and the handler pushes the registers, flags and where it was halted
+        machine.performInterrupt(0xD7);
+        machine.runFor(100);
+        
+        const std::vector<uint8_t> expectedStack = {0x66, 0x55, 0x44, 0x33, 0x22, 0x11, 0x03, 0x77, 0x11, 0x01};
+        
+        for(size_t index = 0; index < expectedStack.size(); ++index)
+        {
+            passed &= machine.readMemory(0x2FF6 + index) == expectedStack[index];
+        }
+        
+        if(!passed)
+        {
+            std::cout << "Restoring the halted snapshot didn't put back its registers, interrupts and events" << std::endl;
+            return false;
+        }
+        
+        //Going back before EI has to leave interrupts disabled, forget the event and take back what was pushed
+        machine.restore(beforeInterrupts);
+        machine.performInterrupt(0xD7);
+        
+        passed = machine.getProgramCounter() == 0x10F && machine.readMemory(0x2FFE) == 0x0;
+        
+        machine.runFor(300);
+        passed &= machine.getProgramCounter() == 0x111 && machine.getHandledEvents().size() == 1;
+        
+        if(!passed)
+        {
+            std::cout << "Restoring the snapshot from before EI kept some of the halted machine's state" << std::endl;
+            return false;
+        }
+        
+        return true;
+    }
+    
+    //Restoring has to throw away anything decoded or translated from the memory it puts back
+    bool runsRestoredCode(bool recompiled)
+    {
+        //0100: MVI A,<value> ; STA 2000 ; HLT
+        const std::vector<uint8_t> first = {0x3E, 0x11, 0x32, 0x00, 0x20, 0x76};
+        const std::vector<uint8_t> second = {0x3E, 0x22, 0x32, 0x00, 0x20, 0x76};
+        
+        TestMachine machine;
+        machine.setRecompilerEnabled(recompiled);
+        machine.loadProgram(first, 0x100, 0x100);
+        
+        Snapshot snapshot;
+        machine.snapshot(snapshot);
+        
+        machine.loadProgram(second, 0x100, 0x100);
+        machine.runFor(100);
+        
+        machine.restore(snapshot);
+        machine.runFor(100);
+        
+        if(machine.readMemory(0x2000) != 0x11)
+        {
+            std::cout << "Restored machine ran the code it had before" << (recompiled ? " with the recompiler" : "") << std::endl;
+            return false;
+        }
+        
+        return true;
+    }
+    
+    //Runs the program for a while between two snapshots, and checks the second copied only the given number of pages
+    bool copiesPages(const char* name, std::span<const uint8_t> program, size_t expectedPages)
+    {
+        TestMachine machine;
+        machine.loadProgram(program, 0x100, 0x100);
+        machine.runFor(1000);
+        
+        Snapshot first;
+        machine.snapshot(first);
+        machine.runFor(1000);
+        
+        Snapshot second;
+        machine.snapshot(second);
+        
+        const size_t unsharedPages = (second.getMemoryUsed(&first) - second.getMemoryUsed(&second)) / sizeof(Snapshot::Page);
+        
+        if(unsharedPages != expectedPages)
+        {
+            std::cout << name << " copied " << unsharedPages << " pages instead of " << expectedPages << std::endl;
+            return false;
+        }
+        
+        return true;
+    }
+    
+    //Snapshots taken one after another share every page not written in between, and a snapshot never changes once taken
+    //whatever the machine writes afterwards, or whichever snapshot it is restored from
+    bool pagesAreShared()
+    {
+        //0100: LXI H,2500 ; 0103: INR M ; JMP 0103
+        const std::vector<uint8_t> incrementing = {0x21, 0x00, 0x25, 0x34, 0xC3, 0x03, 0x01};
+        
+        //0100: LDA 3000 ; STA 3000 ; JMP 0100
+        const std::vector<uint8_t> rewriting = {0x3A, 0x00, 0x30, 0x32, 0x00, 0x30, 0xC3, 0x00, 0x01};
+        
+        bool passed = copiesPages("Writing one page", incrementing, 1);
+        
+        //A page written with what it already held is still shared
+        passed &= copiesPages("Writing a page with what it held", rewriting, 0);
+        
+        TestMachine machine;
+        machine.loadProgram(incrementing, 0x100, 0x100);
+        machine.runFor(1000);
+        
+        Snapshot first;
+        machine.snapshot(first);
+        
+        std::vector<uint8_t> firstData;
+        first.write(firstData);
+        
+        machine.runFor(1000);
+        machine.restore(first);
+        machine.runFor(3000);
+        
+        Snapshot third;
+        machine.snapshot(third);
+        
+        std::vector<uint8_t> firstDataAfter;
+        first.write(firstDataAfter);
+        
+        if(firstDataAfter != firstData)
+        {
+            std::cout << "Snapshot changed after it was taken" << std::endl;
+            return false;
+        }
+        
+        return passed;
+    }
+    
+    //Files are laid out the same on every host, and reading one back has to give the same snapshot. Anything else has to be refused
+    bool fileRoundTrips()
+    {
+        TestMachine machine;
+        loadStateProgram(machine);
+        machine.scheduleEvent(200, 7);
+        
+        for(int step = 0; step < 8; ++step)
+        {
+            machine.step();
+        }
+        
+        const std::vector<uint8_t> data = machine.getState();
+        
+        //Everything from the format version to the one event, little endian, after the 8 byte magic
+        const std::vector<uint8_t> expectedHeader = {0x01, 0x00, 0x00, 0x00, 0x3E, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00,
+                                                     0x00, 0x00, 0x00, 0x00, 0x11, 0x01, 0x22, 0x11, 0x44, 0x33, 0x66, 0x55, 0x00, 0x30, 0x77, 0x03,
+                                                     0x01, 0x01, 0x01, 0x00, 0x00, 0x00, 0xC8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x07};
+        
+        if(data.size() < 8 + expectedHeader.size() || !std::equal(expectedHeader.begin(), expectedHeader.end(), data.begin() + 8))
+        {
+            std::cout << "Snapshot was written in the wrong layout" << std::endl;
+            return false;
+        }
+        
+        Snapshot readBack;
+        
+        if(!readBack.read(data))
+        {
+            std::cout << "Couldn't read back a snapshot" << std::endl;
+            return false;
+        }
+        
+        TestMachine restored;
+        restored.restore(readBack);
+        
+        if(restored.getState() != data)
+        {
+            std::cout << "Snapshot read back differently" << std::endl;
+            return false;
+        }
+        
+        //The format version comes straight after the 8 byte magic, the low byte is enough to make it older or newer
+        std::vector<uint8_t> olderVersion = data;
+        std::vector<uint8_t> newerVersion = data;
+        --olderVersion[8];
+        ++newerVersion[8];
+        
+        const std::span<const uint8_t> truncated(data.data(), data.size() - 1);
+        
+        if(readBack.read(olderVersion) || readBack.read(newerVersion) || readBack.read(truncated) || readBack.read(std::span<const uint8_t>()))
+        {
+            std::cout << "Snapshot read something it should have refused" << std::endl;
+            return false;
+        }
+        
+        //Refused reads leave the snapshot as it was
+        restored.restore(readBack);
+        
+        if(restored.getState() != data)
+        {
+            std::cout << "Refused read changed the snapshot" << std::endl;
+            return false;
+        }
+        
+        return true;
+    }
+}
+
+//Checks restoring snapshots puts back every part of the state and throws away code from what it replaces,
+//sharing pages between them, and reading and writing them
+//Usage: snapshot_test
+int main()
+{
+    bool passed = restoresEveryPart();
+    passed &= runsRestoredCode(false);
+    
+    if(TestMachine().setRecompilerEnabled(true))
+    {
+        passed &= runsRestoredCode(true);
+    }
+    
+    passed &= fileRoundTrips();
+    passed &= pagesAreShared();
+    
+    std::cout << (passed ? "Snapshots restore exactly" : "Snapshots don't restore exactly") << std::endl;
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,95 @@
+//
+//  StaticRecompilerTest.cpp
+//  Intel_8080_Emulator
+//
+
+#include "CpmMachine.hpp"
+#include "RecompiledProgram.hpp"
+#include "TestMachine.hpp"
+
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+//Built with cpudiag translated by static_recompiler
+const RecompiledProgram& getRecompiledProgram();
+
+namespace
+{
+    class RecompiledCpmMachine : public CpmMachine<>
+    {
+    public:
+        using CpmMachine::CpmMachine;
+        using Intel_8080_Emulator::loadMemory;
+        using Intel_8080_Emulator::setRecompiledProgram;
+    };
+    
+    //Runs cpudiag from the translated blocks, after the patch if there is one, and returns what it printed
+    std::string runCpudiag(std::span<const uint8_t> cpudiag, uint16_t patchAddress = 0, std::span<const uint8_t> patch = {})
+    {
+        std::ostringstream console;
+        RecompiledCpmMachine machine(console);
+        machine.loadProgram(cpudiag);
+        
+        if(!machine.setRecompiledProgram(&getRecompiledProgram()))
+        {
+            return "Recompiled program doesn't match cpudiag";
+        }
+        
+        machine.loadMemory(patchAddress, patch);
+        machine.run(100000000);
+        
+        return console.str();
+    }
+}
+
+//Runs cpudiag through the blocks translated ahead of time, which it writes over its own data in, and with its code replaced,
+//both of which have to drop back to interpreting. Then checks the blocks are refused for anything but cpudiag
+//Usage: static_recompiler_test <cpudiag.bin>
+int main(int argc, char const** argv)
+{
+    if(argc != 2)
+    {
+        std::cout << "Usage: " << argv[0] << " <cpudiag.bin>" << std::endl;
+        return EXIT_FAILURE;
+    }
+    
+    const std::vector<uint8_t> cpudiag = readFile(argv[1]);
+    bool passed = true;
+    
+    const std::string output = runCpudiag(cpudiag);
+    
+    if(output.find("CPU IS OPERATIONAL") == std::string::npos)
+    {
+        std::cout << "cpudiag failed through the recompiled program: " << output << std::endl;
+        passed = false;
+    }
+    
+    //Replaces the jump at the start with a program that prints its own message
+    //0100: MVI C,09 ; LXI D,010B ; CALL 0005 ; JMP 0000 ; 010B: "PATCHED$"
+    const std::vector<uint8_t> patch = {0x0E, 0x09, 0x11, 0x0B, 0x01, 0xCD, 0x05, 0x00, 0xC3, 0x00, 0x00, 'P', 'A', 'T', 'C', 'H', 'E', 'D', '$'};
+    const std::string patchedOutput = runCpudiag(cpudiag, 0x100, patch);
+    
+    if(patchedOutput != "PATCHED")
+    {
+        std::cout << "Patched cpudiag ran the recompiled program instead: " << patchedOutput << std::endl;
+        passed = false;
+    }
+    
+    //The blocks are only for the ROM they came from
+    TestMachine otherProgram;
+    const uint8_t changedProgram[] = {0x0};
+    otherProgram.loadProgram(cpudiag, 0x100, 0x100);
+    otherProgram.loadProgram(changedProgram, 0x100, 0x100);
+    
+    if(otherProgram.setRecompiledProgram(&getRecompiledProgram()))
+    {
+        std::cout << "Recompiled program was used on a different ROM" << std::endl;
+        passed = false;
+    }
+    
+    std::cout << (passed ? "Recompiled program runs correctly" : "Recompiled program doesn't run correctly") << std::endl;
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,154 @@
+//
+//  TestMachine.hpp
+//  Intel_8080_Emulator
+//
+
+#pragma once
+
+#include "Intel_8080_Machine.hpp"
+#include "Snapshot.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <span>
+#include <vector>
+
+//Exit code ctest takes as the test being skipped, for things the host can't do
+constexpr int testSkipped = 77;
+
+//The CPU with all RAM behind it for the tests to drive. IN reads back three times the port and OUT does nothing
+//0x0000 halts and 0x0005 returns straight away, so CP/M programs like cpudiag run silently and stop when they finish
+class TestMachine : public Intel_8080_Machine<TestMachine>
+{
+    friend class Intel_8080_Machine<TestMachine>;
+    
+public:
+    TestMachine();
+    
+    //Loads the program at the given address and starts running from start
+    void loadProgram(std::span<const uint8_t> program, uint16_t address, uint16_t start);
+    
+    //Everything a snapshot keeps, as written to a file, so two machines can be compared
+    std::vector<uint8_t> getState() const;
+    
+    //Whether the program has jumped to 0x0000 and halted there
+    bool hasFinished() const;
+    
+    uint16_t getProgramCounter() const;
+    
+    //Whether writes to the page are being watched for anything, like code decoded from it
+    bool isPageWatched(uint8_t page) const;
+    
+    //Turns the range into ROM, which is loaded with loadProgram the same as RAM but can't be written by the program
+    void mapROM(uint16_t start, uint32_t size);
+    
+    void mapMirror(uint16_t start, uint32_t size, uint16_t source);
+    void mapHandler(uint16_t start, uint32_t size, MemoryBus::Handler* handler);
+    
+    //Ids of the scheduled events that have run, in the order they ran
+    const std::vector<uint8_t>& getHandledEvents() const;
+    
+    using Intel_8080_Emulator::runFor;
+    using Intel_8080_Emulator::step;
+    using Intel_8080_Emulator::performInterrupt;
+    using Intel_8080_Emulator::getCycleCount;
+    using Intel_8080_Emulator::getInstructionCount;
+    using Intel_8080_Emulator::scheduleEvent;
+    using Intel_8080_Emulator::snapshot;
+    using Intel_8080_Emulator::restore;
+    using Intel_8080_Emulator::loadMemory;
+    using Intel_8080_Emulator::readMemory;
+    using Intel_8080_Emulator::setRecompilerEnabled;
+    using Intel_8080_Emulator::setRecompiledProgram;
+    using Intel_8080_Emulator::setFusions;
+    using Intel_8080_Emulator::setSwitchDispatch;
+    
+private:
+    uint8_t inputOperation(uint8_t port);
+    void outputOperation(uint8_t port, uint8_t value);
+    
+    void handleEvent(uint8_t eventId, uint64_t dueCycle) override;
+    
+    std::vector<uint8_t> handledEvents;
+};
+
+inline TestMachine::TestMachine()
+{
+    const uint8_t zeroPage[] = {0x76, 0x0, 0x0, 0x0, 0x0, 0xC9};
+    loadMemory(0x0, zeroPage);
+}
+
+inline void TestMachine::loadProgram(std::span<const uint8_t> program, uint16_t address, uint16_t start)
+{
+    loadMemory(address, program);
+    programCounter = start;
+}
+
+inline std::vector<uint8_t> TestMachine::getState() const
+{
+    Snapshot state;
+    snapshot(state);
+    
+    std::vector<uint8_t> data;
+    state.write(data);
+    return data;
+}
+
+inline bool TestMachine::hasFinished() const
+{
+    return programCounter == 0x1;
+}
+
+inline uint16_t TestMachine::getProgramCounter() const
+{
+    return programCounter;
+}
+
+inline bool TestMachine::isPageWatched(uint8_t page) const
+{
+    return memoryBus.isWatched(page);
+}
+
+inline void TestMachine::mapROM(uint16_t start, uint32_t size)
+{
+    memoryBus.mapROM(start, size);
+}
+
+inline void TestMachine::mapMirror(uint16_t start, uint32_t size, uint16_t source)
+{
+    memoryBus.mapMirror(start, size, source);
+}
+
+inline void TestMachine::mapHandler(uint16_t start, uint32_t size, MemoryBus::Handler* handler)
+{
+    memoryBus.mapHandler(start, size, handler);
+}
+
+inline const std::vector<uint8_t>& TestMachine::getHandledEvents() const
+{
+    return handledEvents;
+}
+
+inline uint8_t TestMachine::inputOperation(uint8_t port)
+{
+    return port * 3;
+}
+
+inline void TestMachine::outputOperation(uint8_t, uint8_t)
+{
+    
+}
+
+inline void TestMachine::handleEvent(uint8_t eventId, uint64_t)
+{
+    handledEvents.push_back(eventId);
+}
+
+//Reads a whole file, empty if it can't be opened
+inline std::vector<uint8_t> readFile(const std::filesystem::path& path)
+{
+    std::ifstream fileStream(path, std::ios::binary);
+    return std::vector<uint8_t>(std::istreambuf_iterator<char>(fileStream), {});
+}